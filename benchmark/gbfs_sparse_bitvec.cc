@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "fmt/core.h"
+
+#include "utl/verify.h"
+
+#include "osr/types.h"
+
+#include "motis/gbfs/compression.h"
+#include "motis/gbfs/sparse_bitvec.h"
+
+using namespace motis::gbfs;
+
+namespace {
+
+template <typename Fn>
+double time_ms(Fn&& fn) {
+  auto const start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>{
+      std::chrono::steady_clock::now() - start}
+      .count();
+}
+
+}  // namespace
+
+// Memory and materialization latency of geofencing bitvecs: dense vs. LZ4
+// compressed vs. sparse runs.
+int main() {
+  // Geofencing-like pattern: allowed by default, some forbidden zones
+  // (consecutive node ranges) and single nodes (stations, vehicles).
+  constexpr auto const kNodes = 20'000'000U;
+  constexpr auto const kQueries = 1'000'000U;
+  auto rng = std::mt19937{42U};
+  auto node = std::uniform_int_distribution<std::uint32_t>{0U, kNodes - 1U};
+  auto zone_size = std::uniform_int_distribution<std::uint32_t>{1U, 5'000U};
+
+  auto bv = osr::bitvec<osr::node_idx_t>{};
+  bv.resize(kNodes);
+  bv.one_out();
+  for (auto i = 0U; i != 200U; ++i) {
+    auto const from = node(rng);
+    auto const to = std::min(kNodes, from + zone_size(rng));
+    for (auto n = from; n != to; ++n) {
+      bv.set(osr::node_idx_t{n}, false);
+    }
+  }
+  for (auto i = 0U; i != 10'000U; ++i) {
+    bv.set(osr::node_idx_t{node(rng)}, (i % 2U) == 0U);
+  }
+
+  auto const sparse = sparse_bitvec::from(bv);
+  auto const lz4 = compress_bitvec(bv);
+
+  auto sparse_out = osr::bitvec<osr::node_idx_t>{};
+  auto lz4_out = osr::bitvec<osr::node_idx_t>{};
+  auto const sparse_ms = time_ms([&]() { sparse.to_bitvec(sparse_out); });
+  auto const lz4_ms = time_ms([&]() { decompress_bitvec(lz4, lz4_out); });
+  utl::verify(std::ranges::equal(sparse_out.blocks_, bv.blocks_),
+              "sparse: wrong bitvec");
+  utl::verify(std::ranges::equal(lz4_out.blocks_, bv.blocks_),
+              "lz4: wrong bitvec");
+
+  auto queries = std::vector<std::uint32_t>(kQueries);
+  std::ranges::generate(queries, [&]() { return node(rng); });
+  auto n_set = std::size_t{0U};
+  auto const dense_query_ms = time_ms([&]() {
+    for (auto const n : queries) {
+      n_set += bv.test(osr::node_idx_t{n}) ? 1U : 0U;
+    }
+  });
+  auto const sparse_query_ms = time_ms([&]() {
+    for (auto const n : queries) {
+      n_set -= sparse.test(n) ? 1U : 0U;
+    }
+  });
+  utl::verify(n_set == 0U, "sparse: wrong test results");
+
+  fmt::println("geofencing bitvec with {} nodes ({} runs)", kNodes,
+               sparse.runs_.size());
+  fmt::println("memory: dense={} bytes, lz4={} bytes, sparse={} bytes",
+               bv.blocks_.size() * sizeof(bv.blocks_[0]),
+               lz4.compressed_bytes_, sparse.allocated_bytes());
+  fmt::println("materialize: lz4={:.3f}ms, sparse={:.3f}ms", lz4_ms,
+               sparse_ms);
+  fmt::println("{} queries: dense={:.3f}ms, sparse={:.3f}ms", kQueries,
+               dense_query_ms, sparse_query_ms);
+}
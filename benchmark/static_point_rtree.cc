@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "fmt/core.h"
+
+#include "utl/verify.h"
+
+#include "geo/latlng.h"
+
+#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
+
+using namespace motis;
+
+namespace {
+
+using idx_t = cista::strong<std::uint32_t, struct benchmark_idx_>;
+
+template <typename Fn>
+double time_ms(Fn&& fn) {
+  auto const start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>{
+      std::chrono::steady_clock::now() - start}
+      .count();
+}
+
+}  // namespace
+
+// Radius queries on the dynamic point_rtree vs. the packed
+// static_point_rtree (country-sized set of stops).
+int main() {
+  constexpr auto const kPoints = 100'000U;
+  constexpr auto const kQueries = 10'000U;
+
+  auto rng = std::mt19937{42U};
+  auto lat = std::uniform_real_distribution<double>{47.0, 55.0};
+  auto lng = std::uniform_real_distribution<double>{6.0, 15.0};
+  auto radius = std::uniform_real_distribution<double>{100.0, 5000.0};
+
+  auto entries = std::vector<std::pair<geo::latlng, idx_t>>{};
+  auto dynamic = point_rtree<idx_t>{};
+  auto const dynamic_build_ms = time_ms([&]() {
+    for (auto i = 0U; i != kPoints; ++i) {
+      auto const pos = geo::latlng{lat(rng), lng(rng)};
+      entries.emplace_back(pos, idx_t{i});
+      dynamic.add(pos, idx_t{i});
+    }
+  });
+  auto packed = static_point_rtree<idx_t>{};
+  auto const packed_build_ms =
+      time_ms([&]() { packed = static_point_rtree<idx_t>::build(entries); });
+
+  auto queries = std::vector<std::pair<geo::latlng, double>>{};
+  for (auto i = 0U; i != kQueries; ++i) {
+    queries.emplace_back(geo::latlng{lat(rng), lng(rng)}, radius(rng));
+  }
+
+  auto n_dynamic = std::size_t{0U};
+  auto n_packed = std::size_t{0U};
+  auto const dynamic_ms = time_ms([&]() {
+    for (auto const& [pos, r] : queries) {
+      dynamic.in_radius(pos, r, [&](idx_t) { ++n_dynamic; });
+    }
+  });
+  auto const packed_ms = time_ms([&]() {
+    for (auto const& [pos, r] : queries) {
+      packed.in_radius(pos, r, [&](idx_t) { ++n_packed; });
+    }
+  });
+  utl::verify(n_dynamic == n_packed, "different results: {} vs. {}",
+              n_dynamic, n_packed);
+
+  fmt::println("{} points, {} radius queries ({} results)", kPoints,
+               kQueries, n_packed);
+  fmt::println("build: point_rtree={:.3f}ms (incl. point generation), "
+               "static_point_rtree={:.3f}ms",
+               dynamic_build_ms, packed_build_ms);
+  fmt::println("query: point_rtree={:.3f}ms, static_point_rtree={:.3f}ms",
+               dynamic_ms, packed_ms);
+}
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "fmt/core.h"
+
+#include "utl/to_vec.h"
+#include "utl/verify.h"
+
+#include "geo/box.h"
+
+#include "osr/lookup.h"
+#include "osr/routing/profile.h"
+
+#include "nigiri/rt/rt_timetable.h"
+#include "nigiri/timetable.h"
+
+#include "motis/config.h"
+#include "motis/constants.h"
+#include "motis/data.h"
+#include "motis/elevators/elevators.h"
+#include "motis/get_loc.h"
+#include "motis/osr/parameters.h"
+#include "motis/update_rtt_td_footpaths.h"
+
+namespace n = nigiri;
+using namespace motis;
+
+namespace {
+
+template <typename Fn>
+double time_ms(Fn&& fn) {
+  auto const start = std::chrono::steady_clock::now();
+  fn();
+  return std::chrono::duration<double, std::milli>{
+      std::chrono::steady_clock::now() - start}
+      .count();
+}
+
+}  // namespace
+
+// Time-dependent (elevator) footpaths of the stations with the most
+// elevators nearby: one get_td_footpaths call per location and direction.
+// Usage: motis-benchmark-td_footpaths DATA_PATH [N_LOCATIONS=100]
+// The data directory needs `osr_footpath` and elevators in its config.yml.
+int main(int argc, char** argv) {
+  utl::verify(argc >= 2, "usage: {} DATA_PATH [N_LOCATIONS]", argv[0]);
+  auto const data_path = std::filesystem::path{argv[1]};
+  auto const n_locations =
+      argc >= 3 ? static_cast<std::size_t>(std::atol(argv[2])) : 100U;
+
+  auto const c = config::read(data_path / "config.yml");
+  auto const d = data{data_path, c};
+  utl::verify(d.tt_ && d.w_ && d.matches_ && d.rt_->e_ != nullptr,
+              "timetable, street routing and elevators required");
+  auto const& e = *d.rt_->e_;
+  auto const max =
+      std::chrono::seconds{c.timetable_.value().max_footpath_length_ * 60};
+
+  auto locations = std::vector<std::pair<std::size_t, n::location_idx_t>>{};
+  for (auto l = n::location_idx_t{0U}; l != d.tt_->n_locations(); ++l) {
+    auto const pos = get_loc(*d.tt_, *d.w_, *d.pl_, *d.matches_, l).pos_;
+    auto const n_elevators =
+        utl::to_vec(d.l_->find_elevators(geo::box{pos, kElevatorUpdateRadius}))
+            .size();
+    if (n_elevators != 0U) {
+      locations.emplace_back(n_elevators, l);
+    }
+  }
+  std::ranges::sort(locations, std::greater{});
+  locations.resize(std::min(locations.size(), n_locations));
+
+  auto blocked = osr::bitvec<osr::node_idx_t>{};
+  auto n_footpaths = std::size_t{0U};
+  auto max_ms = 0.0;
+  auto const total_ms = time_ms([&]() {
+    for (auto const& [n_elevators, l] : locations) {
+      auto const start = get_loc(*d.tt_, *d.w_, *d.pl_, *d.matches_, l);
+      for (auto const dir :
+           {osr::direction::kForward, osr::direction::kBackward}) {
+        auto const ms = time_ms([&]() {
+          n_footpaths +=
+              get_td_footpaths(*d.w_, *d.l_, *d.pl_, *d.tt_, d.rt_->rtt_.get(),
+                               *d.location_rtree_, e, *d.matches_, l, start,
+                               dir, osr::search_profile::kWheelchair, max,
+                               kMaxWheelchairMatchingDistance,
+                               osr_parameters{}, blocked)
+                  .size();
+        });
+        max_ms = std::max(max_ms, ms);
+      }
+    }
+  });
+
+  fmt::println("{} locations (most elevators: {}), {} td footpaths",
+               locations.size(),
+               locations.empty() ? 0U : locations.front().first, n_footpaths);
+  fmt::println("total={:.3f}ms, avg={:.3f}ms, max={:.3f}ms per search",
+               total_ms,
+               locations.empty()
+                   ? 0.0
+                   : total_ms / static_cast<double>(2U * locations.size()),
+               max_ms);
+}
@@ -1,11 +1,27 @@
+#include <atomic>
+#include <chrono>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <ranges>
+#include <string_view>
+#include <thread>
 
 #include "conf/configuration.h"
 
+#include "boost/json/parse.hpp"
+#include "boost/json/serialize.hpp"
+
+#include "fmt/format.h"
+
+#include "utl/file_utils.h"
+#include "utl/helpers/algorithm.h"
 #include "utl/init_from.h"
-#include "utl/parallel_for.h"
 #include "utl/parser/cstr.h"
+#include "utl/progress_tracker.h"
+#include "utl/read_file.h"
+#include "utl/verify.h"
 
 #include "motis/config.h"
 #include "motis/data.h"
@@ -61,10 +77,7 @@ stats::entry quantile(std::vector<stats::entry> const& sorted_values,
   }
 }
 
-void print_category(category& cat,
-                    std::uint64_t count,
-                    bool const compact,
-                    int const top) {
+void print_category(category& cat, bool const compact, int const top) {
   std::cout << "\n"
             << cat.name_ << "\n"
             << std::string(cat.name_.size(), '=') << "\n"
@@ -75,7 +88,7 @@ void print_category(category& cat,
       continue;
     }
     utl::sort(stat.values_);
-    auto const avg = (stat.sum_ / static_cast<double>(count));
+    auto const avg = (stat.sum_ / static_cast<double>(stat.values_.size()));
     if (compact) {
       std::cout << std::left << std::setw(30) << stat.name_
                 << " avg: " << std::setw(27) << std::setprecision(4)
@@ -125,20 +138,159 @@ void print_category(category& cat,
 
 namespace motis {
 
+namespace {
+
+struct query {
+  boost::beast::http::verb method_;
+  std::string_view target_;
+  std::string_view body_;
+};
+
+// Query lines are either a GET target or "POST <target> <json body>".
+query parse_query(std::string_view const line) {
+  constexpr auto const kPost = std::string_view{"POST "};
+  if (!line.starts_with(kPost)) {
+    return {boost::beast::http::verb::get, line, {}};
+  }
+  auto const rest = line.substr(kPost.size());
+  auto const sep = rest.find(' ');
+  return {boost::beast::http::verb::post, rest.substr(0U, sep),
+          sep == std::string_view::npos ? std::string_view{}
+                                        : rest.substr(sep + 1U)};
+}
+
+std::string_view endpoint(std::string_view const target) {
+  return target.substr(0U, target.find('?'));
+}
+
+struct result {
+  std::string response_;
+  unsigned status_{0U};
+  std::uint64_t latency_ms_{0U};
+  std::vector<std::pair<std::string, std::uint64_t>> stages_;
+};
+
+std::vector<std::pair<std::string, std::uint64_t>> get_stages(
+    std::string const& response, std::vector<std::string> const& stages) {
+  auto ret = std::vector<std::pair<std::string, std::uint64_t>>{};
+  if (stages.empty() || !response.starts_with('{')) {
+    return ret;
+  }
+
+  auto ec = boost::system::error_code{};
+  auto const v = json::parse(response, ec);
+  if (ec || !v.is_object()) {
+    return ret;
+  }
+
+  auto const debug = v.as_object().find("debugOutput");
+  if (debug == v.as_object().end() || !debug->value().is_object()) {
+    return ret;
+  }
+
+  for (auto const& [key, value] : debug->value().as_object()) {
+    if (stages.front() != "all" && utl::find(stages, key) == end(stages)) {
+      continue;
+    }
+    if (value.is_uint64()) {
+      ret.emplace_back(std::string{key}, value.as_uint64());
+    } else if (value.is_int64() && value.as_int64() >= 0) {
+      ret.emplace_back(std::string{key},
+                       static_cast<std::uint64_t>(value.as_int64()));
+    }
+  }
+  return ret;
+}
+
+json::object to_json(stats& s) {
+  utl::sort(s.values_);
+  auto const q = [&](double const x) { return quantile(s.values_, x).value_; };
+  return {{"count", s.values_.size()},
+          {"avg", s.sum_ / static_cast<double>(s.values_.size())},
+          {"min", s.values_.front().value_},
+          {"p50", q(0.5)},
+          {"p90", q(0.9)},
+          {"p99", q(0.99)},
+          {"p999", q(0.999)},
+          {"max", s.values_.back().value_}};
+}
+
+// Compares the quantiles of all statistics present in both reports.
+// A statistic regressed if it got slower by more than `rel_threshold`
+// (relative) AND by more than `abs_threshold_ms` (absolute).
+bool check_regressions(json::object const& baseline,
+                       json::object const& current,
+                       double const rel_threshold,
+                       double const abs_threshold_ms) {
+  auto const to_double = [](json::value const& x) {
+    return x.is_double() ? x.as_double()
+           : x.is_int64() ? static_cast<double>(x.as_int64())
+                          : static_cast<double>(x.as_uint64());
+  };
+
+  auto regressed = false;
+  auto const& base_stats = baseline.at("stats").as_object();
+  for (auto const& [name, cur] : current.at("stats").as_object()) {
+    auto const base = base_stats.find(name);
+    if (base == base_stats.end()) {
+      continue;
+    }
+    for (auto const key : {"p50", "p90", "p99"}) {
+      auto const b = to_double(base->value().as_object().at(key));
+      auto const c = to_double(cur.as_object().at(key));
+      if (c > b * (1.0 + rel_threshold) && c - b > abs_threshold_ms) {
+        std::cout << "REGRESSION " << std::string_view{name} << " " << key
+                  << ": " << b << "ms -> " << c << "ms (+"
+                  << (b == 0.0 ? 100.0 : (c - b) / b * 100.0) << "%)\n";
+        regressed = true;
+      }
+    }
+  }
+  return regressed;
+}
+
+}  // namespace
+
 int batch(int ac, char** av) {
   auto data_path = fs::path{"data"};
   auto queries_path = fs::path{"queries.txt"};
   auto responses_path = fs::path{"responses.txt"};
+  auto report_path = fs::path{};
+  auto baseline_path = fs::path{};
   auto mt = true;
+  auto concurrency = std::max(1U, std::thread::hardware_concurrency());
+  auto rate = 0.0;
+  auto stage_list = std::string{"direct,prepare,execute_time,reconstruction"};
+  auto rel_threshold = 0.1;
+  auto abs_threshold_ms = 5.0;
 
   auto desc = po::options_description{"Options"};
   desc.add_options()  //
       ("help", "Prints this help message")  //
       ("multithreading,mt", po::value(&mt)->default_value(mt))  //
       ("queries,q", po::value(&queries_path)->default_value(queries_path),
-       "queries file")  //
+       "queries file: one GET target or \"POST <target> <body>\" per line")  //
       ("responses,r", po::value(&responses_path)->default_value(responses_path),
-       "response file");
+       "response file")  //
+      ("concurrency", po::value(&concurrency)->default_value(concurrency),
+       "number of requests processed at the same time")  //
+      ("rate", po::value(&rate)->default_value(rate),
+       "open loop: start requests at this fixed rate (requests per second), "
+       "latency includes the time a request waited to be started; "
+       "0 = closed loop: start the next request when one finishes")  //
+      ("stages", po::value(&stage_list)->default_value(stage_list),
+       "comma separated debugOutput keys to report (\"all\" = every key, "
+       "empty = none)")  //
+      ("report", po::value(&report_path),
+       "write a JSON report with latency statistics to this file")  //
+      ("baseline", po::value(&baseline_path),
+       "compare against this JSON report, exit with code 1 on regressions")  //
+      ("threshold", po::value(&rel_threshold)->default_value(rel_threshold),
+       "relative regression threshold for p50/p90/p99 (0.1 = 10%)")  //
+      ("threshold-ms",
+       po::value(&abs_threshold_ms)->default_value(abs_threshold_ms),
+       "absolute regression threshold in milliseconds (both thresholds "
+       "have to be exceeded)");
   add_data_path_opt(desc, data_path);
 
   auto vm = parse_opt(ac, av, desc);
@@ -147,11 +299,24 @@ int batch(int ac, char** av) {
     return 0;
   }
 
-  auto queries = std::vector<std::string_view>{};
+  if (!mt) {
+    concurrency = 1U;
+  }
+  concurrency = std::max(1U, concurrency);
+
+  auto stages = std::vector<std::string>{};
+  for (auto const s : std::views::split(std::string_view{stage_list}, ',')) {
+    if (!s.empty()) {
+      stages.emplace_back(std::string_view{s});
+    }
+  }
+
+  auto queries = std::vector<query>{};
   auto f = cista::mmap{queries_path.generic_string().c_str(),
                        cista::mmap::protection::READ};
-  utl::for_each_line(utl::cstr{f.view()},
-                     [&](utl::cstr s) { queries.push_back(s.view()); });
+  utl::for_each_line(utl::cstr{f.view()}, [&](utl::cstr s) {
+    queries.push_back(parse_query(s.view()));
+  });
 
   auto const c = config::read(data_path / "config.yml");
   utl::verify(c.timetable_.has_value(), "timetable required");
@@ -159,29 +324,32 @@ int batch(int ac, char** av) {
   auto d = data{data_path, c};
   utl::verify(d.tt_, "timetable required");
 
-  auto response_time = stats{"response_time", 0U};
-
-  struct state {};
-
-  auto out = std::ofstream{responses_path};
   auto m = motis_instance{net::default_exec{}, d, c, ""};
-  auto const compute_response = [&](state&, std::size_t const id) {
-    UTL_START_TIMING(request);
-    auto response = std::string{};
+  auto const compute_response = [&](std::size_t const id) {
+    auto const& q = queries.at(id);
+    auto req = net::web_server::http_req_t{
+        q.method_, boost::beast::string_view{q.target_}, 11};
+    if (!q.body_.empty()) {
+      req.body() = q.body_;
+      req.set(boost::beast::http::field::content_type, "application/json");
+      req.prepare_payload();
+    }
+
+    auto r = result{};
     try {
       m.qr_(
-          {boost::beast::http::verb::get,
-           boost::beast::string_view{queries.at(id)}, 11},
+          std::move(req),
           [&](net::web_server::http_res_t const& res) {
             std::visit(
-                [&](auto&& r) {
-                  using ResponseType = std::decay_t<decltype(r)>;
+                [&](auto&& x) {
+                  using ResponseType = std::decay_t<decltype(x)>;
                   if constexpr (std::is_same_v<ResponseType,
                                                net::web_server::string_res_t>) {
-                    response = r.body();
-                    if (response.empty()) {
+                    r.response_ = x.body();
+                    r.status_ = x.result_int();
+                    if (r.response_.empty()) {
                       std::cout << "empty response for " << id << ": "
-                                << queries.at(id) << " [status=" << r.result()
+                                << q.target_ << " [status=" << x.result()
                                 << "]\n";
                     }
                   } else {
@@ -195,33 +363,120 @@ int batch(int ac, char** av) {
     } catch (std::exception const& e) {
       std::cerr << "ERROR IN QUERY " << id << ": " << e.what() << "\n";
     }
-    return std::pair{UTL_GET_TIMING_MS(request), std::move(response)};
+    return r;
   };
 
+  auto cat = category{"response_time"};
+  auto& response_time = cat.stats_["response_time"];
+  response_time.name_ = "response_time";
+  auto n_errors = std::size_t{0U};
+
+  // Results are recorded in completion order but responses are written in
+  // query order to keep the response file comparable with `motis compare`.
+  auto out = std::ofstream{responses_path};
+  auto pending = std::map<std::size_t, std::string>{};
+  auto next_out = std::size_t{0U};
+  auto record_mutex = std::mutex{};
   auto const pt = utl::activate_progress_tracker("batch");
   pt->in_high(queries.size());
-  if (mt) {
-    utl::parallel_ordered_collect_threadlocal<state>(
-        queries.size(), compute_response,
-        [&](std::size_t const id,
-            std::pair<std::uint64_t, std::string> const& s) {
-          response_time.add(id, s.first);
-          out << s.second << "\n";
-        },
-        pt->update_fn());
-  } else {
-    auto s = state{};
-    for (auto i = 0U; i != queries.size(); ++i) {
-      compute_response(s, i);
-      pt->increment();
+  auto const record = [&](std::size_t const id, result&& r) {
+    auto const lock = std::scoped_lock{record_mutex};
+
+    auto const add = [&](std::string const& name, std::uint64_t const value) {
+      auto& s = cat.stats_[name];
+      s.name_ = name;
+      s.add(id, value);
+    };
+    response_time.add(id, r.latency_ms_);
+    add(fmt::format("endpoint {}", endpoint(queries[id].target_)),
+        r.latency_ms_);
+    for (auto const& [key, value] : r.stages_) {
+      add(fmt::format("stage {}", key), value);
+    }
+    if (r.status_ != 200U) {
+      ++n_errors;
+    }
+
+    pending.emplace(id, std::move(r.response_));
+    while (!pending.empty() && pending.begin()->first == next_out) {
+      out << pending.begin()->second << "\n";
+      pending.erase(pending.begin());
+      ++next_out;
+    }
+    pt->increment();
+  };
+
+  using clock = std::chrono::steady_clock;
+  auto const open_loop = rate > 0.0;
+  auto const interval =
+      open_loop ? std::chrono::duration_cast<clock::duration>(
+                      std::chrono::duration<double>{1.0 / rate})
+                : clock::duration{};
+  auto const start = clock::now();
+  auto next = std::atomic_size_t{0U};
+  auto const work = [&]() {
+    for (auto id = next++; id < queries.size(); id = next++) {
+      auto const scheduled =
+          open_loop ? start + static_cast<clock::rep>(id) * interval
+                    : clock::now();
+      if (open_loop) {
+        std::this_thread::sleep_until(scheduled);
+      }
+      auto r = compute_response(id);
+      r.latency_ms_ = static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() -
+                                                                scheduled)
+              .count());
+      r.stages_ = get_stages(r.response_, stages);
+      record(id, std::move(r));
+    }
+  };
+  auto workers = std::vector<std::thread>{};
+  for (auto i = 1U; i < concurrency; ++i) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (auto& w : workers) {
+    w.join();
+  }
+  auto const duration = std::chrono::duration<double>{clock::now() - start};
+
+  auto report = json::object{
+      {"mode", open_loop ? "open" : "closed"},
+      {"rate", rate},
+      {"concurrency", concurrency},
+      {"queries", queries.size()},
+      {"errors", n_errors},
+      {"duration_s", duration.count()},
+      {"throughput", static_cast<double>(queries.size()) / duration.count()}};
+  auto& report_stats = report["stats"].emplace_object();
+  for (auto& [name, s] : cat.stats_) {
+    if (!s.values_.empty()) {
+      report_stats[name] = to_json(s);
     }
   }
 
-  auto cat = category{};
-  cat.name_ = "response_time";
-  cat.stats_.emplace("response_time", std::move(response_time));
   std::cout.imbue(std::locale(std::locale::classic(), new thousands_sep));
-  print_category(cat, queries.size(), false, 10U);
+  print_category(cat, false, 10U);
+  std::cout << "errors: " << n_errors << ", throughput: "
+            << report.at("throughput").as_double() << " requests/s\n";
+
+  if (!report_path.empty()) {
+    auto report_out = std::ofstream{report_path};
+    report_out << json::serialize(report) << "\n";
+  }
+
+  if (!baseline_path.empty()) {
+    auto const baseline_content =
+        utl::read_file(baseline_path.generic_string().c_str());
+    utl::verify(baseline_content.has_value(), "could not read baseline {}",
+                baseline_path);
+    auto const baseline = json::parse(*baseline_content).as_object();
+    if (check_regressions(baseline, report, rel_threshold, abs_threshold_ms)) {
+      return 1;
+    }
+    std::cout << "no regressions compared to " << baseline_path << "\n";
+  }
 
   return 0U;
 }
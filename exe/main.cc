@@ -170,6 +170,7 @@ int main(int ac, char** av) {
              "  - osr_footpath\n"
              "  - matches (timetable+street_routing)\n"
              "  - route_shapes (timetable.route_shapes)\n"
+             "  - indices (timetable/street_routing)\n"
              "  - tiles\n");
         auto vm = parse_opt(ac, av, desc);
         if (vm.count("help")) {
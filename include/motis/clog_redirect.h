@@ -1,12 +1,11 @@
 #pragma once
 
 #include <fstream>
-#include <memory>
-#include <mutex>
-#include <streambuf>
 
 namespace motis {
 
+// Redirects std::clog output of the constructing thread to a file.
+// Multiple redirects may be active at the same time (one per thread).
 struct clog_redirect {
   explicit clog_redirect(char const* log_file_path);
 
@@ -21,10 +20,7 @@ struct clog_redirect {
 
 private:
   std::ofstream sink_;
-  std::unique_ptr<std::streambuf> sink_buf_;
-  std::streambuf* backup_clog_{};
   bool active_{};
-  std::mutex mutex_;
 
   // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
   static bool enabled_;
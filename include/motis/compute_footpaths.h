@@ -1,18 +1,39 @@
 #pragma once
 
+#include <filesystem>
+#include <optional>
+#include <tuple>
+
+#include "cista/hash.h"
+#include "cista/containers/vector.h"
 #include "cista/memory_holder.h"
 
 #include "osr/routing/profile.h"
 #include "osr/types.h"
 
+#include "nigiri/types.h"
+
 #include "motis/fwd.h"
 #include "motis/types.h"
 
 namespace motis {
 
-using elevator_footpath_map_t = hash_map<
-    osr::node_idx_t,
-    hash_set<std::pair<nigiri::location_idx_t, nigiri::location_idx_t>>>;
+// Footpath between two locations whose wheelchair path uses an elevator.
+struct elevator_footpath {
+  friend bool operator<(elevator_footpath const& a,
+                        elevator_footpath const& b) {
+    return std::tie(a.elevator_, a.from_, a.to_) <
+           std::tie(b.elevator_, b.from_, b.to_);
+  }
+  friend bool operator==(elevator_footpath const&,
+                         elevator_footpath const&) = default;
+
+  osr::node_idx_t elevator_;
+  nigiri::location_idx_t from_, to_;
+};
+
+// Sorted by elevator node, without duplicates.
+using elevator_footpath_map_t = cista::raw::vector<elevator_footpath>;
 
 struct routed_transfers_settings {
   osr::search_profile profile_;
@@ -23,6 +44,13 @@ struct routed_transfers_settings {
   std::function<bool(nigiri::location_idx_t)> is_candidate_{};
 };
 
+// Finished (profile, partition) results are written to `dir_`. An
+// interrupted run with the same `key_` resumes from them.
+struct footpath_checkpoints {
+  std::filesystem::path dir_;
+  cista::hash_t key_;
+};
+
 elevator_footpath_map_t compute_footpaths(
     osr::ways const&,
     osr::lookup const&,
@@ -30,6 +58,7 @@ elevator_footpath_map_t compute_footpaths(
     nigiri::timetable&,
     osr::elevation_storage const*,
     bool update_coordinates,
-    std::vector<routed_transfers_settings> const& settings);
+    std::vector<routed_transfers_settings> const& settings,
+    std::optional<footpath_checkpoints> const& = std::nullopt);
 
 }  // namespace motis
\ No newline at end of file
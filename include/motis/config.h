@@ -45,6 +45,15 @@ struct config {
     unsigned n_threads_{0U};
     std::optional<std::string> data_attribution_link_{};
     std::optional<std::vector<std::string>> lbs_{};
+
+    struct request_limit {
+      bool operator==(request_limit const&) const = default;
+      unsigned max_running_{0U};  // 0 = only limited by n_threads
+      unsigned max_queued_{0U};  // 0 = unlimited
+    };
+    std::optional<request_limit> interactive_requests_{};
+    std::optional<request_limit> routing_requests_{};
+    std::optional<request_limit> batch_requests_{};
   };
   std::optional<server> server_{};
 
@@ -60,6 +69,9 @@ struct config {
                              ? 256ULL * 1024ULL * 1024ULL * 1024ULL
                              : 256U * 1024U * 1024U};
     std::size_t flush_threshold_{100'000};
+    std::optional<unsigned> prewarm_max_zoom_{};  // render z0..z on startup
+    std::size_t cache_mb_{256U};  // rendered tiles above the low zoom levels
+    std::size_t low_zoom_cache_mb_{64U};
   };
   std::optional<tiles> tiles_{};
 
@@ -123,6 +135,7 @@ struct config {
     std::uint16_t num_days_{365U};
     bool tb_{false};
     bool railviz_{true};
+    std::size_t railviz_cache_mb_{64U};
     bool with_shapes_{true};
     bool adjust_footpaths_{true};
     bool merge_dupes_intra_src_{false};
@@ -132,6 +145,8 @@ struct config {
     unsigned http_timeout_{30};
     bool canned_rt_{false};
     bool incremental_rt_update_{false};
+    bool reuse_rt_snapshot_memory_{false};
+    std::optional<unsigned> rt_publish_deadline_{};
     bool use_osm_stop_coordinates_{false};
     bool extend_missing_footpaths_{false};
     std::uint16_t max_footpath_length_{15};
@@ -239,6 +254,12 @@ struct config {
   struct street_routing {
     bool operator==(street_routing const&) const = default;
     std::optional<std::filesystem::path> elevation_data_dir_;
+    std::size_t offsets_cache_size_{0U};
+
+    // /plan: pre- and post-transit street searches run as child operations
+    // while direct connections are computed. The same flag also splits the
+    // itinerary reconstruction across child operations (8 itineraries each).
+    bool parallel_street_searches_{false};
   };
 
   std::optional<street_routing> get_street_routing() const;
@@ -270,6 +291,24 @@ struct config {
   };
   std::optional<logging> logging_{};
 
+  struct import {
+    bool operator==(import const&) const = default;
+
+    // Admission only: a task starts if its budget fits into the remaining
+    // import budget, but its threads and memory are not capped.
+    struct budget {
+      bool operator==(budget const&) const = default;
+      unsigned n_threads_{0U};  // 0 = all threads of the import budget
+      std::size_t memory_mb_{0U};
+    };
+
+    unsigned n_threads_{0U};  // 0 = number of hardware threads
+    std::size_t memory_mb_{0U};  // 0 = unlimited
+    bool footpath_checkpoints_{false};
+    std::map<std::string, budget> tasks_{};
+  };
+  std::optional<import> import_{};
+
   bool osr_footpath_{false};
   bool geocoding_{false};
   bool reverse_geocoding_{false};
@@ -23,4 +23,7 @@ constexpr auto const kTransferTimeMultiplier = 1.5F;
 // are updated on elevator status changes [meters]
 constexpr auto const kElevatorUpdateRadius = 1000.;
 
+// max distance from an OSM elevator node to its elevator status entry [meters]
+constexpr auto const kElevatorMatchRadius = 20.0;
+
 }  // namespace motis
@@ -1,7 +1,10 @@
 #pragma once
 
+#include <utility>
+
 #include "ctx/op_id.h"
 #include "ctx/operation.h"
+#include "ctx/scheduler.h"
 
 namespace motis {
 
@@ -9,4 +12,13 @@ struct ctx_data {
   void transition(ctx::transition, ctx::op_id, ctx::op_id) {}
 };
 
-}  // namespace motis
\ No newline at end of file
+// Runs `fn` as child operation of the current operation.
+template <typename Fn>
+ctx::future_ptr<ctx_data, void> spawn_child(Fn&& fn) {
+  auto const op = ctx::current_op<ctx_data>();
+  auto id = ctx::op_id(CTX_LOCATION);
+  id.parent_index = op->id_.index;
+  return op->sched_.post_void(op->data_, std::forward<Fn>(fn), id);
+}
+
+}  // namespace motis
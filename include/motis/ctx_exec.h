@@ -1,6 +1,7 @@
 #pragma once
 
 #include <iostream>
+#include <memory>
 
 #include "boost/asio/io_context.hpp"
 #include "boost/asio/post.hpp"
@@ -8,23 +9,48 @@
 #include "ctx/scheduler.h"
 
 #include "motis/ctx_data.h"
+#include "motis/request_scheduler.h"
 
 namespace motis {
 
 struct ctx_exec {
-  ctx_exec(boost::asio::io_context& io, ctx::scheduler<ctx_data>& sched)
-      : io_{io}, sched_{sched} {}
+  ctx_exec(boost::asio::io_context& io,
+           ctx::scheduler<ctx_data>& sched,
+           request_scheduler* req_sched = nullptr)
+      : io_{io}, sched_{sched}, req_sched_{req_sched} {}
 
   void exec(auto&& f, net::web_server::http_res_cb_t cb) {
+    if (req_sched_ == nullptr) {
+      post(std::move(f), std::move(cb), []() {});
+      return;
+    }
+
+    auto const cls = get_current_request_class();
+    auto state = std::make_shared<std::pair<std::decay_t<decltype(f)>,
+                                            net::web_server::http_res_cb_t>>(
+        std::move(f), std::move(cb));
+    auto const accepted = req_sched_->submit(cls, [this, cls, state]() {
+      post(std::move(state->first), std::move(state->second),
+           [this, cls]() { req_sched_->finish(cls); });
+    });
+    if (!accepted) {
+      auto str = net::web_server::string_res_t{
+          boost::beast::http::status::too_many_requests, 11};
+      str.body() = "too many requests";
+      str.prepare_payload();
+      respond(std::move(state->second),
+              std::make_shared<net::web_server::http_res_t>(std::move(str)));
+    }
+  }
+
+  void post(auto&& f, net::web_server::http_res_cb_t cb, auto&& on_done) {
     sched_.post_void_io(
         ctx_data{},
-        [&, f = std::move(f), cb = std::move(cb)]() mutable {
+        [&, f = std::move(f), cb = std::move(cb),
+         on_done = std::move(on_done)]() mutable {
+          auto res = std::shared_ptr<net::web_server::http_res_t>{};
           try {
-            auto res = std::make_shared<net::web_server::http_res_t>(f());
-            boost::asio::post(
-                io_, [cb = std::move(cb), res = std::move(res)]() mutable {
-                  cb(std::move(*res));
-                });
+            res = std::make_shared<net::web_server::http_res_t>(f());
           } catch (...) {
             std::cerr << "UNEXPECTED EXCEPTION\n";
 
@@ -33,18 +59,25 @@ struct ctx_exec {
             str.body() = "error";
             str.prepare_payload();
 
-            auto res = std::make_shared<net::web_server::http_res_t>(str);
-            boost::asio::post(
-                io_, [cb = std::move(cb), res = std::move(res)]() mutable {
-                  cb(std::move(*res));
-                });
+            res = std::make_shared<net::web_server::http_res_t>(str);
           }
+          on_done();
+          respond(std::move(cb), std::move(res));
         },
         CTX_LOCATION);
   }
 
+  void respond(net::web_server::http_res_cb_t cb,
+               std::shared_ptr<net::web_server::http_res_t> res) {
+    boost::asio::post(io_,
+                      [cb = std::move(cb), res = std::move(res)]() mutable {
+                        cb(std::move(*res));
+                      });
+  }
+
   boost::asio::io_context& io_;
   ctx::scheduler<ctx_data>& sched_;
+  request_scheduler* req_sched_;
 };
 
-}  // namespace motis
\ No newline at end of file
+}  // namespace motis
@@ -25,19 +25,20 @@ namespace motis {
 
 struct elevators;
 
-template <typename T>
-struct point_rtree;
-
 template <typename T>
 using ptr = std::unique_ptr<T>;
 
 struct rt {
   rt();
-  rt(ptr<nigiri::rt_timetable>&&, ptr<elevators>&&, ptr<railviz_rt_index>&&);
+  rt(ptr<nigiri::rt_timetable>&&,
+     ptr<elevators>&&,
+     ptr<railviz_rt_index>&&,
+     ptr<running_trips_rt_index>&&);
   ~rt();
   ptr<nigiri::rt_timetable> rtt_;
   ptr<railviz_rt_index> railviz_rt_;
   ptr<elevators> e_;
+  ptr<running_trips_rt_index> running_trips_rt_;
 };
 
 struct data {
@@ -75,9 +76,9 @@ struct data {
     return std::tie(config_, initial_response_, t_, adr_ext_, f_, tz_, r_, tc_,
                     w_, pl_, l_, elevations_, tt_, tbd_, tags_, location_rtree_,
                     elevator_nodes_, elevator_osm_mapping_, shapes_,
-                    railviz_static_, matches_, way_matches_, rt_, gbfs_,
-                    odm_bounds_, ride_sharing_bounds_, flex_areas_, metrics_,
-                    auser_);
+                    railviz_static_, running_trips_, matches_, way_matches_,
+                    rt_, gbfs_, odm_bounds_, ride_sharing_bounds_,
+                    flex_areas_, metrics_, auser_, offsets_cache_);
   }
 
   std::filesystem::path path_;
@@ -97,11 +98,13 @@ struct data {
   cista::wrapped<nigiri::timetable> tt_;
   cista::wrapped<nigiri::routing::tb::tb_data> tbd_;
   cista::wrapped<tag_lookup> tags_;
-  ptr<point_rtree<nigiri::location_idx_t>> location_rtree_;
+  cista::wrapped<static_point_rtree<nigiri::location_idx_t>> location_rtree_;
   ptr<hash_set<osr::node_idx_t>> elevator_nodes_;
   ptr<elevator_id_osm_mapping_t> elevator_osm_mapping_;
+  ptr<elevator_footpath_index> elevator_footpath_index_;
   ptr<nigiri::shapes_storage> shapes_;
   ptr<railviz_static_index> railviz_static_;
+  ptr<running_trips_static_index> running_trips_;
   cista::wrapped<vector_map<nigiri::location_idx_t, osr::platform_idx_t>>
       matches_;
   ptr<way_matches_storage> way_matches_;
@@ -113,6 +116,7 @@ struct data {
   ptr<flex::flex_areas> flex_areas_;
   ptr<metrics_registry> metrics_;
   ptr<std::map<std::string, auser>> auser_;
+  ptr<offsets_cache> offsets_cache_;
 };
 
 }  // namespace motis
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "geo/latlng.h"
+
+#include "osr/routing/profile.h"
+#include "osr/types.h"
+
+#include "nigiri/types.h"
+
+#include "motis/fwd.h"
+#include "motis/match_platforms.h"
+#include "motis/types.h"
+
+namespace motis {
+
+// Reverse index from elevator nodes to the locations whose wheelchair td
+// footpaths depend on them: get_td_footpaths considers all elevators within
+// kElevatorUpdateRadius of the start location.
+struct elevator_footpath_index {
+  elevator_footpath_index(osr::ways const&,
+                          osr::lookup const&,
+                          osr::platforms const&,
+                          nigiri::timetable const&,
+                          platform_matches_t const&);
+
+  // Locations (both directions) with a nearby elevator node whose state
+  // changes differ between `old_e` and `new_e`.
+  hash_set<std::pair<nigiri::location_idx_t, osr::direction>> get_tasks(
+      osr::ways const&, elevators const& old_e, elevators const& new_e) const;
+
+  // Same as above, restricted to the elevator nodes an elevator at `pos`
+  // can be matched to.
+  hash_set<std::pair<nigiri::location_idx_t, osr::direction>> get_tasks(
+      osr::ways const&,
+      osr::lookup const&,
+      elevators const& old_e,
+      elevators const& new_e,
+      geo::latlng const& pos) const;
+
+  hash_map<osr::node_idx_t, std::vector<nigiri::location_idx_t>> locations_;
+};
+
+}  // namespace motis
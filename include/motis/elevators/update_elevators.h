@@ -8,9 +8,11 @@
 
 namespace motis {
 
+// `new_rtt_is_copy`: `new_rtt` was copied from the current RT timetable.
 std::unique_ptr<elevators> update_elevators(config const&,
                                             data const&,
                                             std::string_view fasta_json,
-                                            nigiri::rt_timetable&);
+                                            nigiri::rt_timetable&,
+                                            bool new_rtt_is_copy = false);
 
 }  // namespace motis
\ No newline at end of file
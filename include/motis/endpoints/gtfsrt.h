@@ -1,18 +1,29 @@
 #pragma once
 
+#include <memory>
+
 #include "net/web_server/query_router.h"
 
 #include "motis/fwd.h"
 
 namespace motis::ep {
 
+// GTFS-RT feed of all real-time updates. The feed is built and serialized
+// once per real-time snapshot and shared by all clients (ETag support).
+// With `?since=<ETag>`, a DIFFERENTIAL feed is returned that only contains
+// trips that changed (or were removed) since the given version.
 struct gtfsrt {
+  struct feed_cache;
+
+  static std::shared_ptr<feed_cache> make_cache();
+
   net::reply operator()(net::route_request const&, bool) const;
 
   config const& config_;
   nigiri::timetable const* tt_;
   tag_lookup const* tags_;
   std::shared_ptr<rt> const& rt_;
+  std::shared_ptr<feed_cache> cache_;
 };
 
 }  // namespace motis::ep
\ No newline at end of file
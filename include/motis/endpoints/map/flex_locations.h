@@ -6,7 +6,7 @@
 #include "nigiri/types.h"
 
 #include "motis/fwd.h"
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 
 namespace motis::ep {
 
@@ -15,7 +15,7 @@ struct flex_locations {
 
   tag_lookup const& tags_;
   nigiri::timetable const& tt_;
-  point_rtree<nigiri::location_idx_t> const& loc_rtree_;
+  static_point_rtree<nigiri::location_idx_t> const& loc_rtree_;
 };
 
 }  // namespace motis::ep
\ No newline at end of file
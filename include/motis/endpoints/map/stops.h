@@ -7,7 +7,7 @@
 #include "motis-api/motis-api.h"
 #include "motis/fwd.h"
 #include "motis/match_platforms.h"
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 
 namespace motis::ep {
 
@@ -21,7 +21,7 @@ struct stops {
   adr::typeahead const* t_;
   adr_ext const* ae_;
   tz_map_t const* tz_;
-  point_rtree<nigiri::location_idx_t> const& loc_rtree_;
+  static_point_rtree<nigiri::location_idx_t> const& loc_rtree_;
   tag_lookup const& tags_;
   nigiri::timetable const& tt_;
 };
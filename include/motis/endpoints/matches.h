@@ -5,14 +5,14 @@
 #include "nigiri/types.h"
 
 #include "motis/fwd.h"
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 
 namespace motis::ep {
 
 struct matches {
   boost::json::value operator()(boost::json::value const&) const;
 
-  point_rtree<nigiri::location_idx_t> const& loc_rtree_;
+  static_point_rtree<nigiri::location_idx_t> const& loc_rtree_;
   tag_lookup const& tags_;
   nigiri::timetable const& tt_;
   osr::ways const& w_;
@@ -16,6 +16,7 @@ struct metrics {
   tag_lookup const* tags_;
   std::shared_ptr<rt> const& rt_;
   metrics_registry* metrics_;
+  running_trips_static_index const* running_trips_;
 };
 
 }  // namespace motis::ep
\ No newline at end of file
@@ -20,7 +20,7 @@ struct one_to_all {
   std::shared_ptr<rt> const& rt_;
   tag_lookup const& tags_;
   flex::flex_areas const* fa_;
-  point_rtree<nigiri::location_idx_t> const* loc_tree_;
+  static_point_rtree<nigiri::location_idx_t> const* loc_tree_;
   platform_matches_t const* matches_;
   adr_ext const* ae_;
   tz_map_t const* tz_;
@@ -23,7 +23,7 @@
 #include "motis/osr/parameters.h"
 #include "motis/parse_location.h"
 #include "motis/place.h"
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 
 namespace motis::ep {
 
@@ -104,7 +104,7 @@ struct one_to_many_intermodal {
   std::shared_ptr<rt> const& rt_;
   tag_lookup const& tags_;
   flex::flex_areas const* fa_;
-  point_rtree<nigiri::location_idx_t> const* loc_tree_;
+  static_point_rtree<nigiri::location_idx_t> const* loc_tree_;
   platform_matches_t const* matches_;
   way_matches_storage const* way_matches_;
   std::shared_ptr<gbfs::gbfs_data> const& gbfs_;
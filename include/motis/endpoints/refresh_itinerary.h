@@ -10,7 +10,7 @@
 #include "motis-api/motis-api.h"
 #include "motis/fwd.h"
 #include "motis/match_platforms.h"
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 #include "motis/types.h"
 
 namespace motis::ep {
@@ -26,7 +26,7 @@ struct refresh_itinerary {
   nigiri::timetable const& tt_;
   nigiri::routing::tb::tb_data const* tbd_;
   tag_lookup const& tags_;
-  point_rtree<nigiri::location_idx_t> const& loc_tree_;
+  static_point_rtree<nigiri::location_idx_t> const& loc_tree_;
   flex::flex_areas const* fa_;
   platform_matches_t const* matches_;
   way_matches_storage const* way_matches_;
@@ -53,7 +53,7 @@ struct refresh_itinerary_post {
   nigiri::timetable const& tt_;
   nigiri::routing::tb::tb_data const* tbd_;
   tag_lookup const& tags_;
-  point_rtree<nigiri::location_idx_t> const& loc_tree_;
+  static_point_rtree<nigiri::location_idx_t> const& loc_tree_;
   flex::flex_areas const* fa_;
   platform_matches_t const* matches_;
   way_matches_storage const* way_matches_;
@@ -117,7 +117,7 @@ struct routing {
   nigiri::timetable const* tt_;
   nigiri::routing::tb::tb_data const* tbd_;
   tag_lookup const* tags_;
-  point_rtree<nigiri::location_idx_t> const* loc_tree_;
+  static_point_rtree<nigiri::location_idx_t> const* loc_tree_;
   flex::flex_areas const* fa_;
   platform_matches_t const* matches_;
   way_matches_storage const* way_matches_;
@@ -129,6 +129,7 @@ struct routing {
   odm::bounds const* odm_bounds_;
   odm::ride_sharing_bounds const* ride_sharing_bounds_;
   metrics_registry* metrics_;
+  offsets_cache* offsets_cache_{nullptr};
 };
 
 }  // namespace motis::ep
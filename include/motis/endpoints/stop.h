@@ -8,7 +8,7 @@
 #include "motis/data.h"
 #include "motis/fwd.h"
 #include "motis/match_platforms.h"
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 
 namespace motis::ep {
 
@@ -22,7 +22,7 @@ struct stop {
   adr::typeahead const* t_;
   adr_ext const* ae_;
   tz_map_t const* tz_;
-  point_rtree<nigiri::location_idx_t> const& loc_rtree_;
+  static_point_rtree<nigiri::location_idx_t> const& loc_rtree_;
   tag_lookup const& tags_;
   nigiri::timetable const& tt_;
 };
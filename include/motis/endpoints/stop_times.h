@@ -12,7 +12,7 @@
 #include "motis-api/motis-api.h"
 #include "motis/fwd.h"
 #include "motis/match_platforms.h"
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 #include "motis/types.h"
 
 namespace motis::ep {
@@ -37,7 +37,7 @@ struct stop_times {
   adr::typeahead const* t_;
   adr_ext const* ae_;
   tz_map_t const* tz_;
-  point_rtree<nigiri::location_idx_t> const& loc_rtree_;
+  static_point_rtree<nigiri::location_idx_t> const& loc_rtree_;
   nigiri::timetable const& tt_;
   tag_lookup const& tags_;
   std::shared_ptr<rt> const& rt_;
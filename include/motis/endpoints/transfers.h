@@ -9,7 +9,7 @@
 #include "motis-api/motis-api.h"
 #include "motis/fwd.h"
 #include "motis/match_platforms.h"
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 #include "motis/types.h"
 
 namespace motis::ep {
@@ -23,7 +23,7 @@ struct transfers {
   osr::ways const& w_;
   osr::lookup const& l_;
   osr::platforms const& pl_;
-  point_rtree<nigiri::location_idx_t> const& loc_rtree_;
+  static_point_rtree<nigiri::location_idx_t> const& loc_rtree_;
   platform_matches_t const& matches_;
   std::shared_ptr<rt> rt_;
 };
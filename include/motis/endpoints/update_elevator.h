@@ -10,7 +10,7 @@
 
 #include "motis/fwd.h"
 #include "motis/match_platforms.h"
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 #include "motis/types.h"
 
 namespace motis::ep {
@@ -23,11 +23,13 @@ struct update_elevator {
   osr::ways const& w_;
   osr::lookup const& l_;
   osr::platforms const& pl_;
-  point_rtree<nigiri::location_idx_t> const& loc_rtree_;
+  static_point_rtree<nigiri::location_idx_t> const& loc_rtree_;
   hash_set<osr::node_idx_t> const& elevator_nodes_;
   elevator_id_osm_mapping_t const* elevator_ids_;
   platform_matches_t const& matches_;
+  elevator_footpath_index const* elevator_footpath_index_;
   std::shared_ptr<rt>& rt_;
+  offsets_cache* offsets_cache_;
 };
 
 }  // namespace motis::ep
\ No newline at end of file
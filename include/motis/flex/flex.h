@@ -34,13 +34,14 @@ bool is_in_flex_stop(nigiri::timetable const&,
                      nigiri::flex_stop_t const&,
                      osr::node_idx_t);
 
-flex_routings_t get_flex_routings(nigiri::timetable const&,
-                                  point_rtree<nigiri::location_idx_t> const&,
-                                  nigiri::routing::start_time_t,
-                                  geo::latlng const&,
-                                  osr::direction,
-                                  std::chrono::seconds max,
-                                  osr_parameters const&);
+flex_routings_t get_flex_routings(
+    nigiri::timetable const&,
+    static_point_rtree<nigiri::location_idx_t> const&,
+    nigiri::routing::start_time_t,
+    geo::latlng const&,
+    osr::direction,
+    std::chrono::seconds max,
+    osr_parameters const&);
 
 void add_flex_td_offsets(osr::ways const&,
                          osr::lookup const&,
@@ -49,7 +50,7 @@ void add_flex_td_offsets(osr::ways const&,
                          way_matches_storage const*,
                          nigiri::timetable const&,
                          flex_areas const&,
-                         point_rtree<nigiri::location_idx_t> const&,
+                         static_point_rtree<nigiri::location_idx_t> const&,
                          nigiri::routing::start_time_t,
                          osr::location const&,
                          osr::direction,
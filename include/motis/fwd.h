@@ -50,11 +50,18 @@ struct tag_lookup;
 struct config;
 struct railviz_static_index;
 struct railviz_rt_index;
+struct running_trips_static_index;
+struct running_trips_rt_index;
 struct elevators;
+struct elevator_footpath_index;
 struct metrics_registry;
 struct way_matches_storage;
 struct data;
 struct adr_ext;
+struct offsets_cache;
+
+template <typename T>
+struct static_point_rtree;
 
 namespace odm {
 struct bounds;
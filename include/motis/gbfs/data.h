@@ -31,11 +31,11 @@
 #include "motis/box_rtree.h"
 #include "motis/config.h"
 #include "motis/fwd.h"
+#include "motis/gbfs/sparse_bitvec.h"
 #include "motis/point_rtree.h"
+#include "motis/sharded_cache.h"
 #include "motis/types.h"
 
-#include "motis/gbfs/lru_cache.h"
-
 namespace motis::gbfs {
 
 enum class gbfs_version : std::uint8_t {
@@ -304,23 +304,36 @@ struct compressed_routing_data {
   std::vector<geo::latlng> additional_node_coordinates_;
   osr::hash_map<osr::node_idx_t, std::vector<osr::additional_edge>>
       additional_edges_{};
-  compressed_bitvec start_allowed_{};
-  compressed_bitvec end_allowed_{};
-  compressed_bitvec through_allowed_{};
+  sparse_bitvec start_allowed_{};
+  sparse_bitvec end_allowed_{};
+  sparse_bitvec through_allowed_{};
+};
+
+// Decompressed bitvecs of one products group: osr routing needs bitvecs.
+struct products_bitvecs {
+  explicit products_bitvecs(compressed_routing_data const&);
+
+  osr::bitvec<osr::node_idx_t> start_allowed_;
+  osr::bitvec<osr::node_idx_t> end_allowed_;
+  osr::bitvec<osr::node_idx_t> through_allowed_;
 };
 
 struct provider_routing_data;
+struct osr_mapping_cache;
 
 struct products_routing_data {
   products_routing_data(std::shared_ptr<provider_routing_data const>&& prd,
-                        compressed_routing_data const& compressed);
+                        compressed_routing_data const& compressed,
+                        std::shared_ptr<products_bitvecs const>&& bitvecs);
 
   osr::sharing_data get_sharing_data(
       osr::node_idx_t::value_t const additional_node_offset,
       bool ignore_return_constraints) const {
-    return {.start_allowed_ = &start_allowed_,
-            .end_allowed_ = ignore_return_constraints ? nullptr : &end_allowed_,
-            .through_allowed_ = &through_allowed_,
+    return {.start_allowed_ = &bitvecs_->start_allowed_,
+            .end_allowed_ = ignore_return_constraints
+                                ? nullptr
+                                : &bitvecs_->end_allowed_,
+            .through_allowed_ = &bitvecs_->through_allowed_,
             .additional_node_offset_ = additional_node_offset,
             .additional_node_coordinates_ =
                 compressed_.additional_node_coordinates_,
@@ -329,10 +342,7 @@ struct products_routing_data {
 
   std::shared_ptr<provider_routing_data const> provider_routing_data_;
   compressed_routing_data const& compressed_;
-
-  osr::bitvec<osr::node_idx_t> start_allowed_;
-  osr::bitvec<osr::node_idx_t> end_allowed_;
-  osr::bitvec<osr::node_idx_t> through_allowed_;
+  std::shared_ptr<products_bitvecs const> bitvecs_;
 };
 
 using gbfs_products_idx_t =
@@ -343,10 +353,22 @@ struct provider_routing_data
   std::shared_ptr<products_routing_data> get_products_routing_data(
       gbfs_products_idx_t const prod_idx) const {
     return std::make_shared<products_routing_data>(
-        shared_from_this(), products_.at(to_idx(prod_idx)));
+        shared_from_this(), products_.at(to_idx(prod_idx)),
+        get_bitvecs(prod_idx));
   }
 
+  // Decompressed on first use, kept as long as this provider routing data
+  // is cached (see `gbfs_data::cache_`).
+  std::shared_ptr<products_bitvecs const> get_bitvecs(
+      gbfs_products_idx_t) const;
+
   std::vector<compressed_routing_data> products_;
+
+  mutable std::mutex bitvecs_mutex_;
+  mutable std::vector<std::shared_ptr<products_bitvecs const>> bitvecs_;
+
+  // intermediate results reused when mapping the next update of the provider
+  std::shared_ptr<osr_mapping_cache const> mapping_cache_;
 };
 
 struct provider_products {
@@ -458,7 +480,9 @@ struct aggregated_feed {
 };
 
 struct gbfs_data {
-  explicit gbfs_data(std::size_t const cache_size) : cache_{cache_size} {}
+  explicit gbfs_data(std::size_t const cache_size,
+                     cache_metrics const metrics = {})
+      : cache_{cache_size, metrics} {}
 
   std::shared_ptr<products_routing_data> get_products_routing_data(
       osr::ways const& w, osr::lookup const& l, gbfs_products_ref);
@@ -475,7 +499,7 @@ struct gbfs_data {
 
   hash_map<std::string, gbfs_group> groups_{};
 
-  lru_cache<gbfs_provider_idx_t, provider_routing_data> cache_;
+  sharded_cache<gbfs_provider_idx_t, provider_routing_data> cache_;
 
   // used to share decompressed routing data between routing requests
   std::mutex products_routing_data_mutex_;
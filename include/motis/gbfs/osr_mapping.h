@@ -1,15 +1,61 @@
 #pragma once
 
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cista/hash.h"
+
+#include "osr/lookup.h"
+#include "osr/types.h"
+
 #include "motis/fwd.h"
+#include "motis/types.h"
 
 namespace motis::gbfs {
 
 struct gbfs_provider;
 struct provider_routing_data;
 
+struct node_match {
+  osr::way_candidate const& way() const { return wc_; }
+  osr::node_candidate const& node() const {
+    return left_ ? wc_.left_ : wc_.right_;
+  }
+
+  osr::way_candidate wc_;
+  bool left_{};
+};
+
+// Intermediate results of mapping a provider to the street network.
+// The next update of the same provider reuses them for unchanged inputs:
+// geofencing results of products with the same zones and vehicle types,
+// node matches of stations and vehicles that did not move and the nodes
+// inside station areas if the station information did not change.
+struct osr_mapping_cache {
+  struct geofencing {
+    std::vector<std::pair<osr::node_idx_t, bool>> end_allowed_;
+    std::vector<std::pair<osr::node_idx_t, bool>> through_allowed_;
+  };
+
+  struct stats {
+    unsigned geofencing_reused_{0U};
+    unsigned geofencing_computed_{0U};
+    unsigned locations_reused_{0U};
+    unsigned locations_computed_{0U};
+  };
+
+  hash_map<cista::hash_t, geofencing> geofencing_;
+  hash_map<std::pair<double, double>, std::vector<node_match>> node_matches_;
+  cista::hash_t station_information_hash_{0U};
+  hash_map<std::string, std::vector<osr::node_idx_t>> station_area_nodes_;
+  stats stats_{};
+};
+
 void map_data(osr::ways const&,
               osr::lookup const&,
               gbfs_provider const&,
-              provider_routing_data&);
+              provider_routing_data&,
+              osr_mapping_cache const* prev = nullptr);
 
 }  // namespace motis::gbfs
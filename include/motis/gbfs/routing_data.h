@@ -40,8 +40,13 @@ struct gbfs_routing_data {
       products_ref_to_transport_mode_;
 };
 
+// prev: routing data of the previous version of this provider (optional),
+// intermediate results for unchanged inputs are reused
 std::shared_ptr<provider_routing_data> compute_provider_routing_data(
-    osr::ways const&, osr::lookup const&, gbfs_provider const&);
+    osr::ways const&,
+    osr::lookup const&,
+    gbfs_provider const&,
+    provider_routing_data const* prev = nullptr);
 
 std::shared_ptr<provider_routing_data> get_provider_routing_data(
     osr::ways const&, osr::lookup const&, gbfs_data&, gbfs_provider const&);
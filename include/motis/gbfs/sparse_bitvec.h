@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cinttypes>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "cista/containers/bitvec.h"
+
+namespace motis::gbfs {
+
+// Bit vector stored as a default value plus the runs of bits that differ
+// from it. Geofencing restrictions are uniform across large areas and only
+// a few nodes (zones, stations, vehicles) deviate from the default. This
+// needs a few bytes per run instead of one bit per OSM node.
+struct sparse_bitvec {
+  using run_t = std::pair<std::uint32_t, std::uint32_t>;  // [from, to)
+
+  template <typename Vec, typename Key>
+  static sparse_bitvec from(cista::basic_bitvec<Vec, Key> const& bv) {
+    using block_t = typename cista::basic_bitvec<Vec, Key>::block_t;
+    constexpr auto const kBits = sizeof(block_t) * 8U;
+
+    auto const size = static_cast<std::size_t>(bv.size());
+    auto count = std::size_t{0U};
+    for (auto const b : bv.blocks_) {
+      count += static_cast<std::size_t>(std::popcount(b));
+    }
+
+    auto sbv = sparse_bitvec{.size_ = size, .default_ = 2U * count > size};
+    auto const flip = sbv.default_ ? ~block_t{0U} : block_t{0U};
+    for (auto block_idx = std::size_t{0U}; block_idx != bv.blocks_.size();
+         ++block_idx) {
+      auto deviating = static_cast<block_t>(bv.blocks_[block_idx] ^ flip);
+      while (deviating != 0U) {
+        auto const bit = static_cast<std::size_t>(std::countr_zero(deviating));
+        auto const i = block_idx * kBits + bit;
+        if (i >= size) {
+          break;
+        }
+        deviating &= deviating - 1U;
+        if (!sbv.runs_.empty() && sbv.runs_.back().second == i) {
+          ++sbv.runs_.back().second;
+        } else {
+          sbv.runs_.emplace_back(static_cast<std::uint32_t>(i),
+                                 static_cast<std::uint32_t>(i + 1U));
+        }
+      }
+    }
+    sbv.runs_.shrink_to_fit();
+    return sbv;
+  }
+
+  bool test(std::size_t const i) const {
+    auto const it = std::ranges::upper_bound(
+        runs_, i, std::less<>{},
+        [](run_t const& r) { return static_cast<std::size_t>(r.first); });
+    return it != begin(runs_) && i < std::prev(it)->second ? !default_
+                                                           : default_;
+  }
+
+  template <typename Vec, typename Key>
+  void to_bitvec(cista::basic_bitvec<Vec, Key>& bv) const {
+    using bitvec_t = cista::basic_bitvec<Vec, Key>;
+    using block_t = typename bitvec_t::block_t;
+    constexpr auto const kBits = sizeof(block_t) * 8U;
+
+    bv.resize(static_cast<typename bitvec_t::size_type>(size_));
+    if (default_) {
+      bv.one_out();
+    } else {
+      bv.zero_out();
+    }
+
+    auto const mask = [&](std::size_t const from, std::size_t const to) {
+      // bits [from, to) within one block, to - from < kBits
+      return static_cast<block_t>(((block_t{1U} << (to - from)) - 1U) << from);
+    };
+    auto const apply = [&](std::size_t const block_idx, block_t const m) {
+      if (default_) {
+        bv.blocks_[block_idx] &= static_cast<block_t>(~m);
+      } else {
+        bv.blocks_[block_idx] |= m;
+      }
+    };
+
+    for (auto const [from, to] : runs_) {
+      auto const first_block = from / kBits;
+      auto const last_block = (to - 1U) / kBits;
+      if (first_block == last_block) {
+        auto const n = to - from;
+        apply(first_block, n == kBits ? ~block_t{0U}
+                                      : mask(from % kBits, from % kBits + n));
+        continue;
+      }
+      apply(first_block,
+            from % kBits == 0U ? ~block_t{0U} : mask(from % kBits, kBits));
+      for (auto b = first_block + 1U; b != last_block; ++b) {
+        bv.blocks_[b] = default_ ? block_t{0U} : ~block_t{0U};
+      }
+      auto const to_bit = (to - 1U) % kBits + 1U;
+      apply(last_block, to_bit == kBits ? ~block_t{0U} : mask(0U, to_bit));
+    }
+  }
+
+  std::size_t allocated_bytes() const {
+    return sizeof(sparse_bitvec) + runs_.capacity() * sizeof(run_t);
+  }
+
+  std::size_t size_{};
+  bool default_{};
+  std::vector<run_t> runs_{};
+};
+
+}  // namespace motis::gbfs
@@ -32,11 +32,14 @@ constexpr auto const tiles_version = []() {
   return meta_entry_t{"tiles_bin_ver", 1U};
 };
 constexpr auto const osr_footpath_version = []() {
-  return meta_entry_t{"osr_footpath_bin_ver", 3U};
+  return meta_entry_t{"osr_footpath_bin_ver", 4U};
 };
 constexpr auto const routed_shapes_version = []() {
   return meta_entry_t{"routed_shapes_ver", 11U};
 };
+constexpr auto const indices_version = []() {
+  return meta_entry_t{"indices_bin_ver", 2U};
+};
 
 std::string to_str(meta_t const&);
 
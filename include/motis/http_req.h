@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <map>
+#include <optional>
 #include <string>
 
 #include "boost/asio/awaitable.hpp"
@@ -11,6 +12,8 @@
 
 namespace motis {
 
+struct metrics_registry;
+
 constexpr auto const kBodySizeLimit = 512U * 1024U * 1024U;  // 512 M
 
 using http_response =
@@ -21,12 +24,23 @@ struct proxy {
   std::string host_, port_;
 };
 
+// Connections are kept alive and reused per executor context. Responses with
+// ETag/Last-Modified are revalidated: a "304 Not Modified" answer returns
+// the previously received response.
 boost::asio::awaitable<http_response> http_GET(
     boost::urls::url,
     std::map<std::string, std::string> const& headers,
     std::chrono::seconds timeout,
     std::optional<proxy> const& = std::nullopt);
 
+// Like http_GET, but std::nullopt if the server answered the revalidation of
+// the previously received response with "304 Not Modified".
+boost::asio::awaitable<std::optional<http_response>> http_GET_if_modified(
+    boost::urls::url,
+    std::map<std::string, std::string> const& headers,
+    std::chrono::seconds timeout,
+    std::optional<proxy> const& = std::nullopt);
+
 boost::asio::awaitable<http_response> http_POST(
     boost::urls::url,
     std::map<std::string, std::string> const& headers,
@@ -36,4 +50,7 @@ boost::asio::awaitable<http_response> http_POST(
 
 std::string get_http_body(http_response const&);
 
+// Counts new/reused connections and conditional GET results (nullptr: off).
+void set_http_metrics(metrics_registry const*);
+
 }  // namespace motis
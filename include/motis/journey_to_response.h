@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string_view>
 #include <variant>
 #include <vector>
@@ -48,6 +49,7 @@ using alternatives_context = std::variant<
     // precomputed
     std::vector<nigiri::routing::journey>>;
 
+// `leg_ms`, if set: reconstruction time of each leg in milliseconds.
 api::Itinerary journey_to_response(
     osr::ways const*,
     osr::lookup const*,
@@ -84,6 +86,7 @@ api::Itinerary journey_to_response(
     bool ignore_dest_rental_return_constraints,
     std::optional<std::vector<std::string>> const& language,
     bool const set_itinerary_id_field = true,
-    alternatives_context const& alternatives = {});
+    alternatives_context const& alternatives = {},
+    std::vector<std::uint64_t>* leg_ms = nullptr);
 
 }  // namespace motis
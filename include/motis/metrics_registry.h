@@ -44,6 +44,30 @@ struct metrics_registry {
   prometheus::Family<prometheus::Gauge>& last_update_;
   prometheus::Gauge& last_update_rt_;
   prometheus::Gauge& last_update_gbfs_;
+  prometheus::Counter& offsets_cache_invalidations_;
+  prometheus::Family<prometheus::Histogram>&
+      rt_snapshot_build_duration_seconds_;
+  prometheus::Histogram& rt_snapshot_build_duration_seconds_copy_;
+  prometheus::Histogram& rt_snapshot_build_duration_seconds_apply_;
+  prometheus::Histogram& rt_snapshot_build_duration_seconds_index_;
+  prometheus::Histogram& rt_snapshot_build_duration_seconds_total_;
+  prometheus::Counter& rt_snapshot_transports_copied_;
+  prometheus::Counter& rt_snapshot_reused_;
+  prometheus::Family<prometheus::Gauge>& request_queue_depth_;
+  prometheus::Family<prometheus::Gauge>& requests_running_;
+  prometheus::Family<prometheus::Histogram>& request_queue_wait_seconds_;
+  prometheus::Family<prometheus::Counter>& requests_rejected_;
+  prometheus::Family<prometheus::Counter>& cache_requests_;
+  prometheus::Family<prometheus::Counter>& cache_evictions_;
+  prometheus::Family<prometheus::Gauge>& gbfs_provider_update_seconds_;
+  prometheus::Family<prometheus::Counter>& gbfs_osr_mapping_;
+  prometheus::Family<prometheus::Counter>& http_connections_;
+  prometheus::Counter& http_connections_new_;
+  prometheus::Counter& http_connections_reused_;
+  prometheus::Family<prometheus::Counter>& http_conditional_requests_;
+  prometheus::Counter& http_not_modified_;
+  prometheus::Counter& http_modified_;
+  prometheus::Family<prometheus::Histogram>& tiles_render_duration_seconds_;
 
 private:
   metrics_registry(prometheus::Histogram::BucketBoundaries event_boundaries,
@@ -41,6 +41,7 @@
 #include "motis/gbfs/update.h"
 #include "motis/metrics_registry.h"
 #include "motis/rt_update.h"
+#include "motis/tiles_data.h"
 
 namespace motis {
 
@@ -169,9 +170,11 @@ struct motis_instance {
               });
 
     qr_.route("GET", "/metrics",
-              ep::metrics{d.tt_.get(), d.tags_.get(), d.rt_, d.metrics_.get()});
+              ep::metrics{d.tt_.get(), d.tags_.get(), d.rt_, d.metrics_.get(),
+                          d.running_trips_.get()});
     qr_.route("GET", "/gtfsrt",
-              ep::gtfsrt{c, d.tt_.get(), d.tags_.get(), d.rt_});
+              ep::gtfsrt{c, d.tt_.get(), d.tags_.get(), d.rt_,
+                         ep::gtfsrt::make_cache()});
     qr_.serve_files(c.server_.value_or(config::server{}).web_folder_);
     qr_.enable_cors();
   }
@@ -203,20 +206,30 @@ struct motis_instance {
                         run_rt_update(ioc, c, d);
                       }};
     }
+
+    if (d.tiles_ && c.tiles_ && c.tiles_->prewarm_max_zoom_) {
+      tiles_ = io_thread{"motis tiles prewarm",
+                         [&](boost::asio::io_context& ioc) {
+                           d.tiles_->prewarm(ioc, tiles_prewarm_area(d),
+                                             *c.tiles_->prewarm_max_zoom_);
+                         }};
+    }
   }
 
   void stop() {
     rt_.stop();
     gbfs_.stop();
+    tiles_.stop();
   }
 
   void join() {
     rt_.join();
     gbfs_.join();
+    tiles_.join();
   }
 
   net::query_router<Executor> qr_{};
-  io_thread rt_, gbfs_;
+  io_thread rt_, gbfs_, tiles_;
 };
 
 }  // namespace motis
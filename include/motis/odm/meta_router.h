@@ -4,12 +4,15 @@
 #include <variant>
 #include <vector>
 
+#include "ctx/future.h"
+
 #include "osr/location.h"
 
 #include "nigiri/types.h"
 
 #include "motis-api/motis-api.h"
 
+#include "motis/ctx_data.h"
 #include "motis/endpoints/routing.h"
 #include "motis/fwd.h"
 #include "motis/gbfs/routing_data.h"
@@ -69,8 +72,8 @@ struct meta_router {
 private:
   nigiri::routing::query get_base_query(
       nigiri::interval<nigiri::unixtime_t> const&) const;
-  std::vector<routing_result> search_interval(
-      std::vector<nigiri::routing::query> const&) const;
+  ctx::future_ptr<ctx_data, routing_result> search_interval(
+      nigiri::routing::query) const;
 
   ep::routing const& r_;
   api::plan_params const& query_;
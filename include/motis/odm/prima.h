@@ -1,6 +1,10 @@
 #pragma once
 
 #include <chrono>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "geo/latlng.h"
@@ -32,6 +36,18 @@ static auto const kReqHeaders = std::map<std::string, std::string>{
 
 using service_times_t = std::vector<nigiri::interval<nigiri::unixtime_t>>;
 
+// Response body of a PRIMA request, std::nullopt if networking failed.
+using prima_response_t = std::optional<std::string>;
+
+// Calling the returned function waits for the response. Within a ctx
+// operation, the request is sent immediately on the I/O context of the
+// scheduler and waiting suspends the operation instead of blocking the worker
+// thread. Outside of ctx, it is sent on a private I/O context when waiting.
+std::function<prima_response_t()> prima_post(boost::urls::url const&,
+                                             std::string body,
+                                             std::chrono::seconds timeout,
+                                             std::string_view log_tag);
+
 struct direct_ride {
   nigiri::unixtime_t dep_;
   nigiri::unixtime_t arr_;
@@ -83,6 +99,11 @@ struct prima {
   bool blacklist_taxi(nigiri::timetable const&,
                       nigiri::interval<nigiri::unixtime_t> const&);
 
+  // Sends the request, the returned function waits for and consumes the
+  // response.
+  std::function<bool()> blacklist_taxi_async(
+      nigiri::timetable const&, nigiri::interval<nigiri::unixtime_t> const&);
+
   std::string make_whitelist_taxi_request(
       std::vector<nigiri::routing::start> const& first_mile,
       std::vector<nigiri::routing::start> const& last_mile,
@@ -98,6 +119,7 @@ struct prima {
   std::string make_ride_sharing_request(nigiri::timetable const&) const;
   bool consume_ride_sharing_response(std::string_view json);
   bool whitelist_ride_sharing(nigiri::timetable const&);
+  std::function<bool()> whitelist_ride_sharing_async(nigiri::timetable const&);
 
   void extract_taxis_for_persisting(
       std::vector<nigiri::routing::journey> const& journeys);
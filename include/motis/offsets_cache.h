@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <cinttypes>
+#include <memory>
+#include <vector>
+
+#include "cista/hashing.h"
+
+#include "geo/latlng.h"
+
+#include "osr/location.h"
+#include "osr/routing/profile.h"
+#include "osr/types.h"
+
+#include "nigiri/routing/query.h"
+
+#include "motis/fwd.h"
+#include "motis/osr/parameters.h"
+#include "motis/sharded_cache.h"
+
+namespace motis {
+
+struct offsets_cache_key {
+  bool operator==(offsets_cache_key const&) const = default;
+
+  cista::hash_t hash() const noexcept {
+    return cista::build_hash(lat_, lng_, lvl_, profile_, dir_,
+                             pedestrian_speed_, cycling_speed_,
+                             use_wheelchair_, max_, max_matching_distance_,
+                             with_rt_);
+  }
+
+  std::int32_t lat_;
+  std::int32_t lng_;
+  float lvl_;
+  osr::search_profile profile_;
+  osr::direction dir_;
+  float pedestrian_speed_;
+  float cycling_speed_;
+  bool use_wheelchair_;
+  std::int64_t max_;
+  double max_matching_distance_;
+  bool with_rt_;
+};
+
+offsets_cache_key make_offsets_cache_key(osr::location const&,
+                                         osr::search_profile,
+                                         osr::direction,
+                                         osr_parameters const&,
+                                         std::chrono::seconds max,
+                                         double max_matching_distance,
+                                         bool with_rt);
+
+// Caches pre-/post-transit offsets of non-rental street searches.
+// Entries computed with real-time data are dropped on RT updates that change
+// the set of stops with traffic within the search radius of the entry.
+struct offsets_cache {
+  using offsets_t =
+      std::shared_ptr<std::vector<nigiri::routing::offset> const>;
+
+  offsets_cache(std::size_t max_size, metrics_registry*);
+
+  offsets_t get(offsets_cache_key const&);
+
+  // `is_current` is checked while holding the shard lock: this way, an entry
+  // computed for an outdated RT timetable can't be inserted after the
+  // invalidation for the new RT timetable already ran.
+  template <typename Fn>
+  void put(offsets_cache_key const& key,
+           geo::latlng const& pos,
+           double const radius,
+           std::vector<nigiri::routing::offset> offsets,
+           Fn&& is_current) {
+    cache_.put(key, [&]() {
+      return is_current() ? std::make_shared<entry>(
+                                entry{pos, radius, std::move(offsets)})
+                          : nullptr;
+    });
+  }
+
+  void invalidate(nigiri::timetable const&,
+                  nigiri::rt_timetable const* prev,
+                  nigiri::rt_timetable const* next);
+
+  std::size_t size() const;
+
+private:
+  struct entry {
+    geo::latlng pos_;
+    double radius_;
+    std::vector<nigiri::routing::offset> offsets_;
+  };
+
+  metrics_registry* metrics_;
+  sharded_cache<offsets_cache_key, entry> cache_;
+};
+
+}  // namespace motis
@@ -1,6 +1,8 @@
 #pragma once
 
-#include <memory>
+#include <filesystem>
+
+#include "cista/memory_holder.h"
 
 #include "motis-api/motis-api.h"
 #include "motis/fwd.h"
@@ -10,14 +12,21 @@ namespace motis {
 
 struct railviz_static_index {
   railviz_static_index(nigiri::timetable const&, nigiri::shapes_storage const*);
+  explicit railviz_static_index(std::filesystem::path const&);
   ~railviz_static_index();
 
+  void write(std::filesystem::path const&) const;
+
   struct impl;
-  std::unique_ptr<impl> impl_;
+  cista::wrapped<impl> impl_;
 };
 
 struct railviz_rt_index {
-  railviz_rt_index(nigiri::timetable const&, nigiri::rt_timetable const&);
+  // `cache_size`: byte budget for the trip segments cached per map tile
+  railviz_rt_index(nigiri::timetable const&,
+                   nigiri::rt_timetable const&,
+                   std::size_t cache_size,
+                   metrics_registry const* = nullptr);
   ~railviz_rt_index();
 
   struct impl;
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cinttypes>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+#include "motis/config.h"
+#include "motis/fwd.h"
+
+namespace prometheus {
+class Counter;
+class Gauge;
+class Histogram;
+}  // namespace prometheus
+
+namespace motis {
+
+enum class request_class : std::uint8_t { kInteractive, kRouting, kBatch };
+
+constexpr auto const kNumRequestClasses = 3U;
+
+std::string_view to_str(request_class);
+
+request_class classify_request(std::string_view target);
+
+// The class of the request currently dispatched by this thread.
+// Set by the HTTP request handler, read by the executor.
+request_class get_current_request_class();
+void set_current_request_class(request_class);
+
+// Admission control for request handlers.
+// At most `n_threads` requests run at the same time. Each request class has
+// its own queue with optional limits for the number of running and queued
+// requests. Whenever a request finishes, the freed worker picks the next
+// request from the highest priority queue that is below its limit - not
+// necessarily from the queue of the finished request.
+struct request_scheduler {
+  using task_t = std::function<void()>;
+
+  request_scheduler(config const&, metrics_registry&);
+
+  static bool is_enabled(config const&);
+
+  // Returns false if the request was rejected because the queue is full.
+  // Otherwise `start` is called (possibly later, from another thread) as soon
+  // as the request may run. The request has to call `finish` when done.
+  bool submit(request_class, task_t start);
+  void finish(request_class);
+
+private:
+  struct queued_task {
+    task_t start_;
+    std::chrono::steady_clock::time_point enqueued_;
+  };
+
+  struct queue {
+    unsigned max_running_{0U};
+    unsigned max_queued_{0U};
+    unsigned running_{0U};
+    std::deque<queued_task> tasks_;
+    prometheus::Gauge* depth_;
+    prometheus::Gauge* running_gauge_;
+    prometheus::Histogram* wait_;
+    prometheus::Counter* rejected_;
+  };
+
+  bool can_run(queue const&) const;
+  void start(queue&, std::chrono::steady_clock::time_point enqueued);
+  std::optional<queued_task> pop_next();
+
+  std::mutex mutex_;
+  unsigned max_running_;
+  unsigned running_{0U};
+  std::array<queue, kNumRequestClasses> queues_;
+};
+
+}  // namespace motis
@@ -3,6 +3,7 @@
 #include "prometheus/counter.h"
 #include "prometheus/family.h"
 #include "prometheus/gauge.h"
+#include "prometheus/histogram.h"
 
 #include "motis/metrics_registry.h"
 
@@ -251,6 +252,22 @@ struct rt_metric_families {
             prometheus::BuildGauge()
                 .Name("nigiri_vdvaus_last_update_timestamp_seconds")
                 .Help("Last update timestamp of the VDV AUS feed")
+                .Register(registry)},
+        rt_fetch_duration_{
+            prometheus::BuildHistogram()
+                .Name("motis_rt_fetch_duration_seconds")
+                .Help("Duration of real-time feed downloads")
+                .Register(registry)},
+        rt_parse_duration_{
+            prometheus::BuildHistogram()
+                .Name("motis_rt_parse_duration_seconds")
+                .Help("Duration of parsing real-time feeds")
+                .Register(registry)},
+        rt_apply_duration_{
+            prometheus::BuildHistogram()
+                .Name("motis_rt_apply_duration_seconds")
+                .Help("Duration of applying real-time feeds to the real-time "
+                      "timetable")
                 .Register(registry)} {}
 
   prometheus::Family<prometheus::Counter>& gtfsrt_updates_requested_;
@@ -300,6 +317,26 @@ struct rt_metric_families {
   prometheus::Family<prometheus::Counter>& vdvaus_propagated_delays_;
   prometheus::Family<prometheus::Gauge>& vdvaus_feed_timestamp_;
   prometheus::Family<prometheus::Gauge>& vdvaus_last_update_timestamp_;
+
+  prometheus::Family<prometheus::Histogram>& rt_fetch_duration_;
+  prometheus::Family<prometheus::Histogram>& rt_parse_duration_;
+  prometheus::Family<prometheus::Histogram>& rt_apply_duration_;
+};
+
+struct rt_latency_metrics {
+  explicit rt_latency_metrics(std::string const& tag,
+                              rt_metric_families const& m)
+      : fetch_{m.rt_fetch_duration_.Add({{"tag", tag}}, buckets())},
+        parse_{m.rt_parse_duration_.Add({{"tag", tag}}, buckets())},
+        apply_{m.rt_apply_duration_.Add({{"tag", tag}}, buckets())} {}
+
+  static prometheus::Histogram::BucketBoundaries buckets() {
+    return {0.01, 0.05, 0.1, 0.25, 0.5, 1, 2, 5, 10, 20, 30, 60};
+  }
+
+  prometheus::Histogram& fetch_;
+  prometheus::Histogram& parse_;
+  prometheus::Histogram& apply_;
 };
 
 struct gtfsrt_metrics {
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cinttypes>
+#include <functional>
+#include <vector>
+
+#include "nigiri/types.h"
+
+#include "motis/fwd.h"
+
+namespace motis {
+
+// Scheduled transports by the hours (relative to midnight of their service
+// day) in which they are running. Finding the transports that run in a time
+// interval only visits the matching hour buckets of the few service days
+// that can reach the interval instead of every transport of every route.
+struct running_trips_static_index {
+  struct entry {
+    nigiri::transport_idx_t t_;
+    nigiri::provider_idx_t provider_;
+    std::uint16_t from_, to_;  // minutes after midnight of the service day
+  };
+
+  explicit running_trips_static_index(nigiri::timetable const&);
+
+  // Calls `fn` with the provider of each transport running in `interval`.
+  // Traffic days are taken from `rtt` (if set) to exclude cancellations.
+  void for_each_running(
+      nigiri::timetable const&,
+      nigiri::rt_timetable const*,
+      nigiri::interval<nigiri::unixtime_t>,
+      std::function<void(nigiri::provider_idx_t)> const&) const;
+
+  std::vector<std::vector<entry>> buckets_;  // index: hour of service day
+  std::int64_t max_days_{0};
+};
+
+// Scheduled transports with real-time updates of one RT snapshot, bucketed
+// by the hours (since the start of the timetable) in which they are running.
+struct running_trips_rt_index {
+  struct entry {
+    nigiri::provider_idx_t provider_;
+    nigiri::interval<nigiri::unixtime_t> active_;
+  };
+
+  running_trips_rt_index(nigiri::timetable const&,
+                         nigiri::rt_timetable const&);
+
+  void for_each_running(
+      nigiri::interval<nigiri::unixtime_t>,
+      std::function<void(nigiri::provider_idx_t)> const&) const;
+
+  nigiri::unixtime_t origin_;
+  std::int64_t first_hour_{0};
+  std::vector<std::vector<entry>> buckets_;
+};
+
+}  // namespace motis
@@ -0,0 +1,379 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "cista/hashing.h"
+
+#include "motis/fwd.h"
+#include "motis/types.h"
+
+namespace prometheus {
+class Counter;
+}  // namespace prometheus
+
+namespace motis {
+
+struct cache_metrics {
+  void hit() const;
+  void miss() const;
+  void eviction() const;
+
+  prometheus::Counter* hits_{nullptr};
+  prometheus::Counter* misses_{nullptr};
+  prometheus::Counter* evictions_{nullptr};
+};
+
+// Registers the counters of the cache `name` (label "cache").
+cache_metrics make_cache_metrics(metrics_registry const&,
+                                 std::string_view name);
+
+// Default weight: every entry counts as one, the budget is an entry count.
+struct unit_weight {
+  template <typename T>
+  std::size_t operator()(T const&) const {
+    return 1U;
+  }
+};
+
+// Thread-safe cache for shared values.
+// Keys are distributed over shards. Lookups only take a shared lock on their
+// shard and mark the entry as recently used with an atomic flag. Eviction
+// uses the CLOCK algorithm (approximate LRU): entries that were used since
+// the clock hand passed them last get a second chance.
+// get_or_compute guarantees that concurrent misses for the same key compute
+// the value only once.
+// `max_size` bounds the sum of `Weight{}(value)` over all entries (e.g. bytes
+// when `Weight` returns the memory footprint of a value).
+template <typename Key, typename Value, typename Weight = unit_weight>
+struct sharded_cache {
+  using value_ptr_t = std::shared_ptr<Value>;
+
+  static constexpr auto const kMaxShards = std::size_t{16U};
+  static constexpr auto const kMinShardSize = std::size_t{8U};
+
+  explicit sharded_cache(std::size_t const max_size,
+                         cache_metrics const metrics = {})
+      : shards_(std::clamp(max_size / kMinShardSize, std::size_t{1U},
+                           kMaxShards)),
+        shard_budget_{
+            std::max(std::size_t{1U},
+                     (max_size + shards_.size() - 1U) / shards_.size())},
+        metrics_{metrics} {}
+
+  sharded_cache(sharded_cache const& o)
+      : shards_(o.shards_.size()),
+        shard_budget_{o.shard_budget_},
+        metrics_{o.metrics_} {
+    copy_entries(o);
+  }
+
+  sharded_cache& operator=(sharded_cache const& o) {
+    if (this != &o) {
+      shards_ = std::vector<shard>(o.shards_.size());
+      shard_budget_ = o.shard_budget_;
+      metrics_ = o.metrics_;
+      copy_entries(o);
+    }
+    return *this;
+  }
+
+  template <typename F>
+  value_ptr_t get_or_compute(Key const& key, F&& compute_fn) {
+    auto& s = get_shard(key);
+    if (auto value = s.find(key); value != nullptr) {
+      metrics_.hit();
+      return value;
+    }
+
+    auto write_lock = std::unique_lock{s.mutex_};
+
+    // check again in case another thread inserted it
+    if (auto const it = s.entries_.find(key); it != end(s.entries_)) {
+      it->second->referenced_.store(true, std::memory_order_relaxed);
+      metrics_.hit();
+      return it->second->value_;
+    }
+
+    metrics_.miss();
+
+    // if another thread is already computing it, wait for it
+    if (auto const it = s.pending_.find(key); it != end(s.pending_)) {
+      auto future = it->second;
+      write_lock.unlock();
+      return future.get();
+    }
+
+    auto promise = std::promise<value_ptr_t>{};
+    s.pending_.emplace(key, promise.get_future().share());
+    write_lock.unlock();
+
+    auto value = value_ptr_t{};
+    try {
+      value = compute_fn();
+    } catch (...) {
+      write_lock.lock();
+      s.pending_.erase(key);
+      promise.set_exception(std::current_exception());
+      throw;
+    }
+
+    write_lock.lock();
+    insert(s, key, value);
+    s.pending_.erase(key);
+    promise.set_value(value);
+    return value;
+  }
+
+  value_ptr_t get(Key const& key) { return get_shard(key).find(key); }
+
+  // Like get, but counts as cache hit or miss.
+  value_ptr_t lookup(Key const& key) {
+    auto value = get_shard(key).find(key);
+    if (value != nullptr) {
+      metrics_.hit();
+    } else {
+      metrics_.miss();
+    }
+    return value;
+  }
+
+  bool contains(Key const& key) {
+    auto& s = get_shard(key);
+    auto const read_lock = std::shared_lock{s.mutex_};
+    return s.entries_.contains(key);
+  }
+
+  template <typename F>
+  void update_if_exists(Key const& key, F&& update_fn) {
+    auto& s = get_shard(key);
+    auto const write_lock = std::unique_lock{s.mutex_};
+    if (auto const it = s.entries_.find(key); it != end(s.entries_)) {
+      set_value(s, *it->second, update_fn(it->second->value_));
+      it->second->referenced_.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  // adds an entry to the cache if there is still space or updates
+  // an existing entry if it already exists
+  template <typename F>
+  bool try_add_or_update(Key const& key, F&& compute_fn) {
+    auto& s = get_shard(key);
+    auto const write_lock = std::unique_lock{s.mutex_};
+    if (auto const it = s.entries_.find(key); it != end(s.entries_)) {
+      set_value(s, *it->second, compute_fn());
+      it->second->referenced_.store(true, std::memory_order_relaxed);
+      return true;
+    }
+    if (s.weight_ >= shard_budget_) {
+      return false;
+    }
+    auto value = value_ptr_t{compute_fn()};
+    if (s.weight_ + weight_of(value) > shard_budget_) {
+      return false;
+    }
+    insert(s, key, std::move(value));
+    return true;
+  }
+
+  // Adds or updates an entry, evicting other entries if necessary.
+  // `compute_fn` is called while holding the write lock of the key's shard.
+  // Nothing is stored if it returns nullptr.
+  template <typename F>
+  void put(Key const& key, F&& compute_fn) {
+    auto& s = get_shard(key);
+    auto const write_lock = std::unique_lock{s.mutex_};
+    if (auto value = value_ptr_t{compute_fn()}; value != nullptr) {
+      insert(s, key, std::move(value));
+    }
+  }
+
+  // Removes all entries for which `pred(key, value)` returns true.
+  // Returns the number of removed entries.
+  template <typename Pred>
+  std::size_t remove_if(Pred&& pred) {
+    auto n = std::size_t{0U};
+    for (auto& s : shards_) {
+      auto const write_lock = std::unique_lock{s.mutex_};
+      for (auto i = std::size_t{0U}; i < s.clock_.size();) {
+        auto const it = s.entries_.find(s.clock_[i]);
+        if (pred(it->first, it->second->value_)) {
+          erase(s, it);  // moves the last entry to position i
+          ++n;
+        } else {
+          ++i;
+        }
+      }
+    }
+    return n;
+  }
+
+  void remove(Key const& key) {
+    auto& s = get_shard(key);
+    auto const write_lock = std::unique_lock{s.mutex_};
+    if (auto const it = s.entries_.find(key); it != end(s.entries_)) {
+      erase(s, it);
+    }
+  }
+
+  std::vector<std::pair<Key, value_ptr_t>> get_all_entries() const {
+    auto entries = std::vector<std::pair<Key, value_ptr_t>>{};
+    for (auto const& s : shards_) {
+      auto const read_lock = std::shared_lock{s.mutex_};
+      for (auto const& [key, e] : s.entries_) {
+        entries.emplace_back(key, e->value_);
+      }
+    }
+    return entries;
+  }
+
+  std::size_t size() const {
+    auto n = std::size_t{0U};
+    for (auto const& s : shards_) {
+      auto const read_lock = std::shared_lock{s.mutex_};
+      n += s.clock_.size();
+    }
+    return n;
+  }
+
+  // sum of the weights of all entries
+  std::size_t weight() const {
+    auto w = std::size_t{0U};
+    for (auto const& s : shards_) {
+      auto const read_lock = std::shared_lock{s.mutex_};
+      w += s.weight_;
+    }
+    return w;
+  }
+
+  // true if no shard has room left for another entry
+  bool full() const {
+    return std::ranges::all_of(shards_, [&](shard const& s) {
+      auto const read_lock = std::shared_lock{s.mutex_};
+      return s.weight_ >= shard_budget_;
+    });
+  }
+
+  bool empty() const { return size() == 0U; }
+
+private:
+  struct entry {
+    value_ptr_t value_;
+    std::size_t weight_;
+    std::size_t clock_pos_;
+    std::atomic_bool referenced_{false};
+  };
+
+  struct shard {
+    value_ptr_t find(Key const& key) const {
+      auto const read_lock = std::shared_lock{mutex_};
+      if (auto const it = entries_.find(key); it != end(entries_)) {
+        it->second->referenced_.store(true, std::memory_order_relaxed);
+        return it->second->value_;
+      }
+      return nullptr;
+    }
+
+    mutable std::shared_mutex mutex_;
+    hash_map<Key, std::unique_ptr<entry>> entries_;
+    std::vector<Key> clock_;
+    std::size_t hand_{0U};
+    std::size_t weight_{0U};
+    hash_map<Key, std::shared_future<value_ptr_t>> pending_;
+  };
+
+  shard& get_shard(Key const& key) {
+    return shards_[cista::hash_all{}(key) % shards_.size()];
+  }
+
+  static std::size_t weight_of(value_ptr_t const& value) {
+    return value == nullptr ? std::size_t{1U}
+                            : std::max(std::size_t{1U}, Weight{}(*value));
+  }
+
+  // requires the write lock of `s`
+  void set_value(shard& s, entry& e, value_ptr_t value) {
+    auto const w = weight_of(value);
+    s.weight_ = s.weight_ - e.weight_ + w;
+    e.value_ = std::move(value);
+    e.weight_ = w;
+  }
+
+  // requires the write lock of `s`
+  void erase(shard& s,
+             typename hash_map<Key, std::unique_ptr<entry>>::iterator it) {
+    auto const pos = it->second->clock_pos_;
+    s.weight_ -= it->second->weight_;
+    s.entries_.erase(it);
+    if (pos != s.clock_.size() - 1U) {
+      s.clock_[pos] = std::move(s.clock_.back());
+      s.entries_.at(s.clock_[pos])->clock_pos_ = pos;
+    }
+    s.clock_.pop_back();
+    if (s.hand_ >= s.clock_.size()) {
+      s.hand_ = 0U;
+    }
+  }
+
+  // requires the write lock of `s`
+  void insert(shard& s, Key const& key, value_ptr_t value) {
+    if (auto const it = s.entries_.find(key); it != end(s.entries_)) {
+      set_value(s, *it->second, std::move(value));
+      return;
+    }
+
+    auto const w = weight_of(value);
+    while (!s.clock_.empty() && s.weight_ + w > shard_budget_) {
+      while (true) {
+        auto& e = *s.entries_.at(s.clock_[s.hand_]);
+        if (!e.referenced_.exchange(false, std::memory_order_relaxed)) {
+          break;
+        }
+        s.hand_ = (s.hand_ + 1U) % s.clock_.size();
+      }
+      erase(s, s.entries_.find(s.clock_[s.hand_]));
+      metrics_.eviction();
+    }
+
+    auto e = std::make_unique<entry>();
+    e->value_ = std::move(value);
+    e->weight_ = w;
+    e->clock_pos_ = s.clock_.size();
+    s.clock_.push_back(key);
+    s.weight_ += w;
+    s.entries_.emplace(key, std::move(e));
+  }
+
+  void copy_entries(sharded_cache const& o) {
+    for (auto i = 0U; i != shards_.size(); ++i) {
+      auto& to = shards_[i];
+      auto const& from = o.shards_[i];
+      auto const read_lock = std::shared_lock{from.mutex_};
+      to.clock_ = from.clock_;
+      to.hand_ = from.hand_;
+      to.weight_ = from.weight_;
+      for (auto const& [key, e] : from.entries_) {
+        auto copy = std::make_unique<entry>();
+        copy->value_ = e->value_;
+        copy->weight_ = e->weight_;
+        copy->clock_pos_ = e->clock_pos_;
+        copy->referenced_.store(e->referenced_.load(std::memory_order_relaxed),
+                                std::memory_order_relaxed);
+        to.entries_.emplace(key, std::move(copy));
+      }
+    }
+  }
+
+  std::vector<shard> shards_;
+  std::size_t shard_budget_;
+  cache_metrics metrics_;
+};
+
+}  // namespace motis
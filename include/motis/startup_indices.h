@@ -0,0 +1,61 @@
+#pragma once
+
+#include <filesystem>
+
+#include "cista/containers/vector.h"
+#include "cista/memory_holder.h"
+#include "cista/mmap.h"
+#include "cista/serialization.h"
+#include "cista/targets/buf.h"
+
+#include "osr/types.h"
+
+#include "motis/fwd.h"
+#include "motis/types.h"
+
+namespace motis {
+
+// Indices derived from the timetable and OSM data that would otherwise be
+// rebuilt on every server start. The import task "indices" writes them next
+// to the data they were derived from.
+
+constexpr auto const kIndicesMode =
+    cista::mode::WITH_INTEGRITY | cista::mode::WITH_STATIC_VERSION;
+
+// Indices consist of cista offset containers only: they need no pointer
+// fix-ups and are used directly from a read-only mapping of the file.
+template <typename T>
+cista::wrapped<T> read_mapped(std::filesystem::path const& p) {
+  auto mem = cista::buf<cista::mmap>{cista::mmap{
+      p.generic_string().c_str(), cista::mmap::protection::READ}};
+  auto const ptr = cista::deserialize<T, kIndicesMode>(mem);
+  return cista::wrapped<T>{cista::memory_holder{std::move(mem)}, ptr};
+}
+
+template <typename T>
+void write_mapped(std::filesystem::path const& p, T const& x) {
+  auto mem = cista::buf<cista::mmap>{cista::mmap{
+      p.generic_string().c_str(), cista::mmap::protection::WRITE}};
+  cista::serialize<kIndicesMode>(mem, x);
+}
+
+std::filesystem::path location_rtree_path(
+    std::filesystem::path const& data_path,
+    std::filesystem::path const& tt_file);
+
+std::filesystem::path elevator_nodes_path(
+    std::filesystem::path const& data_path);
+
+std::filesystem::path railviz_static_path(
+    std::filesystem::path const& data_path);
+
+// The "indices" task records the hashes of all tasks it depends on.
+// The indices can be used if none of these tasks ran again since then.
+bool indices_up_to_date(std::filesystem::path const& data_path, config const&);
+
+void write_elevator_nodes(std::filesystem::path const&,
+                          hash_set<osr::node_idx_t> const&);
+
+hash_set<osr::node_idx_t> read_elevator_nodes(std::filesystem::path const&);
+
+}  // namespace motis
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cinttypes>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "cista/containers/vector.h"
+
+#include "utl/to_vec.h"
+
+#include "geo/box.h"
+#include "geo/latlng.h"
+
+#include "motis/point_rtree.h"
+
+namespace motis {
+
+// Immutable spatial index for points with the query API of `point_rtree`.
+// Points are sorted along a Hilbert curve and stored as a flat array
+// (structure of arrays). Every `kNodeSize` consecutive points form a leaf
+// with a bounding box, every `kNodeSize` consecutive leaves form an upper
+// node with a bounding box. Queries scan the upper boxes, the boxes of
+// overlapping leaves and finally the points of overlapping leaves with a
+// branch-free (auto-vectorizable) bounding box filter.
+// Consists only of cista offset vectors: a serialized tree can be mapped
+// read-only (see `read_mapped`).
+template <typename T>
+struct static_point_rtree {
+  static constexpr auto const kNodeSize = 64U;
+
+  struct box {
+    bool overlaps(box const& o) const {
+      return min_lat_ <= o.max_lat_ && o.min_lat_ <= max_lat_ &&
+             min_lng_ <= o.max_lng_ && o.min_lng_ <= max_lng_;
+    }
+
+    void extend(box const& o) {
+      min_lat_ = std::min(min_lat_, o.min_lat_);
+      min_lng_ = std::min(min_lng_, o.min_lng_);
+      max_lat_ = std::max(max_lat_, o.max_lat_);
+      max_lng_ = std::max(max_lng_, o.max_lng_);
+    }
+
+    double min_lat_{std::numeric_limits<double>::max()};
+    double min_lng_{std::numeric_limits<double>::max()};
+    double max_lat_{std::numeric_limits<double>::lowest()};
+    double max_lng_{std::numeric_limits<double>::lowest()};
+  };
+
+  static static_point_rtree build(
+      std::vector<std::pair<geo::latlng, T>> entries) {
+    auto bounds = box{};
+    for (auto const& [pos, _] : entries) {
+      bounds.extend(box{pos.lat(), pos.lng(), pos.lat(), pos.lng()});
+    }
+
+    auto const lat_range = std::max(bounds.max_lat_ - bounds.min_lat_, 1E-9);
+    auto const lng_range = std::max(bounds.max_lng_ - bounds.min_lng_, 1E-9);
+    auto const hilbert_idx = [&](geo::latlng const& pos) {
+      constexpr auto const kMax = static_cast<double>((1U << 16U) - 1U);
+      return hilbert_xy_to_d(
+          static_cast<std::uint32_t>((pos.lng() - bounds.min_lng_) /
+                                     lng_range * kMax),
+          static_cast<std::uint32_t>((pos.lat() - bounds.min_lat_) /
+                                     lat_range * kMax));
+    };
+
+    auto sorted = utl::to_vec(entries, [&](auto const& e) {
+      return std::pair{hilbert_idx(e.first), e};
+    });
+    std::ranges::sort(sorted, [](auto const& a, auto const& b) {
+      return a.first < b.first;
+    });
+
+    auto t = static_point_rtree{};
+    t.lat_.reserve(sorted.size());
+    t.lng_.reserve(sorted.size());
+    t.items_.reserve(sorted.size());
+    for (auto const& [_, e] : sorted) {
+      t.lat_.push_back(e.first.lat());
+      t.lng_.push_back(e.first.lng());
+      t.items_.push_back(e.second);
+    }
+
+    auto const n_leaves = (t.size() + kNodeSize - 1U) / kNodeSize;
+    for (auto i = std::size_t{0U}; i != n_leaves; ++i) {
+      auto b = box{};
+      auto const to = std::min((i + 1U) * kNodeSize, t.size());
+      for (auto j = i * kNodeSize; j != to; ++j) {
+        b.extend(box{t.lat_[j], t.lng_[j], t.lat_[j], t.lng_[j]});
+      }
+      t.leaf_boxes_.push_back(b);
+    }
+
+    auto const n_upper = (n_leaves + kNodeSize - 1U) / kNodeSize;
+    for (auto i = std::size_t{0U}; i != n_upper; ++i) {
+      auto b = box{};
+      auto const to = std::min((i + 1U) * kNodeSize, n_leaves);
+      for (auto j = i * kNodeSize; j != to; ++j) {
+        b.extend(t.leaf_boxes_[j]);
+      }
+      t.upper_boxes_.push_back(b);
+    }
+
+    return t;
+  }
+
+  std::vector<T> in_radius(geo::latlng const& x, double distance) const {
+    auto ret = std::vector<T>{};
+    in_radius(x, distance, [&](auto&& item) { ret.emplace_back(item); });
+    return ret;
+  }
+
+  template <typename Fn>
+  void in_radius(geo::latlng const& x, double distance, Fn&& fn) const {
+    find(geo::box{x, distance}, [&](geo::latlng const& pos, T const item) {
+      if (geo::distance(x, pos) < distance) {
+        fn(item);
+      }
+    });
+  }
+
+  template <typename Fn>
+  void find(geo::box const& b, Fn&& fn) const {
+    auto const q =
+        box{b.min_.lat(), b.min_.lng(), b.max_.lat(), b.max_.lng()};
+    auto in_box = std::array<std::uint8_t, kNodeSize>{};
+    auto const n_leaves = static_cast<std::size_t>(leaf_boxes_.size());
+    for (auto u = std::size_t{0U}; u != upper_boxes_.size(); ++u) {
+      if (!upper_boxes_[u].overlaps(q)) {
+        continue;
+      }
+
+      auto const leaves_to = std::min((u + 1U) * kNodeSize, n_leaves);
+      for (auto l = u * kNodeSize; l != leaves_to; ++l) {
+        if (!leaf_boxes_[l].overlaps(q)) {
+          continue;
+        }
+
+        auto const from = l * kNodeSize;
+        auto const n = std::min(from + kNodeSize, size()) - from;
+        auto const* lat = &lat_[from];
+        auto const* lng = &lng_[from];
+        for (auto i = std::size_t{0U}; i != n; ++i) {
+          in_box[i] = static_cast<std::uint8_t>(
+              (lat[i] >= q.min_lat_) & (lat[i] <= q.max_lat_) &
+              (lng[i] >= q.min_lng_) & (lng[i] <= q.max_lng_));
+        }
+
+        for (auto i = std::size_t{0U}; i != n; ++i) {
+          if (in_box[i] == 0U) {
+            continue;
+          }
+          if constexpr (RtreePosHandler<T, Fn>) {
+            fn(geo::latlng{lat[i], lng[i]}, items_[from + i]);
+          } else {
+            fn(items_[from + i]);
+          }
+        }
+      }
+    }
+  }
+
+  std::size_t size() const { return items_.size(); }
+
+  cista::offset::vector<double> lat_;
+  cista::offset::vector<double> lng_;
+  cista::offset::vector<T> items_;
+  cista::offset::vector<box> leaf_boxes_;
+  cista::offset::vector<box> upper_boxes_;
+
+private:
+  static std::uint32_t hilbert_xy_to_d(std::uint32_t x, std::uint32_t y) {
+    constexpr auto const kN = std::uint32_t{1U} << 16U;
+    auto d = std::uint32_t{0U};
+    for (auto s = kN / 2U; s > 0U; s /= 2U) {
+      auto const rx = static_cast<std::uint32_t>((x & s) > 0U);
+      auto const ry = static_cast<std::uint32_t>((y & s) > 0U);
+      d += s * s * ((3U * rx) ^ ry);
+      if (ry == 0U) {
+        if (rx == 1U) {
+          x = kN - 1U - x;
+          y = kN - 1U - y;
+        }
+        std::swap(x, y);
+      }
+    }
+    return d;
+  }
+};
+
+}  // namespace motis
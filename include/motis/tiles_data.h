@@ -1,23 +1,78 @@
 #pragma once
 
+#include <cinttypes>
+#include <memory>
 #include <string>
 
+#include "boost/asio/io_context.hpp"
+
+#include "cista/hashing.h"
+
+#include "geo/box.h"
+#include "geo/tile.h"
+
 #include "tiles/db/tile_database.h"
 #include "tiles/get_tile.h"
 
+#include "motis/fwd.h"
+#include "motis/sharded_cache.h"
+
 namespace motis {
 
+// Low zoom tiles cover large areas: they are expensive to render and
+// requested by every client. They have their own cache budget, so high zoom
+// traffic does not evict them.
+constexpr auto const kTilesLowZoomMax = 10U;
+
+struct rendered_tile {
+  std::string body_;  // deflated, empty if there is no data
+  std::string etag_;
+};
+
+struct rendered_tile_size {
+  std::size_t operator()(rendered_tile const& t) const {
+    return sizeof(rendered_tile) + t.body_.size() + t.etag_.size();
+  }
+};
+
+struct tile_key {
+  bool operator==(tile_key const&) const = default;
+  cista::hash_t hash() const noexcept { return cista::build_hash(x_, y_, z_); }
+
+  std::uint32_t x_, y_, z_;
+};
+
+// Bounding box from the OSM file header (or of the timetable stops if the
+// header has none or the OSM file is not available).
+geo::box tiles_prewarm_area(data const&);
+
 struct tiles_data {
-  tiles_data(std::string const& path, std::size_t const db_size)
-      : db_env_{::tiles::make_tile_database(path.c_str(), db_size)},
-        db_handle_{db_env_},
-        render_ctx_{::tiles::make_render_ctx(db_handle_)},
-        pack_handle_{path.c_str()} {}
+  using cache_t = sharded_cache<tile_key, rendered_tile, rendered_tile_size>;
+
+  // Cache sizes are in bytes.
+  tiles_data(std::string const& path,
+             std::size_t db_size,
+             std::size_t cache_size,
+             std::size_t low_zoom_cache_size,
+             metrics_registry const* metrics = nullptr);
+
+  std::shared_ptr<rendered_tile> get_tile(geo::tile const&);
+
+  // Renders the non-empty tiles covering `area` up to `max_zoom` (at most
+  // kTilesLowZoomMax) into the cache, lowest zoom level first, until the low
+  // zoom cache is full. Each tile row is a separate task on `ioc`.
+  void prewarm(boost::asio::io_context& ioc,
+               geo::box const& area,
+               unsigned max_zoom);
 
   lmdb::env db_env_;
   ::tiles::tile_db_handle db_handle_;
   ::tiles::render_ctx render_ctx_;
   ::tiles::pack_handle pack_handle_;
+
+  metrics_registry const* metrics_;
+  cache_t low_zoom_cache_;
+  cache_t high_zoom_cache_;
 };
 
-}  // namespace motis
\ No newline at end of file
+}  // namespace motis
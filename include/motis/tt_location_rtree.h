@@ -1,20 +1,24 @@
 #pragma once
 
+#include <utility>
+#include <vector>
+
 #include "nigiri/special_stations.h"
 #include "nigiri/timetable.h"
 
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 
 namespace motis {
 
-inline point_rtree<nigiri::location_idx_t> create_location_rtree(
+inline static_point_rtree<nigiri::location_idx_t> create_location_rtree(
     nigiri::timetable const& tt) {
-  auto t = point_rtree<nigiri::location_idx_t>{};
+  auto entries = std::vector<std::pair<geo::latlng, nigiri::location_idx_t>>{};
+  entries.reserve(tt.n_locations());
   for (auto i = nigiri::location_idx_t{nigiri::kNSpecialStations};
        i != tt.n_locations(); ++i) {
-    t.add(tt.locations_.coordinates_[i], i);
+    entries.emplace_back(tt.locations_.coordinates_[i], i);
   }
-  return t;
+  return static_point_rtree<nigiri::location_idx_t>::build(std::move(entries));
 }
 
 }  // namespace motis
\ No newline at end of file
@@ -11,6 +11,7 @@
 #include "motis/compute_footpaths.h"
 #include "motis/data.h"
 #include "motis/elevators/elevators.h"
+#include "motis/elevators/get_state_changes.h"
 #include "motis/fwd.h"
 #include "motis/match_platforms.h"
 #include "motis/osr/parameters.h"
@@ -20,6 +21,9 @@ namespace motis {
 using nodes_t = std::vector<osr::node_idx_t>;
 using states_t = std::vector<bool>;
 
+std::vector<state_change<nigiri::unixtime_t>> get_node_state_changes(
+    osr::ways const&, elevators const&, osr::node_idx_t);
+
 osr::bitvec<osr::node_idx_t>& set_blocked(nodes_t const&,
                                           states_t const&,
                                           osr::bitvec<osr::node_idx_t>&);
@@ -30,7 +34,7 @@ std::vector<nigiri::td_footpath> get_td_footpaths(
     osr::platforms const&,
     nigiri::timetable const&,
     nigiri::rt_timetable const*,
-    point_rtree<nigiri::location_idx_t> const&,
+    static_point_rtree<nigiri::location_idx_t> const&,
     elevators const&,
     platform_matches_t const&,
     nigiri::location_idx_t start_l,
@@ -53,11 +57,12 @@ void update_rtt_td_footpaths(
     osr::lookup const&,
     osr::platforms const&,
     nigiri::timetable const&,
-    point_rtree<nigiri::location_idx_t> const&,
+    static_point_rtree<nigiri::location_idx_t> const&,
     elevators const&,
     platform_matches_t const&,
     hash_set<std::pair<nigiri::location_idx_t, osr::direction>> const& tasks,
     nigiri::rt_timetable const* old_rtt,
+    bool rtt_is_copy,  // rtt was copied from old_rtt
     nigiri::rt_timetable&,
     std::chrono::seconds max);
 
@@ -65,7 +70,7 @@ void update_rtt_td_footpaths(osr::ways const&,
                              osr::lookup const&,
                              osr::platforms const&,
                              nigiri::timetable const&,
-                             point_rtree<nigiri::location_idx_t> const&,
+                             static_point_rtree<nigiri::location_idx_t> const&,
                              elevators const&,
                              elevator_footpath_map_t const&,
                              platform_matches_t const&,
@@ -1,40 +1,89 @@
 #include "motis/clog_redirect.h"
 
+#include <algorithm>
 #include <iostream>
 #include <mutex>
+#include <utility>
+#include <vector>
 
 namespace motis {
 
 namespace {
 
-struct synchronized_streambuf : std::streambuf {
-  synchronized_streambuf(std::streambuf* wrapped, std::mutex& mutex)
-      : wrapped_{wrapped}, mutex_{mutex} {}
-
+// Import tasks may run concurrently, each with its own log file.
+// std::clog is redirected once to this stream buffer which forwards writes
+// of a task's thread to the log file of this task. Writes from other threads
+// (e.g. worker threads spawned by a task) go to the only active log file or,
+// if multiple tasks are running, to the original std::clog buffer.
+struct dispatching_streambuf : std::streambuf {
   int_type overflow(int_type ch) override {
     auto const lock = std::lock_guard{mutex_};
+    auto* target = get_target();
     if (traits_type::eq_int_type(ch, traits_type::eof())) {
-      return wrapped_->pubsync() == 0 ? traits_type::not_eof(ch)
-                                      : traits_type::eof();
+      return target->pubsync() == 0 ? traits_type::not_eof(ch)
+                                    : traits_type::eof();
     }
-    return wrapped_->sputc(traits_type::to_char_type(ch));
+    return target->sputc(traits_type::to_char_type(ch));
   }
 
   std::streamsize xsputn(char const* s, std::streamsize count) override {
     auto const lock = std::lock_guard{mutex_};
-    return wrapped_->sputn(s, count);
+    return get_target()->sputn(s, count);
   }
 
   int sync() override {
     auto const lock = std::lock_guard{mutex_};
-    return wrapped_->pubsync();
+    return get_target()->pubsync();
+  }
+
+  void add(clog_redirect const* r, std::streambuf* sink) {
+    auto const lock = std::lock_guard{mutex_};
+    if (sinks_.empty()) {
+      original_ = std::clog.rdbuf(this);
+    }
+    sinks_.emplace_back(r, sink);
+    thread_sink_ = sink;
+  }
+
+  void remove(clog_redirect const* r) {
+    auto const lock = std::lock_guard{mutex_};
+    auto const it = std::ranges::find(sinks_, r, &entry_t::first);
+    if (it == end(sinks_)) {
+      return;
+    }
+    it->second->pubsync();
+    if (thread_sink_ == it->second) {
+      thread_sink_ = nullptr;
+    }
+    sinks_.erase(it);
+    if (sinks_.empty()) {
+      std::clog.rdbuf(std::exchange(original_, nullptr));
+    }
   }
 
 private:
-  std::streambuf* wrapped_;
-  std::mutex& mutex_;
+  using entry_t = std::pair<clog_redirect const*, std::streambuf*>;
+
+  std::streambuf* get_target() const {
+    if (thread_sink_ != nullptr) {
+      return thread_sink_;
+    }
+    return sinks_.size() == 1U ? sinks_.front().second : original_;
+  }
+
+  std::mutex mutex_;
+  std::vector<entry_t> sinks_;
+  std::streambuf* original_{};
+  static thread_local std::streambuf* thread_sink_;
 };
 
+thread_local std::streambuf* dispatching_streambuf::thread_sink_ = nullptr;
+
+dispatching_streambuf& get_dispatcher() {
+  static auto dispatcher = dispatching_streambuf{};
+  return dispatcher;
+}
+
 }  // namespace
 
 clog_redirect::clog_redirect(char const* log_file_path) {
@@ -44,10 +93,7 @@ clog_redirect::clog_redirect(char const* log_file_path) {
 
   sink_.exceptions(std::ios_base::badbit | std::ios_base::failbit);
   sink_.open(log_file_path, std::ios_base::app);
-  sink_buf_ = std::make_unique<synchronized_streambuf>(sink_.rdbuf(), mutex_);
-
-  backup_clog_ = std::clog.rdbuf();
-  std::clog.rdbuf(sink_buf_.get());
+  get_dispatcher().add(this, sink_.rdbuf());
   active_ = true;
 }
 
@@ -55,9 +101,7 @@ clog_redirect::~clog_redirect() {
   if (!active_) {
     return;
   }
-
-  auto const lock = std::lock_guard{mutex_};
-  std::clog.rdbuf(backup_clog_);
+  get_dispatcher().remove(this);
 }
 
 void clog_redirect::set_enabled(bool const enabled) { enabled_ = enabled; }
@@ -65,4 +109,4 @@ void clog_redirect::set_enabled(bool const enabled) { enabled_ = enabled; }
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
 bool clog_redirect::enabled_ = true;
 
-}  // namespace motis
\ No newline at end of file
+}  // namespace motis
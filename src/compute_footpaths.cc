@@ -1,14 +1,32 @@
 #include "motis/compute_footpaths.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <ranges>
+#include <span>
+
+#include "fmt/format.h"
+
 #include "nigiri/loader/build_lb_graph.h"
 
 #include "cista/mmap.h"
 #include "cista/serialization.h"
 
 #include "utl/concat.h"
+#include "utl/enumerate.h"
 #include "utl/erase_if.h"
 #include "utl/parallel_for.h"
+#include "utl/read_file.h"
 #include "utl/sorted_diff.h"
+#include "utl/to_vec.h"
+#include "utl/verify.h"
+#include "utl/zip.h"
 
 #include "osr/routing/profiles/foot.h"
 #include "osr/routing/route.h"
@@ -20,12 +38,95 @@
 #include "motis/match_platforms.h"
 #include "motis/osr/max_distance.h"
 #include "motis/osr/parameters.h"
-#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
 
 namespace n = nigiri;
 
 namespace motis {
 
+namespace {
+
+// Locations are routed in partitions of consecutive locations along the
+// Hilbert curve of the location r-tree. Neighboring locations explore
+// almost the same part of the street network, so the worker processing a
+// partition keeps the relevant osr pages in its caches.
+constexpr auto const kPartitionSize = 256U;
+
+// Result of one (profile, partition) work item.
+struct footpath_checkpoint {
+  n::vecvec<std::uint32_t, n::footpath> transfers_;
+  cista::raw::vector<elevator_footpath> elevators_;
+};
+
+struct profile_stats {
+  std::atomic_size_t n_routed_{0U};
+  std::atomic_size_t n_resumed_{0U};
+  std::atomic_uint64_t route_ns_{0U};
+};
+
+std::filesystem::path checkpoint_file(footpath_checkpoints const& c,
+                                      routed_transfers_settings const& mode,
+                                      std::size_t const partition) {
+  return c.dir_ / fmt::format("{}_{}.bin",
+                              static_cast<unsigned>(mode.profile_idx_),
+                              partition);
+}
+
+void prepare_checkpoints(footpath_checkpoints const& c) {
+  auto const key_file = c.dir_ / "key";
+  auto const key = fmt::to_string(c.key_);
+  if (std::filesystem::is_directory(c.dir_) &&
+      (!std::filesystem::is_regular_file(key_file) ||
+       utl::read_file(key_file.generic_string().c_str()) != key)) {
+    fmt::println(std::clog, "  -> discarding outdated checkpoints in {}",
+                 c.dir_.generic_string());
+    std::filesystem::remove_all(c.dir_);
+  }
+  std::filesystem::create_directories(c.dir_);
+  std::ofstream{key_file} << key;
+}
+
+// Sorts the per-thread buffers in parallel and merges them pairwise.
+elevator_footpath_map_t merge_elevator_footpaths(
+    std::deque<std::vector<elevator_footpath>>& buffers) {
+  auto all = std::vector<elevator_footpath>{};
+  auto bounds = std::vector<std::size_t>{0U};
+  all.reserve(std::accumulate(
+      begin(buffers), end(buffers), std::size_t{0U},
+      [](std::size_t const sum, auto const& b) { return sum + b.size(); }));
+  for (auto& b : buffers) {
+    utl::concat(all, b);
+    bounds.push_back(all.size());
+    b = {};
+  }
+
+  auto const n_runs = buffers.size();
+  auto const run = [&](std::size_t const i) {
+    return begin(all) +
+           static_cast<std::ptrdiff_t>(bounds[std::min(i, n_runs)]);
+  };
+  utl::parallel_for_run(n_runs, [&](std::size_t const i) {
+    std::sort(run(i), run(i + 1U));
+  });
+  for (auto width = std::size_t{1U}; width < n_runs; width *= 2U) {
+    utl::parallel_for_run(
+        (n_runs + 2U * width - 1U) / (2U * width), [&](std::size_t const j) {
+          auto const lo = j * 2U * width;
+          std::inplace_merge(run(lo), run(lo + width), run(lo + 2U * width));
+        });
+  }
+  all.erase(std::unique(begin(all), end(all)), end(all));
+
+  auto ret = elevator_footpath_map_t{};
+  ret.reserve(all.size());
+  for (auto const& x : all) {
+    ret.emplace_back(x);
+  }
+  return ret;
+}
+
+}  // namespace
+
 elevator_footpath_map_t compute_footpaths(
     osr::ways const& w,
     osr::lookup const& lookup,
@@ -33,13 +134,15 @@ elevator_footpath_map_t compute_footpaths(
     nigiri::timetable& tt,
     osr::elevation_storage const* elevations,
     bool const update_coordinates,
-    std::vector<routed_transfers_settings> const& settings) {
+    std::vector<routed_transfers_settings> const& settings,
+    std::optional<footpath_checkpoints> const& checkpoints) {
   fmt::println(std::clog, "creating matches");
   auto const matches = get_matches(tt, pl, w);
 
   fmt::println(std::clog, "  -> creating r-tree");
   auto const loc_rtree = [&]() {
-    auto t = point_rtree<n::location_idx_t>{};
+    auto entries = std::vector<std::pair<geo::latlng, n::location_idx_t>>{};
+    entries.reserve(tt.n_locations());
     for (auto i = n::location_idx_t{0U}; i != tt.n_locations(); ++i) {
       if (update_coordinates && matches[i] != osr::platform_idx_t::invalid()) {
         auto const center = get_platform_center(pl, w, matches[i]);
@@ -49,183 +152,301 @@ elevator_footpath_map_t compute_footpaths(
           tt.locations_.coordinates_[i] = *center;
         }
       }
-      t.add(tt.locations_.coordinates_[i], i);
+      entries.emplace_back(tt.locations_.coordinates_[i], i);
     }
-    return t;
+    return static_point_rtree<n::location_idx_t>::build(std::move(entries));
   }();
 
+  // The r-tree stores its items in Hilbert order.
+  auto const& hilbert_order = loc_rtree.items_;
+  auto const n_locations = loc_rtree.size();
+  auto const n_partitions =
+      (n_locations + kPartitionSize - 1U) / kPartitionSize;
+  auto const get_partition = [&](std::size_t const p) {
+    auto const from = p * kPartitionSize;
+    auto const to = std::min(from + kPartitionSize, n_locations);
+    return std::span{hilbert_order.data() + from, to - from};
+  };
+
+  if (checkpoints.has_value()) {
+    prepare_checkpoints(*checkpoints);
+  }
+  auto const is_checkpointed = [&](routed_transfers_settings const& mode,
+                                   std::size_t const p) {
+    return checkpoints.has_value() &&
+           std::filesystem::is_regular_file(
+               checkpoint_file(*checkpoints, mode, p));
+  };
+
   auto const pt = utl::get_active_progress_tracker();
   pt->in_high(2U * tt.n_locations() * settings.size());
+  auto n_done = std::atomic_size_t{0U};
+  auto const add_done = [&](std::size_t const n) {
+    pt->update_monotonic(n_done.fetch_add(n) + n);
+  };
 
-  auto elevator_in_paths_mutex = std::mutex{};
-  auto elevator_in_paths = elevator_footpath_map_t{};
-  auto const add_if_elevator = [&](osr::node_idx_t const n,
-                                   n::location_idx_t const a,
-                                   n::location_idx_t const b) {
-    if (n != osr::node_idx_t::invalid() &&
-        w.r_->node_properties_[n].is_elevator()) {
-      auto l = std::unique_lock{elevator_in_paths_mutex};
-      elevator_in_paths[n].emplace(a, b);
-    }
+  // Every worker thread collects elevator footpaths into its own buffer.
+  // Buffers are registered once per thread and merged at the end.
+  auto thread_elevators_mutex = std::mutex{};
+  auto thread_elevators = std::deque<std::vector<elevator_footpath>>{};
+
+  // All profiles are matched and routed in the same parallel loops: they
+  // write to separate results and only read the timetable and osr data.
+  auto candidates =
+      utl::to_vec(settings, [&](routed_transfers_settings const&) {
+        return vector_map<n::location_idx_t, osr::match_t>{};
+      });
+  auto transfers = utl::to_vec(settings, [&](routed_transfers_settings const&) {
+    return n::vector_map<n::location_idx_t, std::vector<n::footpath>>(
+        tt.n_locations());
+  });
+  auto stats = std::vector<profile_stats>(settings.size());
+
+  auto const is_candidate = [&](routed_transfers_settings const& mode,
+                                n::location_idx_t const l) {
+    return !mode.is_candidate_ || mode.is_candidate_(l);
   };
 
+  {
+    auto const timer = utl::scoped_timer{"matching timetable locations"};
+
+    // Profiles whose partitions are all checkpointed need no matching.
+    auto resumed = std::vector<bool>(settings.size());
+    for (auto i = 0U; i != settings.size(); ++i) {
+      resumed[i] = std::ranges::all_of(
+          std::views::iota(std::size_t{0U}, n_partitions),
+          [&](std::size_t const p) { return is_checkpointed(settings[i], p); });
+      if (!resumed[i]) {
+        candidates[i].resize(tt.n_locations());
+      }
+    }
+
+    utl::parallel_for_run(
+        settings.size() * tt.n_locations(), [&](std::size_t const x) {
+          add_done(1U);
+
+          auto const& mode = settings[x / tt.n_locations()];
+          auto const l = n::location_idx_t{
+              static_cast<n::location_idx_t::value_t>(x % tt.n_locations())};
+          if (resumed[x / tt.n_locations()] || !is_candidate(mode, l)) {
+            return;
+          }
+          candidates[x / tt.n_locations()][l] = lookup.match(
+              to_profile_parameters(mode.profile_, {}),
+              get_loc(tt, w, pl, matches, l), false, osr::direction::kForward,
+              mode.max_matching_distance_, nullptr, mode.profile_);
+        });
+  }
+
   struct state {
     std::vector<n::footpath> sorted_tt_fps_;
     std::vector<n::footpath> missing_;
     std::vector<n::location_idx_t> neighbors_;
     std::vector<osr::location> neighbors_loc_;
     std::vector<osr::match_t> neighbor_candidates_;
+    std::vector<elevator_footpath> elevators_;
+    std::vector<elevator_footpath>* thread_elevators_{nullptr};
   };
 
-  auto n_done = 0U;
-  auto candidates = vector_map<n::location_idx_t, osr::match_t>{};
-  auto transfers = n::vector_map<n::location_idx_t, std::vector<n::footpath>>(
-      tt.n_locations());
-  for (auto const& mode : settings) {
-    candidates.clear();
-    candidates.resize(tt.n_locations());
-    for (auto& fps : transfers) {
-      fps.clear();
+  auto const route = [&](state& s, std::size_t const mode_idx,
+                         n::location_idx_t const l) {
+    s.sorted_tt_fps_.clear();
+    s.missing_.clear();
+    s.neighbors_.clear();
+    s.neighbors_loc_.clear();
+    s.neighbor_candidates_.clear();
+    s.elevators_.clear();
+
+    auto const& mode = settings[mode_idx];
+    auto const& c = candidates[mode_idx];
+    auto& fps = transfers[mode_idx][l];
+    if (!is_candidate(mode, l)) {
+      return;
     }
 
-    auto const is_candidate = [&](n::location_idx_t const l) {
-      return !mode.is_candidate_ || mode.is_candidate_(l);
-    };
+    auto const start = std::chrono::steady_clock::now();
+    loc_rtree.in_radius(
+        tt.locations_.coordinates_[l],
+        get_max_distance(mode.profile_, osr_parameters{}, mode.max_duration_),
+        [&](n::location_idx_t const x) {
+          if (x != l && is_candidate(mode, x)) {
+            s.neighbors_.emplace_back(x);
+          }
+        });
 
-    {
-      auto const timer = utl::scoped_timer{
-          fmt::format("matching timetable locations for profile={}",
-                      to_str(mode.profile_))};
+    auto const results = osr::route(
+        to_profile_parameters(mode.profile_, {}), w, lookup, mode.profile_,
+        get_loc(tt, w, pl, matches, l),
+        utl::transform_to(s.neighbors_, s.neighbors_loc_,
+                          [&](n::location_idx_t const x) {
+                            return get_loc(tt, w, pl, matches, x);
+                          }),
+        c[l],
+        utl::transform_to(s.neighbors_, s.neighbor_candidates_,
+                          [&](n::location_idx_t const x) { return c[x]; }),
+        static_cast<osr::cost_t>(mode.max_duration_.count()),
+        osr::direction::kForward, nullptr, nullptr, elevations,
+        [](osr::path const& p) { return p.uses_elevator_; });
+
+    for (auto const [n, r] : utl::zip(s.neighbors_, results)) {
+      if (!r.has_value()) {
+        continue;
+      }
 
-      utl::parallel_for_run(tt.n_locations(), [&](std::size_t const x) {
-        pt->update_monotonic(n_done + x);
+      auto const duration =
+          n::duration_t{static_cast<unsigned>(std::ceil(r->cost_ / 60.0))};
+      fps.emplace_back(n::footpath{n, duration});
 
-        auto const l =
-            n::location_idx_t{static_cast<n::location_idx_t::value_t>(x)};
-        if (!is_candidate(l)) {
-          return;
+      if (mode.profile_ == osr::search_profile::kWheelchair) {
+        for (auto const& seg : r->segments_) {
+          if (seg.from_ != osr::node_idx_t::invalid() &&
+              w.r_->node_properties_[seg.from_].is_elevator()) {
+            s.elevators_.push_back({seg.from_, l, n});
+            s.elevators_.push_back({seg.from_, n, l});
+          }
         }
-        candidates[l] = lookup.match(
-            to_profile_parameters(mode.profile_, {}),
-            get_loc(tt, w, pl, matches, l), false, osr::direction::kForward,
-            mode.max_matching_distance_, nullptr, mode.profile_);
-      });
+      }
+    }
 
-      n_done += tt.n_locations();
+    if (mode.extend_missing_) {
+      auto const& tt_fps = tt.locations_.footpaths_out_[0].at(l);
+      s.sorted_tt_fps_.resize(tt_fps.size());
+      std::copy(begin(tt_fps), end(tt_fps), begin(s.sorted_tt_fps_));
+      utl::sort(s.sorted_tt_fps_);
+      utl::sort(fps);
+
+      utl::sorted_diff(
+          s.sorted_tt_fps_, fps,
+          [](auto&& a, auto&& b) { return a.target() < b.target(); },
+          [](auto&& a, auto&& b) { return a.target() == b.target(); },
+          utl::overloaded{
+              [](n::footpath, n::footpath) { assert(false); },
+              [&](utl::op const op, n::footpath const x) {
+                if (op == utl::op::kDel) {
+                  auto const dist =
+                      geo::distance(tt.locations_.coordinates_[l],
+                                    tt.locations_.coordinates_[x.target()]);
+                  if (dist < 100.0) {
+                    auto const duration = n::duration_t{
+                        static_cast<int>(std::ceil((dist / 0.7) / 60.0))};
+                    s.missing_.emplace_back(x.target(), duration);
+                  }
+                }
+              }});
+
+      utl::concat(fps, s.missing_);
     }
 
-    utl::parallel_for_run_threadlocal<state>(
-        tt.n_locations(), [&](state& s, auto const i) {
-          cista::for_each_field(s, [](auto& f) { f.clear(); });
+    utl::erase_if(fps, [&](n::footpath fp) {
+      return fp.duration() > mode.max_duration_;
+    });
+    utl::sort(fps);
 
-          auto const l = n::location_idx_t{i};
-          if (!is_candidate(l)) {
-            pt->update_monotonic(n_done + i);
-            return;
+    stats[mode_idx].n_routed_ += 1U;
+    stats[mode_idx].route_ns_ += static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start)
+            .count());
+  };
+
+  {
+    auto const timer = utl::scoped_timer{"routing footpaths"};
+    utl::parallel_for_run_threadlocal<state>(
+        settings.size() * n_partitions, [&](state& s, std::size_t const x) {
+          auto const mode_idx = x / n_partitions;
+          auto const p = x % n_partitions;
+          auto const& mode = settings[mode_idx];
+          auto const partition = get_partition(p);
+          if (s.thread_elevators_ == nullptr) {
+            auto const lock = std::unique_lock{thread_elevators_mutex};
+            s.thread_elevators_ = &thread_elevators.emplace_back();
           }
 
-          loc_rtree.in_radius(tt.locations_.coordinates_[l],
-                              get_max_distance(mode.profile_, osr_parameters{},
-                                               mode.max_duration_),
-                              [&](n::location_idx_t const x) {
-                                if (x != l && is_candidate(x)) {
-                                  s.neighbors_.emplace_back(x);
-                                }
-                              });
-
-          auto const results = osr::route(
-              to_profile_parameters(mode.profile_, {}), w, lookup,
-              mode.profile_, get_loc(tt, w, pl, matches, l),
-              utl::transform_to(s.neighbors_, s.neighbors_loc_,
-                                [&](n::location_idx_t const x) {
-                                  return get_loc(tt, w, pl, matches, x);
-                                }),
-              candidates[l],
-              utl::transform_to(
-                  s.neighbors_, s.neighbor_candidates_,
-                  [&](n::location_idx_t const x) { return candidates[x]; }),
-              static_cast<osr::cost_t>(mode.max_duration_.count()),
-              osr::direction::kForward, nullptr, nullptr, elevations,
-              [](osr::path const& p) { return p.uses_elevator_; });
-
-          for (auto const [n, r] : utl::zip(s.neighbors_, results)) {
-            if (!r.has_value()) {
-              continue;
+          if (is_checkpointed(mode, p)) {
+            auto const ck = cista::read<footpath_checkpoint>(
+                checkpoint_file(*checkpoints, mode, p));
+            utl::verify(
+                ck->transfers_.size() == partition.size(),
+                "footpath checkpoint {} does not match partition",
+                checkpoint_file(*checkpoints, mode, p).generic_string());
+            for (auto const [l, fps] : utl::zip(partition, ck->transfers_)) {
+              transfers[mode_idx][l] = {fps.begin(), fps.end()};
             }
+            s.thread_elevators_->insert(end(*s.thread_elevators_),
+                                        ck->elevators_.begin(),
+                                        ck->elevators_.end());
+            stats[mode_idx].n_resumed_ += partition.size();
+            add_done(partition.size());
+            return;
+          }
 
-            auto const duration = n::duration_t{
-                static_cast<unsigned>(std::ceil(r->cost_ / 60.0))};
-            transfers[l].emplace_back(n::footpath{n, duration});
-
-            if (mode.profile_ == osr::search_profile::kWheelchair) {
-              for (auto const& seg : r->segments_) {
-                add_if_elevator(seg.from_, l, n);
-                add_if_elevator(seg.from_, n, l);
-              }
-            }
+          auto const elevators_from = s.thread_elevators_->size();
+          for (auto const l : partition) {
+            route(s, mode_idx, l);
+            utl::concat(*s.thread_elevators_, s.elevators_);
           }
+          add_done(partition.size());
 
-          if (mode.extend_missing_) {
-            auto const& tt_fps = tt.locations_.footpaths_out_[0].at(l);
-            s.sorted_tt_fps_.resize(tt_fps.size());
-            std::copy(begin(tt_fps), end(tt_fps), begin(s.sorted_tt_fps_));
-            utl::sort(s.sorted_tt_fps_);
-            utl::sort(transfers[l]);
-
-            utl::sorted_diff(
-                s.sorted_tt_fps_, transfers[l],
-                [](auto&& a, auto&& b) { return a.target() < b.target(); },
-                [](auto&& a, auto&& b) { return a.target() == b.target(); },
-                utl::overloaded{
-                    [](n::footpath, n::footpath) { assert(false); },
-                    [&](utl::op const op, n::footpath const x) {
-                      if (op == utl::op::kDel) {
-                        auto const dist = geo::distance(
-                            tt.locations_.coordinates_[l],
-                            tt.locations_.coordinates_[x.target()]);
-                        if (dist < 100.0) {
-                          auto const duration = n::duration_t{
-                              static_cast<int>(std::ceil((dist / 0.7) / 60.0))};
-                          s.missing_.emplace_back(x.target(), duration);
-                        }
-                      }
-                    }});
-
-            utl::concat(transfers[l], s.missing_);
+          if (checkpoints.has_value()) {
+            auto ck = footpath_checkpoint{};
+            for (auto const l : partition) {
+              ck.transfers_.emplace_back(transfers[mode_idx][l]);
+            }
+            for (auto i = elevators_from; i != s.thread_elevators_->size();
+                 ++i) {
+              ck.elevators_.emplace_back((*s.thread_elevators_)[i]);
+            }
+            auto const path = checkpoint_file(*checkpoints, mode, p);
+            auto tmp = path;
+            tmp += ".tmp";
+            cista::write(tmp, ck);
+            std::filesystem::rename(tmp, path);
           }
+        });
+  }
 
-          utl::erase_if(transfers[l], [&](n::footpath fp) {
-            return fp.duration() > mode.max_duration_;
-          });
-          utl::sort(transfers[l]);
+  for (auto const [mode, st] : utl::zip(settings, stats)) {
+    auto const n_routed = st.n_routed_.load();
+    auto const route_ms = static_cast<double>(st.route_ns_.load()) / 1E6;
+    fmt::println(
+        std::clog,
+        "  -> profile={}: {} locations routed ({:.2f} ms/location, {:.0f} "
+        "locations/s per thread), {} resumed from checkpoints",
+        to_str(mode.profile_), n_routed,
+        n_routed == 0U ? 0.0 : route_ms / static_cast<double>(n_routed),
+        route_ms == 0.0 ? 0.0 : static_cast<double>(n_routed) / route_ms * 1E3,
+        st.n_resumed_.load());
+  }
 
-          pt->update_monotonic(n_done + i);
-        });
+  // Profiles write to separate footpath tables.
+  utl::parallel_for_run(settings.size(), [&](std::size_t const mode_idx) {
+    auto const& mode = settings[mode_idx];
+    auto const& out = transfers[mode_idx];
 
     auto transfers_in =
         n::vector_map<n::location_idx_t, std::vector<n::footpath>>{};
     transfers_in.resize(tt.n_locations());
-    for (auto const [i, out] : utl::enumerate(transfers)) {
+    for (auto const [i, fps] : utl::enumerate(out)) {
       auto const l = n::location_idx_t{i};
-      for (auto const fp : out) {
+      for (auto const fp : fps) {
         assert(fp.target() < tt.n_locations());
         transfers_in[fp.target()].push_back(n::footpath{l, fp.duration()});
       }
     }
-    for (auto const& x : transfers) {
+    for (auto const& x : out) {
       tt.locations_.footpaths_out_[mode.profile_idx_].emplace_back(x);
     }
     for (auto const& x : transfers_in) {
       tt.locations_.footpaths_in_[mode.profile_idx_].emplace_back(x);
     }
+  });
 
+  for (auto const& mode : settings) {
     n::loader::build_lb_graph<n::direction::kForward>(tt, mode.profile_idx_);
     n::loader::build_lb_graph<n::direction::kBackward>(tt, mode.profile_idx_);
-
-    n_done += tt.n_locations();
   }
 
-  return elevator_in_paths;
+  return merge_elevator_footpaths(thread_elevators);
 }
 
 }  // namespace motis
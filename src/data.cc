@@ -28,6 +28,7 @@
 
 #include "motis/config.h"
 #include "motis/constants.h"
+#include "motis/elevators/elevator_footpath_index.h"
 #include "motis/elevators/update_elevators.h"
 #include "motis/endpoints/initial.h"
 #include "motis/flex/flex_areas.h"
@@ -35,8 +36,11 @@
 #include "motis/match_platforms.h"
 #include "motis/metrics_registry.h"
 #include "motis/odm/bounds.h"
-#include "motis/point_rtree.h"
+#include "motis/offsets_cache.h"
 #include "motis/railviz.h"
+#include "motis/running_trips.h"
+#include "motis/startup_indices.h"
+#include "motis/static_point_rtree.h"
 #include "motis/tag_lookup.h"
 #include "motis/tiles_data.h"
 #include "motis/tt_location_rtree.h"
@@ -50,8 +54,12 @@ rt::rt() = default;
 
 rt::rt(ptr<nigiri::rt_timetable>&& rtt,
        ptr<elevators>&& e,
-       ptr<railviz_rt_index>&& railviz)
-    : rtt_{std::move(rtt)}, railviz_rt_{std::move(railviz)}, e_{std::move(e)} {}
+       ptr<railviz_rt_index>&& railviz,
+       ptr<running_trips_rt_index>&& running_trips)
+    : rtt_{std::move(rtt)},
+      railviz_rt_{std::move(railviz)},
+      e_{std::move(e)},
+      running_trips_rt_{std::move(running_trips)} {}
 
 rt::~rt() = default;
 
@@ -59,7 +67,7 @@ std::ostream& operator<<(std::ostream& out, data const& d) {
   return out << "\nt=" << d.t_.get() << "\nr=" << d.r_ << "\ntc=" << d.tc_
              << "\nw=" << d.w_ << "\npl=" << d.pl_ << "\nl=" << d.l_
              << "\ntt=" << d.tt_.get()
-             << "\nlocation_rtee=" << d.location_rtree_
+             << "\nlocation_rtee=" << d.location_rtree_.get()
              << "\nelevator_nodes=" << d.elevator_nodes_
              << "\nmatches=" << d.matches_ << "\nrt=" << d.rt_ << "\n";
 }
@@ -111,6 +119,12 @@ data::data(std::filesystem::path p, config const& c)
     }
   }
 
+  if (auto const sr = c.get_street_routing();
+      sr.has_value() && sr->offsets_cache_size_ != 0U && c.timetable_) {
+    offsets_cache_ = std::make_unique<offsets_cache>(sr->offsets_cache_size_,
+                                                     metrics_.get());
+  }
+
   auto geocoder = std::async(std::launch::async, [&]() {
     f_ = std::make_unique<adr::formatter>();
     if (c.geocoding_) {
@@ -190,8 +204,12 @@ data::data(std::filesystem::path p, config const& c)
           *w_, elevator_osm_mapping_.get(), *elevator_nodes_,
           vector_map<elevator_idx_t, elevator>{});
 
+      tt.wait();
+      matches.wait();
+      elevator_footpath_index_ = std::make_unique<elevator_footpath_index>(
+          *w_, *l_, *pl_, *tt_, *matches_);
+
       if (c.get_elevators()->init_) {
-        tt.wait();
         auto new_rtt = std::make_unique<n::rt_timetable>(
             n::rt::create_rt_timetable(*tt_, rt_->rtt_->base_day_));
         rt_->e_ = update_elevators(
@@ -264,19 +282,33 @@ void data::load_osr() {
   if (config_.get_street_routing()->elevation_data_dir_.has_value()) {
     elevations_ = osr::elevation_storage::try_open(osr_path);
   }
-  elevator_nodes_ =
-      std::make_unique<hash_set<osr::node_idx_t>>(get_elevator_nodes(*w_));
   pl_ =
       std::make_unique<osr::platforms>(osr_path, cista::mmap::protection::READ);
-  pl_->build_rtree(*w_);
+
+  // The platforms rtree is internal to osr and can't be persisted: build it
+  // while the elevator nodes are loaded.
+  auto platforms_rtree =
+      std::async(std::launch::async, [&]() { pl_->build_rtree(*w_); });
+  auto const elevator_nodes = elevator_nodes_path(path_);
+  elevator_nodes_ = std::make_unique<hash_set<osr::node_idx_t>>(
+      fs::is_regular_file(elevator_nodes) && indices_up_to_date(path_, config_)
+          ? read_elevator_nodes(elevator_nodes)
+          : get_elevator_nodes(*w_));
+  platforms_rtree.get();
 }
 
 void data::load_tt(fs::path const& p) {
   tags_ = tag_lookup::read(path_ / "tags.bin");
   tt_ = n::timetable::read(path_ / p);
   tt_->resolve();
-  location_rtree_ = std::make_unique<point_rtree<n::location_idx_t>>(
-      create_location_rtree(*tt_));
+  auto const location_rtree = location_rtree_path(path_, p);
+  location_rtree_ =
+      fs::is_regular_file(location_rtree) && indices_up_to_date(path_, config_)
+          ? read_mapped<static_point_rtree<n::location_idx_t>>(location_rtree)
+          : cista::wrapped{cista::raw::make_unique<
+                static_point_rtree<n::location_idx_t>>(
+                create_location_rtree(*tt_))};
+  running_trips_ = std::make_unique<running_trips_static_index>(*tt_);
   init_rtt();
 }
 
@@ -293,6 +325,8 @@ void data::init_initial(std::string_view motis_version) {
 void data::init_rtt(date::sys_days const d) {
   rt_->rtt_ =
       std::make_unique<n::rt_timetable>(n::rt::create_rt_timetable(*tt_, d));
+  rt_->running_trips_rt_ =
+      std::make_unique<running_trips_rt_index>(*tt_, *rt_->rtt_);
 }
 
 void data::load_shapes() {
@@ -302,8 +336,14 @@ void data::load_shapes() {
 }
 
 void data::load_railviz() {
-  railviz_static_ = std::make_unique<railviz_static_index>(*tt_, shapes_.get());
-  rt_->railviz_rt_ = std::make_unique<railviz_rt_index>(*tt_, *rt_->rtt_);
+  auto const railviz_static = railviz_static_path(path_);
+  railviz_static_ =
+      fs::is_regular_file(railviz_static) && indices_up_to_date(path_, config_)
+          ? std::make_unique<railviz_static_index>(railviz_static)
+          : std::make_unique<railviz_static_index>(*tt_, shapes_.get());
+  rt_->railviz_rt_ = std::make_unique<railviz_rt_index>(
+      *tt_, *rt_->rtt_, config_.timetable_->railviz_cache_mb_ * 1024U * 1024U,
+      metrics_.get());
 }
 
 void data::load_tbd() {
@@ -363,9 +403,11 @@ void data::load_way_matches() {
 }
 
 void data::load_tiles() {
-  auto const db_size = config_.tiles_.value().db_size_;
+  auto const& c = config_.tiles_.value();
   tiles_ = std::make_unique<tiles_data>(
-      (path_ / "tiles" / "tiles.mdb").generic_string(), db_size);
+      (path_ / "tiles" / "tiles.mdb").generic_string(), c.db_size_,
+      c.cache_mb_ * 1024U * 1024U, c.low_zoom_cache_mb_ * 1024U * 1024U,
+      metrics_.get());
 }
 
 void data::load_auser_updater(std::string_view tag,
@@ -0,0 +1,95 @@
+#include "motis/elevators/elevator_footpath_index.h"
+
+#include "geo/box.h"
+
+#include "utl/enumerate.h"
+#include "utl/parallel_for.h"
+#include "utl/to_vec.h"
+
+#include "osr/lookup.h"
+
+#include "nigiri/timetable.h"
+
+#include "motis/constants.h"
+#include "motis/elevators/elevators.h"
+#include "motis/get_loc.h"
+#include "motis/update_rtt_td_footpaths.h"
+
+namespace n = nigiri;
+
+namespace motis {
+
+elevator_footpath_index::elevator_footpath_index(
+    osr::ways const& w,
+    osr::lookup const& l,
+    osr::platforms const& pl,
+    n::timetable const& tt,
+    platform_matches_t const& matches) {
+  auto nodes = n::vector_map<n::location_idx_t, nodes_t>{};
+  nodes.resize(tt.n_locations());
+  utl::parallel_for_run(tt.n_locations(), [&](std::size_t const i) {
+    auto const loc =
+        n::location_idx_t{static_cast<n::location_idx_t::value_t>(i)};
+    auto const pos = get_loc(tt, w, pl, matches, loc).pos_;
+    nodes[loc] =
+        utl::to_vec(l.find_elevators(geo::box{pos, kElevatorUpdateRadius}));
+  });
+
+  for (auto const [i, location_nodes] : utl::enumerate(nodes)) {
+    for (auto const node : location_nodes) {
+      locations_[node].emplace_back(
+          n::location_idx_t{static_cast<n::location_idx_t::value_t>(i)});
+    }
+  }
+}
+
+namespace {
+
+void add_tasks(
+    osr::ways const& w,
+    elevators const& old_e,
+    elevators const& new_e,
+    osr::node_idx_t const node,
+    std::vector<n::location_idx_t> const& locations,
+    hash_set<std::pair<n::location_idx_t, osr::direction>>& tasks) {
+  if (get_node_state_changes(w, old_e, node) ==
+      get_node_state_changes(w, new_e, node)) {
+    return;
+  }
+  for (auto const loc : locations) {
+    tasks.emplace(loc, osr::direction::kForward);
+    tasks.emplace(loc, osr::direction::kBackward);
+  }
+}
+
+}  // namespace
+
+hash_set<std::pair<n::location_idx_t, osr::direction>>
+elevator_footpath_index::get_tasks(osr::ways const& w,
+                                   elevators const& old_e,
+                                   elevators const& new_e) const {
+  auto tasks = hash_set<std::pair<n::location_idx_t, osr::direction>>{};
+  for (auto const& [node, locations] : locations_) {
+    add_tasks(w, old_e, new_e, node, locations, tasks);
+  }
+  return tasks;
+}
+
+hash_set<std::pair<n::location_idx_t, osr::direction>>
+elevator_footpath_index::get_tasks(osr::ways const& w,
+                                   osr::lookup const& l,
+                                   elevators const& old_e,
+                                   elevators const& new_e,
+                                   geo::latlng const& pos) const {
+  auto tasks = hash_set<std::pair<n::location_idx_t, osr::direction>>{};
+  for (auto const node :
+       l.find_elevators(geo::box{pos, kElevatorMatchRadius})) {
+    auto const it = locations_.find(node);
+    if (it != end(locations_)) {
+      add_tasks(w, old_e, new_e, node, it->second, tasks);
+    }
+  }
+  return tasks;
+}
+
+}  // namespace motis
@@ -5,6 +5,8 @@
 
 #include "osr/ways.h"
 
+#include "motis/constants.h"
+
 namespace motis {
 
 point_rtree<elevator_idx_t> create_elevator_rtree(
@@ -36,9 +38,9 @@ elevator_idx_t match_elevator(
   auto const pos = w.get_node_pos(n).as_latlng();
   auto closest = elevator_idx_t::invalid();
   auto closest_dist = std::numeric_limits<double>::max();
-  rtree.find(geo::box{pos, 20.0}, [&](elevator_idx_t const e) {
+  rtree.find(geo::box{pos, kElevatorMatchRadius}, [&](elevator_idx_t const e) {
     auto const dist = geo::distance(elevators[e].pos_, pos);
-    if (dist < 20 && dist < closest_dist) {
+    if (dist < kElevatorMatchRadius && dist < closest_dist) {
       closest_dist = dist;
       closest = e;
     }
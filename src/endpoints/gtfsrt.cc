@@ -1,13 +1,26 @@
 #include "motis/endpoints/gtfsrt.h"
 
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
 
 #ifdef NO_DATA
 #undef NO_DATA
 #endif
 #include "gtfsrt/gtfs-realtime.pb.h"
 
+#include "boost/url/parse.hpp"
+
+#include "cista/hash.h"
+
+#include "fmt/format.h"
+
 #include "utl/enumerate.h"
+#include "utl/verify.h"
 
 #include "net/too_many_exception.h"
 
@@ -19,6 +32,7 @@
 
 #include "motis/data.h"
 #include "motis/tag_lookup.h"
+#include "motis/types.h"
 
 namespace n = nigiri;
 
@@ -141,10 +155,8 @@ void add_rt_transports(n::timetable const& tt,
   }
 }
 
-void add_cancelled_transports(n::timetable const& tt,
-                              tag_lookup const& tags,
-                              n::rt_timetable const& rtt,
-                              transit_realtime::FeedMessage& fm) {
+// Cancellations are exposed for the next days, starting from now.
+n::interval<n::day_idx_t> cancelled_days(n::timetable const& tt) {
   auto const start_time = std::max(
       std::chrono::time_point_cast<n::unixtime_t::duration>(
           std::chrono::system_clock::now() -
@@ -157,6 +169,16 @@ void add_cancelled_transports(n::timetable const& tt,
       tt.internal_interval().to_);
   auto const [start_day, _] = tt.day_idx_mam(start_time);
   auto const [end_day, _1] = tt.day_idx_mam(end_time);
+  return {start_day, end_day};
+}
+
+void add_cancelled_transports(n::timetable const& tt,
+                              tag_lookup const& tags,
+                              n::rt_timetable const& rtt,
+                              n::interval<n::day_idx_t> const days,
+                              transit_realtime::FeedMessage& fm) {
+  auto const start_day = days.from_;
+  auto const end_day = days.to_;
 
   for (auto r = nigiri::route_idx_t{0}; r < tt.n_routes(); ++r) {
     for (auto const [i, t_idx] :
@@ -181,7 +203,155 @@ void add_cancelled_transports(n::timetable const& tt,
   }
 }
 
+struct gtfsrt::feed_cache {
+  // Older versions are only needed for differential requests: they keep the
+  // serialized feed and the entity hashes, bounded by this size in total.
+  static constexpr auto const kMaxHistoryBytes =
+      std::size_t{64U} * 1024U * 1024U;
+
+  struct feed {
+    // Serialized trip descriptor (trip ID, start date and time): entities of
+    // the same trip on different days share the trip ID.
+    static std::string entity_key(transit_realtime::FeedEntity const& e) {
+      auto const& td = e.trip_update().trip();
+      auto key = transit_realtime::TripDescriptor{};
+      key.set_trip_id(td.trip_id());
+      key.set_start_date(td.start_date());
+      key.set_start_time(td.start_time());
+      return key.SerializeAsString();
+    }
+
+    feed(std::shared_ptr<rt> const& rt,
+         n::interval<n::day_idx_t> const days,
+         std::string version,
+         transit_realtime::FeedMessage const& fm)
+        : rt_{rt},
+          days_{days},
+          version_{std::move(version)},
+          serialized_{fm.SerializeAsString()} {
+      for (auto const& e : fm.entity()) {
+        auto& h = entities_[entity_key(e)];
+        h = cista::hash_combine(h, cista::hash(e.SerializeAsString()));
+      }
+    }
+
+    bool matches(std::shared_ptr<rt> const& rt,
+                 n::interval<n::day_idx_t> const days) const {
+      return !rt_.owner_before(rt) && !rt.owner_before(rt_) &&
+             !rt_.expired() && days_.from_ == days.from_ &&
+             days_.to_ == days.to_;
+    }
+
+    std::size_t size() const {
+      auto size = sizeof(feed) + serialized_.size();
+      for (auto const& [key, _] : entities_) {
+        size += sizeof(std::pair<std::string, cista::hash_t>) + key.size();
+      }
+      return size;
+    }
+
+    // Entities (trip updates) that differ from the older feed plus deletions
+    // of entities that are not present anymore.
+    std::string differential(feed const& since) {
+      auto const lock = std::scoped_lock{differential_mutex_};
+      if (auto const it = differential_.find(since.version_);
+          it != end(differential_)) {
+        return it->second;
+      }
+
+      auto msg = transit_realtime::FeedMessage{};
+      utl::verify(msg.ParseFromString(serialized_), "gtfsrt: invalid feed");
+
+      auto fm = transit_realtime::FeedMessage{};
+      fm.mutable_header()->CopyFrom(msg.header());
+      fm.mutable_header()->set_incrementality(
+          transit_realtime::FeedHeader_Incrementality_DIFFERENTIAL);
+      for (auto const& e : msg.entity()) {
+        auto const key = entity_key(e);
+        auto const it = since.entities_.find(key);
+        if (it == end(since.entities_) || it->second != entities_.at(key)) {
+          fm.add_entity()->CopyFrom(e);
+        }
+      }
+      for (auto const& [key, _] : since.entities_) {
+        if (entities_.contains(key)) {
+          continue;
+        }
+        auto td = transit_realtime::TripDescriptor{};
+        td.ParseFromString(key);
+        auto const deleted = fm.add_entity();
+        deleted->set_id(fmt::format("{}/{}/{}", td.trip_id(), td.start_date(),
+                                    td.start_time()));
+        deleted->set_is_deleted(true);
+        deleted->mutable_trip_update()->mutable_trip()->CopyFrom(td);
+      }
+      return differential_.emplace(since.version_, fm.SerializeAsString())
+          .first->second;
+    }
+
+    void clear_differentials() {
+      auto const lock = std::scoped_lock{differential_mutex_};
+      differential_ = {};
+    }
+
+    std::weak_ptr<rt> rt_;
+    n::interval<n::day_idx_t> days_;
+    std::string version_;
+    std::string serialized_;
+    hash_map<std::string, cista::hash_t> entities_;
+
+    // Only filled for the latest version.
+    std::mutex differential_mutex_;
+    hash_map<std::string, std::string> differential_;
+  };
+
+  std::shared_ptr<feed> get(std::shared_ptr<rt> const& rt,
+                            n::interval<n::day_idx_t> const days,
+                            std::function<transit_realtime::FeedMessage()>
+                                const& build) {
+    auto const lock = std::scoped_lock{mutex_};
+    if (!history_.empty() && history_.back()->matches(rt, days)) {
+      return history_.back();
+    }
+    if (!history_.empty()) {
+      history_.back()->clear_differentials();
+    }
+    auto f = std::make_shared<feed>(
+        rt, days, fmt::format("{}-{}", instance_, ++n_versions_), build());
+    history_.push_back(f);
+    history_size_ += f->size();
+    while (history_size_ > kMaxHistoryBytes && history_.size() > 1U) {
+      history_size_ -= history_.front()->size();
+      history_.pop_front();
+    }
+    return f;
+  }
+
+  std::shared_ptr<feed> find(std::string_view const version) {
+    auto const lock = std::scoped_lock{mutex_};
+    auto const it = std::ranges::find_if(history_, [&](auto const& f) {
+      return f->version_ == version;
+    });
+    return it == end(history_) ? nullptr : *it;
+  }
+
+  std::mutex mutex_;
+  std::deque<std::shared_ptr<feed>> history_;  // oldest first
+  std::size_t history_size_{0U};
+  std::uint64_t n_versions_{0U};
+
+  // Distinguishes versions of different server runs.
+  std::string instance_{fmt::format(
+      "{:x}", std::chrono::system_clock::now().time_since_epoch().count())};
+};
+
+std::shared_ptr<gtfsrt::feed_cache> gtfsrt::make_cache() {
+  return std::make_shared<feed_cache>();
+}
+
 net::reply gtfsrt::operator()(net::route_request const& req, bool) const {
+  namespace http = boost::beast::http;
+
   utl::verify(tt_ != nullptr && tags_ != nullptr, "no tt initialized");
   auto const rt = std::atomic_load(&rt_);
   auto const rtt = rt->rtt_.get();
@@ -192,26 +362,47 @@ net::reply gtfsrt::operator()(net::route_request const& req, bool) const {
               config_.get_limits().gtfsrt_expose_max_trip_updates_,
       "number of trip updates above configured limit");
 
-  auto fm = transit_realtime::FeedMessage();
-  auto fh = fm.mutable_header();
-  fh->set_gtfs_realtime_version("2.0");
-  fh->set_incrementality(
-      transit_realtime::FeedHeader_Incrementality_FULL_DATASET);
-  auto const time = std::time(nullptr);
-  fh->set_timestamp(static_cast<double>(time));
-
-  if (rtt != nullptr) {
-    add_rt_transports(*tt_, *tags_, *rtt, fm);
-    add_cancelled_transports(*tt_, *tags_, *rtt, fm);
+  auto const days = cancelled_days(*tt_);
+  auto const f = cache_->get(rt, days, [&]() {
+    auto fm = transit_realtime::FeedMessage();
+    auto fh = fm.mutable_header();
+    fh->set_gtfs_realtime_version("2.0");
+    fh->set_incrementality(
+        transit_realtime::FeedHeader_Incrementality_FULL_DATASET);
+    auto const time = std::time(nullptr);
+    fh->set_timestamp(static_cast<double>(time));
+
+    if (rtt != nullptr) {
+      add_rt_transports(*tt_, *tags_, *rtt, fm);
+      add_cancelled_transports(*tt_, *tags_, *rtt, days, fm);
+    }
+    return fm;
+  });
+
+  auto since = std::shared_ptr<feed_cache::feed>{};
+  if (auto const url = boost::urls::parse_origin_form(req.target());
+      url.has_value()) {
+    if (auto const it = url->params().find("since");
+        it != url->params().end()) {
+      since = cache_->find((*it).value);
+    }
   }
 
-  auto res = net::web_server::string_res_t{boost::beast::http::status::ok,
-                                           req.version()};
-  res.insert(boost::beast::http::field::content_type, "application/x-protobuf");
+  auto const etag = fmt::format(R"("{}")", f->version_);
+  auto res = net::web_server::string_res_t{http::status::ok, req.version()};
+  res.set(http::field::etag, etag);
   res.keep_alive(req.keep_alive());
-  set_response_body(res, req, fm.SerializeAsString());
+  if (req[http::field::if_none_match] == etag) {
+    res.result(http::status::not_modified);
+    return res;
+  }
+
+  res.insert(http::field::content_type, "application/x-protobuf");
+  set_response_body(res, req,
+                    since == nullptr ? f->serialized_
+                                     : f->differential(*since));
 
   return res;
 }
 
-}  // namespace motis::ep
\ No newline at end of file
+}  // namespace motis::ep
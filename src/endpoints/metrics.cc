@@ -7,23 +7,25 @@
 #include "prometheus/registry.h"
 #include "prometheus/text_serializer.h"
 
-#include "utl/enumerate.h"
-
-#include "nigiri/rt/frun.h"
 #include "nigiri/rt/rt_timetable.h"
 #include "nigiri/timetable.h"
 #include "nigiri/timetable_metrics.h"
 #include "nigiri/types.h"
 
 #include "motis/data.h"
+#include "motis/running_trips.h"
 #include "motis/tag_lookup.h"
 
 namespace n = nigiri;
 
 namespace motis::ep {
 
+// Only visits the transports running now (see running_trips.h): this runs
+// on every scrape.
 void update_all_runs_metrics(nigiri::timetable const& tt,
                              nigiri::rt_timetable const* rtt,
+                             running_trips_static_index const& static_index,
+                             running_trips_rt_index const* rt_index,
                              tag_lookup const& tags,
                              metrics_registry& metrics) {
   auto const start_time =
@@ -56,63 +58,18 @@ void update_all_runs_metrics(nigiri::timetable const& tt,
     metric_by_agency.emplace_back(std::ref(sched), std::ref(real));
   }
 
-  if (rtt != nullptr) {
-    for (auto rt_t = nigiri::rt_transport_idx_t{0};
-         rt_t < rtt->n_rt_transports(); ++rt_t) {
-      auto const fr = n::rt::frun::from_rt(tt, rtt, rt_t);
-      if (!fr.is_scheduled()) {
-        continue;
-      }
-      auto const active = n::interval{
-          fr[0].time(n::event_type::kDep),
-          fr[static_cast<n::stop_idx_t>(fr.stop_range_.size() - 1)].time(
-              n::event_type::kArr) +
-              n::unixtime_t::duration{1}};
-      if (active.overlaps(time_interval)) {
-        auto const provider_idx = fr[0].get_provider_idx(n::event_type::kDep);
-        if (provider_idx != n::provider_idx_t::invalid()) {
+  if (rt_index != nullptr) {
+    rt_index->for_each_running(
+        time_interval, [&](n::provider_idx_t const provider_idx) {
           metric_by_agency.at(provider_idx.v_).first.get().Increment();
           metric_by_agency.at(provider_idx.v_).second.get().Increment();
-        }
-      }
-    }
+        });
   }
 
-  auto const [start_day, _] = tt.day_idx_mam(time_interval.from_);
-  auto const [end_day, _1] = tt.day_idx_mam(time_interval.to_);
-
-  for (auto r = nigiri::route_idx_t{0}; r < tt.n_routes(); ++r) {
-    auto const is_active = [&](n::transport const t) -> bool {
-      return (rtt == nullptr
-                  ? tt.bitfields_[tt.transport_traffic_days_[t.t_idx_]]
-                  : rtt->bitfields_[rtt->transport_traffic_days_[t.t_idx_]])
-          .test(to_idx(t.day_));
-    };
-
-    auto const seq = tt.route_location_seq_[r];
-    auto const from = n::stop_idx_t{0U};
-    auto const to = static_cast<n::stop_idx_t>(seq.size() - 1);
-    auto const arr_times = tt.event_times_at_stop(r, to, n::event_type::kArr);
-
-    for (auto const [i, t_idx] :
-         utl::enumerate(tt.route_transport_ranges_[r])) {
-      auto const day_offset =
-          static_cast<n::day_idx_t::value_t>(arr_times[i].days());
-      for (auto day = start_day - day_offset; day <= end_day; ++day) {
-        auto const t = n::transport{t_idx, day};
-        if (is_active(t) &&
-            time_interval.overlaps({tt.event_time(t, from, n::event_type::kDep),
-                                    tt.event_time(t, to, n::event_type::kArr) +
-                                        n::unixtime_t::duration{1}})) {
-          auto fr = n::rt::frun::from_t(tt, nullptr, t);
-          auto const provider_idx = fr[0].get_provider_idx(n::event_type::kDep);
-          if (provider_idx != n::provider_idx_t::invalid()) {
-            metric_by_agency.at(provider_idx.v_).first.get().Increment();
-          }
-        }
-      }
-    }
-  }
+  static_index.for_each_running(
+      tt, rtt, time_interval, [&](n::provider_idx_t const provider_idx) {
+        metric_by_agency.at(provider_idx.v_).first.get().Increment();
+      });
 
   if (metrics.timetable_first_day_timestamp_.Collect().empty()) {
     auto const m = get_metrics(tt);
@@ -138,10 +95,12 @@ void update_all_runs_metrics(nigiri::timetable const& tt,
 }
 
 net::reply metrics::operator()(net::route_request const& req, bool) const {
-  utl::verify(metrics_ != nullptr && tt_ != nullptr && tags_ != nullptr,
+  utl::verify(metrics_ != nullptr && tt_ != nullptr && tags_ != nullptr &&
+                  running_trips_ != nullptr,
               "no metrics initialized");
   auto const rt = std::atomic_load(&rt_);
-  update_all_runs_metrics(*tt_, rt->rtt_.get(), *tags_, *metrics_);
+  update_all_runs_metrics(*tt_, rt->rtt_.get(), *running_trips_,
+                          rt->running_trips_rt_.get(), *tags_, *metrics_);
   metrics_->total_trips_with_realtime_count_.Set(
       static_cast<double>(rt->rtt_->rt_transport_src_.size()));
   auto res = net::web_server::string_res_t{boost::beast::http::status::ok,
@@ -87,7 +87,8 @@ api::Reachable one_to_all::operator()(boost::urls::url_view const& url) const {
   auto const r = routing{
       config_, w_,        l_,      pl_,      elevations_,  &tt_,    nullptr,
       &tags_,  loc_tree_, fa_,     matches_, way_matches_, rt_,     nullptr,
-      gbfs_,   nullptr,   nullptr, nullptr,  nullptr,      metrics_};
+      gbfs_,   nullptr,   nullptr, nullptr,  nullptr,      metrics_,
+      nullptr};
   auto gbfs_rd = gbfs::gbfs_routing_data{w_, l_, gbfs_};
 
   auto const osr_params = get_osr_parameters(query);
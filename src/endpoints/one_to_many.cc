@@ -1,10 +1,17 @@
 #include "motis/endpoints/one_to_many.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <exception>
 #include <limits>
 #include <optional>
 
+#include "cista/hashing.h"
+
 #include "utl/enumerate.h"
+#include "utl/get_or_create.h"
+#include "utl/overloaded.h"
 
 #include "net/too_many_exception.h"
 
@@ -12,6 +19,7 @@
 #include "nigiri/routing/one_to_all.h"
 
 #include "motis/config.h"
+#include "motis/ctx_data.h"
 #include "motis/endpoints/one_to_many_post.h"
 #include "motis/endpoints/routing.h"
 #include "motis/gbfs/routing_data.h"
@@ -79,8 +87,59 @@ api::oneToMany_response one_to_many_direct(
   });
 }
 
+// Egress street searches are distributed to child operations in chunks.
+constexpr auto const kTargetsPerChild = 4U;
+
 double duration_to_seconds(n::duration_t const d) { return 60 * d.count(); }
 
+struct egress_target_key {
+  bool operator==(egress_target_key const&) const = default;
+
+  cista::hash_t hash() const noexcept {
+    return cista::build_hash(is_stop_, a_, b_, lvl_);
+  }
+
+  bool is_stop_;
+  std::int64_t a_;
+  std::int64_t b_;
+  float lvl_;
+};
+
+struct egress_state {
+  gbfs::gbfs_routing_data gbfs_rd_;
+  stats_map_t stats_;
+};
+
+// Targets at (almost) the same position share one street search.
+std::pair<std::vector<place_t>, std::vector<std::size_t>> deduplicate_targets(
+    std::vector<place_t> const& many) {
+  constexpr auto const kPrecision = 1'000'000.0;
+  auto const get_key = [&](place_t const& p) {
+    return std::visit(
+        utl::overloaded{
+            [](tt_location const& l) {
+              return egress_target_key{true, to_idx(l.l_), 0, 0.0F};
+            },
+            [&](osr::location const& l) {
+              return egress_target_key{
+                  false, std::llround(l.pos_.lat() * kPrecision),
+                  std::llround(l.pos_.lng() * kPrecision),
+                  l.lvl_.has_level() ? l.lvl_.to_float() : -1000.0F};
+            }},
+        p);
+  };
+
+  auto targets = std::vector<place_t>{};
+  auto index = hash_map<egress_target_key, std::size_t>{};
+  auto target_of_many = utl::to_vec(many, [&](place_t const& p) {
+    return utl::get_or_create(index, get_key(p), [&]() {
+      targets.emplace_back(p);
+      return targets.size() - 1U;
+    });
+  });
+  return {std::move(targets), std::move(target_of_many)};
+}
+
 template <typename Endpoint, typename Query>
 std::vector<api::ParetoSet> transit_durations(
     Endpoint const& ep,
@@ -120,7 +179,8 @@ std::vector<api::ParetoSet> transit_durations(
                          ep.elevations_, &ep.tt_, nullptr,     &ep.tags_,
                          ep.loc_tree_,   ep.fa_,  ep.matches_, ep.way_matches_,
                          ep.rt_,         nullptr, ep.gbfs_,    nullptr,
-                         nullptr,        nullptr, nullptr,     ep.metrics_};
+                         nullptr,        nullptr, nullptr,     ep.metrics_,
+                         nullptr};
   auto gbfs_rd = gbfs::gbfs_routing_data{ep.w_, ep.l_, ep.gbfs_};
 
   auto prepare_stats = std::map<std::string, std::uint64_t>{};
@@ -179,22 +239,28 @@ std::vector<api::ParetoSet> transit_durations(
     }
   }
 
-  auto pareto_sets = std::vector<api::ParetoSet>{};
-
   auto const dir = arrive_by ? n::direction::kBackward : n::direction::kForward;
+  auto const deduplicated = deduplicate_targets(many);
+  auto const& targets = deduplicated.first;
+  auto const& target_of_many = deduplicated.second;
+
   // As we iterate over all offsets first, we need to store all best solutions
   // If we would iterate over k first, we could build the pareto set directly.
   // However, that would require more work for handling internals like `delta_t`
-  auto totals = n::vector<double>{};
-  for (auto const [i, l] : utl::enumerate(many)) {
-    totals.clear();
+  auto target_totals = std::vector<std::vector<double>>(targets.size());
+  auto const compute_target = [&](egress_state& s, std::size_t const i) {
+    if (!s.gbfs_rd_.has_data()) {
+      s.gbfs_rd_ = gbfs::gbfs_routing_data{ep.w_, ep.l_, ep.gbfs_};
+    }
+
+    auto& totals = target_totals[i];
     totals.resize(q.max_transfers_, kInfinity);
     auto const offsets = r.get_offsets(
-        nullptr, l,
+        nullptr, targets[i],
         arrive_by ? osr::direction::kForward : osr::direction::kBackward,
         many_modes, rental_options{}, osr_params, pedestrian_profile,
-        elevation_costs, many_max_seconds, max_matching_distance, gbfs_rd,
-        prepare_stats);
+        elevation_costs, many_max_seconds, max_matching_distance, s.gbfs_rd_,
+        s.stats_);
 
     for (auto const offset : offsets) {
       auto const loc = offset.target();
@@ -210,18 +276,59 @@ std::vector<api::ParetoSet> transit_durations(
             });
       }
     }
+  };
+
+  if (targets.size() > kTargetsPerChild &&
+      ctx::current_op<ctx_data>() != nullptr) {
+    auto const n_children =
+        (targets.size() + kTargetsPerChild - 1U) / kTargetsPerChild;
+    auto errors = std::vector<std::exception_ptr>(n_children);
+    auto states = std::vector<egress_state>(n_children);
+    auto children = std::vector<ctx::future_ptr<ctx_data, void>>{};
+    for (auto c = std::size_t{0U}; c != n_children; ++c) {
+      children.emplace_back(spawn_child([&, c]() {
+        try {
+          auto const to =
+              std::min(targets.size(), (c + 1U) * kTargetsPerChild);
+          for (auto i = c * kTargetsPerChild; i != to; ++i) {
+            compute_target(states[c], i);
+          }
+        } catch (...) {
+          errors[c] = std::current_exception();
+        }
+      }));
+    }
+    for (auto const& child : children) {
+      child->val();
+    }
+    for (auto const& err : errors) {
+      if (err) {
+        std::rethrow_exception(err);
+      }
+    }
+    for (auto const& s : states) {
+      prepare_stats.insert(begin(s.stats_), end(s.stats_));
+    }
+  } else {
+    auto s = egress_state{};
+    for (auto i = 0U; i != targets.size(); ++i) {
+      compute_target(s, i);
+    }
+    prepare_stats.insert(begin(s.stats_), end(s.stats_));
+  }
+
+  return utl::to_vec(target_of_many, [&](std::size_t const i) {
     auto entries = api::ParetoSet{};
     auto best = kInfinity;
-    for (auto const [t, d] : utl::enumerate(totals)) {
+    for (auto const [t, d] : utl::enumerate(target_totals[i])) {
       // Filter long durations from offsets with many required transfers
       if (d < best) {
         entries.emplace_back(d, t);
         best = d;
       }
     }
-    pareto_sets.emplace_back(std::move(entries));
-  }
-  return pareto_sets;
+    return entries;
+  });
 }
 
 api::oneToMany_response one_to_many::operator()(
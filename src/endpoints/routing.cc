@@ -1,20 +1,29 @@
 #include "motis/endpoints/routing.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <exception>
+#include <numeric>
 
 #include "boost/thread/tss.hpp"
 
+#include "ctx/operation.h"
+#include "ctx/scheduler.h"
+
 #include "net/bad_request_exception.h"
 #include "net/too_many_exception.h"
 
 #include "prometheus/counter.h"
 #include "prometheus/histogram.h"
 
+#include "utl/concat.h"
 #include "utl/erase_duplicates.h"
 #include "utl/helpers/algorithm.h"
 #include "utl/timing.h"
 
+#include "geo/latlng.h"
+
 #include "osr/lookup.h"
 #include "osr/platforms.h"
 #include "osr/routing/profile.h"
@@ -36,10 +45,12 @@
 
 #include "motis/config.h"
 #include "motis/constants.h"
+#include "motis/ctx_data.h"
 #include "motis/direct_filter.h"
 #include "motis/endpoints/routing.h"
 #include "motis/flex/flex.h"
 #include "motis/flex/flex_output.h"
+#include "motis/flex/mode_id.h"
 #include "motis/gbfs/data.h"
 #include "motis/gbfs/gbfs_output.h"
 #include "motis/gbfs/mode.h"
@@ -49,6 +60,7 @@
 #include "motis/match_platforms.h"
 #include "motis/metrics_registry.h"
 #include "motis/odm/meta_router.h"
+#include "motis/offsets_cache.h"
 #include "motis/osr/max_distance.h"
 #include "motis/osr/mode_to_profile.h"
 #include "motis/osr/street_routing.h"
@@ -59,6 +71,7 @@
 #include "motis/td_offsets.h"
 #include "motis/timetable/modes_to_clasz_mask.h"
 #include "motis/timetable/time_conv.h"
+#include "motis/transport_mode_ids.h"
 #include "motis/update_rtt_td_footpaths.h"
 
 namespace n = nigiri;
@@ -74,7 +87,7 @@ std::vector<n::routing::offset> station_start(n::location_idx_t const l) {
 }
 
 std::vector<n::routing::offset> radius_offsets(
-    point_rtree<n::location_idx_t> const& loc_tree,
+    static_point_rtree<n::location_idx_t> const& loc_tree,
     geo::latlng const& pos,
     double const radius_meters) {
   auto offsets = std::vector<n::routing::offset>{};
@@ -256,6 +269,25 @@ std::vector<n::routing::offset> get_offsets(
     }
 
     auto const max_dist = get_max_distance(profile, osr_params, max);
+
+    auto const cache_key =
+        r.offsets_cache_ != nullptr && !osr::is_rental_profile(profile)
+            ? std::optional{make_offsets_cache_key(pos, profile, dir,
+                                                   osr_params, max,
+                                                   max_matching_distance,
+                                                   rtt != nullptr)}
+            : std::nullopt;
+    if (cache_key.has_value()) {
+      if (auto const cached = r.offsets_cache_->get(*cache_key);
+          cached != nullptr) {
+        offsets.insert(end(offsets), begin(*cached), end(*cached));
+        stats.emplace(
+            fmt::format("prepare_{}_{}_cached", to_str(dir), fmt::streamed(m)),
+            UTL_GET_TIMING_MS(timer));
+        return;
+      }
+    }
+
     auto const near_stops =
         get_stops_with_traffic(*r.tt_, rtt, *r.loc_tree_, pos, max_dist);
     auto const near_stop_locations = utl::to_vec(
@@ -334,15 +366,25 @@ std::vector<n::routing::offset> get_offsets(
       }
 
     } else {
+      auto profile_offsets = std::vector<n::routing::offset>{};
       auto const paths = route(profile, nullptr);
       for (auto const [p, l] : utl::zip(paths, near_stops)) {
         if (p.has_value()) {
-          offsets.emplace_back(
+          profile_offsets.emplace_back(
               l,
               n::duration_t{static_cast<unsigned>(std::ceil(p->cost_ / 60.0))},
               static_cast<n::transport_mode_id_t>(profile));
         }
       }
+      offsets.insert(end(offsets), begin(profile_offsets),
+                     end(profile_offsets));
+      if (cache_key.has_value()) {
+        r.offsets_cache_->put(
+            *cache_key, pos.pos_, max_dist, std::move(profile_offsets), [&]() {
+              return rtt == nullptr ||
+                     std::atomic_load(&r.rt_)->rtt_.get() == rtt;
+            });
+      }
     }
 
     stats.emplace(fmt::format("prepare_{}_{}", to_str(dir), fmt::streamed(m)),
@@ -657,6 +699,70 @@ std::vector<n::routing::via_stop> get_via_stops(
   return ret;
 }
 
+constexpr auto const kItinerariesPerChild = 8U;
+
+// Result of a pre-/post-transit street search executed as child operation.
+struct prepared_offsets {
+  std::vector<n::routing::offset> offsets_;
+  n::routing::td_offsets_t td_offsets_;
+  gbfs::gbfs_routing_data gbfs_rd_;
+  stats_map_t stats_;
+  std::exception_ptr error_;
+};
+
+bool has_odm_or_ride_sharing(std::vector<api::ModeEnum> const& modes) {
+  return utl::any_of(modes, [](api::ModeEnum const m) {
+    return m == api::ModeEnum::ODM || m == api::ModeEnum::RIDE_SHARING;
+  });
+}
+
+// The transit search is skipped if there is a direct connection this fast.
+constexpr auto const kSkipTransitMaxDirect = n::duration_t{5};
+
+// Whether the direct search might find a connection fast enough to skip the
+// transit search: beeline distance vs. the max. speed of the direct modes.
+bool direct_may_skip_transit(api::Place const& from,
+                             api::Place const& to,
+                             std::vector<api::ModeEnum> const& direct_modes,
+                             osr_parameters const& osr_params,
+                             double const fastest_direct_factor) {
+  if (fastest_direct_factor <= 0.0) {
+    return !direct_modes.empty();
+  }
+  // + 30s: fastest_direct is rounded to minutes
+  auto const max = std::chrono::duration_cast<std::chrono::seconds>(
+      (kSkipTransitMaxDirect + 30s) / fastest_direct_factor);
+  auto const dist = geo::distance(geo::latlng{from.lat_, from.lon_},
+                                  geo::latlng{to.lat_, to.lon_});
+  return utl::any_of(direct_modes, [&](api::ModeEnum const m) {
+    auto const profile = m == api::ModeEnum::WALK ? osr::search_profile::kFoot
+                         : m == api::ModeEnum::BIKE
+                             ? osr::search_profile::kBike
+                             : osr::search_profile::kCar;
+    return dist <= get_max_distance(profile, osr_params, max);
+  });
+}
+
+// GBFS transport mode ids are assigned per gbfs_routing_data instance.
+// Re-assigns the ids of `offsets` computed with `from` to ids of `to`.
+void import_gbfs_transport_modes(gbfs::gbfs_routing_data& to,
+                                 gbfs::gbfs_routing_data& from,
+                                 std::vector<n::routing::offset>& offsets) {
+  if (!from.has_data()) {
+    return;
+  }
+  for (auto& [ref, prd] : from.products_) {
+    to.products_.emplace(ref, std::move(prd));
+  }
+  for (auto& o : offsets) {
+    if (!flex::mode_id::is_flex(o.transport_mode_id_) &&
+        o.transport_mode_id_ >= kGbfsTransportModeIdOffset) {
+      o.transport_mode_id_ =
+          to.get_transport_mode(from.get_products_ref(o.transport_mode_id_));
+    }
+  }
+}
+
 std::vector<api::ModeEnum> deduplicate(std::vector<api::ModeEnum> m) {
   utl::erase_duplicates(m);
   return m;
@@ -679,9 +785,12 @@ api::plan_response routing::operator()(boost::urls::url_view const& url) const {
                        : rt->rtt_.get();
   auto const e = rt->e_.get();
   auto gbfs_rd = gbfs::gbfs_routing_data{w_, l_, gbfs_};
-  if (blocked.get() == nullptr && is_osr_loaded()) {
-    blocked.reset(new osr::bitvec<osr::node_idx_t>{w_->n_nodes()});
-  }
+  auto const init_blocked = [&]() {
+    if (blocked.get() == nullptr && is_osr_loaded()) {
+      blocked.reset(new osr::bitvec<osr::node_idx_t>{w_->n_nodes()});
+    }
+  };
+  init_blocked();
 
   auto const api_version = get_api_version(url);
 
@@ -756,26 +865,167 @@ api::plan_response routing::operator()(boost::urls::url_view const& url) const {
 
   auto const [start_time, t] = get_start_time(query, tt_);
 
+  auto const pre_transit_time = std::min(
+      std::chrono::seconds{query.maxPreTransitTime_},
+      std::chrono::seconds{
+          config_.get_limits().street_routing_max_prepost_transit_seconds_});
+  auto const post_transit_time = std::min(
+      std::chrono::seconds{query.maxPostTransitTime_},
+      std::chrono::seconds{
+          config_.get_limits().street_routing_max_prepost_transit_seconds_});
+
+  auto const use_radius_start = query.radius_.has_value() &&
+                                std::holds_alternative<osr::location>(start);
+  auto const use_radius_dest = query.radius_.has_value() &&
+                               std::holds_alternative<osr::location>(dest);
+
+  auto const get_start_offsets = [&](gbfs::gbfs_routing_data& rd,
+                                     stats_map_t& stats) {
+    return use_radius_start
+               ? radius_offsets(*loc_tree_,
+                                std::get<osr::location>(start).pos_,
+                                *query.radius_)
+               : get_offsets(
+                     rtt, start,
+                     query.arriveBy_ ? osr::direction::kBackward
+                                     : osr::direction::kForward,
+                     start_modes,
+                     rental_options{start_form_factors, start_propulsion_types,
+                                    start_rental_providers,
+                                    start_rental_provider_groups,
+                                    start_ignore_return_constraints},
+                     osr_params, query.pedestrianProfile_,
+                     query.elevationCosts_,
+                     query.arriveBy_ ? post_transit_time : pre_transit_time,
+                     query.maxMatchingDistance_, rd, stats);
+  };
+  auto const get_dest_offsets = [&](gbfs::gbfs_routing_data& rd,
+                                    stats_map_t& stats) {
+    return use_radius_dest
+               ? radius_offsets(*loc_tree_, std::get<osr::location>(dest).pos_,
+                                *query.radius_)
+               : get_offsets(
+                     rtt, dest,
+                     query.arriveBy_ ? osr::direction::kForward
+                                     : osr::direction::kBackward,
+                     dest_modes,
+                     rental_options{dest_form_factors, dest_propulsion_types,
+                                    dest_rental_providers,
+                                    dest_rental_provider_groups,
+                                    dest_ignore_return_constraints},
+                     osr_params, query.pedestrianProfile_,
+                     query.elevationCosts_,
+                     query.arriveBy_ ? pre_transit_time : post_transit_time,
+                     query.maxMatchingDistance_, rd, stats);
+  };
+  auto const get_td_start_offsets = [&](stats_map_t& stats) {
+    return get_td_offsets(
+        rtt, e, start,
+        query.arriveBy_ ? osr::direction::kBackward : osr::direction::kForward,
+        start_modes, osr_params, query.pedestrianProfile_,
+        query.elevationCosts_, query.maxMatchingDistance_,
+        query.arriveBy_ ? post_transit_time : pre_transit_time,
+        start_time.start_time_, stats);
+  };
+  auto const get_td_dest_offsets = [&](stats_map_t& stats) {
+    return get_td_offsets(
+        rtt, e, dest,
+        query.arriveBy_ ? osr::direction::kForward : osr::direction::kBackward,
+        dest_modes, osr_params, query.pedestrianProfile_,
+        query.elevationCosts_, query.maxMatchingDistance_,
+        query.arriveBy_ ? pre_transit_time : post_transit_time,
+        start_time.start_time_, stats);
+  };
+
+  // Opt-in: the pre- and post-transit street searches don't depend on the
+  // direct search. Run them as child operations while this operation computes
+  // direct connections. Not done if a direct connection could be fast enough
+  // to skip the transit search.
+  auto const parallel = config_.get_street_routing()
+                            .value_or(config::street_routing{})
+                            .parallel_street_searches_ &&
+                        ctx::current_op<ctx_data>() != nullptr;
+  auto const parallel_prepare =
+      parallel && is_osr_loaded() &&
+      !query.transitModes_.empty() && max_transfers >= 0 && tt_ != nullptr &&
+      tags_ != nullptr && loc_tree_ != nullptr &&
+      !has_odm_or_ride_sharing(pre_transit_modes) &&
+      !has_odm_or_ride_sharing(post_transit_modes) &&
+      !has_odm_or_ride_sharing(direct_modes) &&
+      !(t.has_value() &&
+        direct_may_skip_transit(from_p, to_p, direct_modes, osr_params,
+                                query.fastestDirectFactor_));
+  auto prepared = std::array<prepared_offsets, 2U>{};
+  auto prepare_children = std::vector<ctx::future_ptr<ctx_data, void>>{};
+  if (parallel_prepare) {
+    for (auto const is_start : {true, false}) {
+      auto& p = prepared[is_start ? 0U : 1U];
+      prepare_children.emplace_back(spawn_child([&, is_start]() {
+        try {
+          init_blocked();
+          p.gbfs_rd_ = gbfs::gbfs_routing_data{w_, l_, gbfs_};
+          p.offsets_ = is_start ? get_start_offsets(p.gbfs_rd_, p.stats_)
+                                : get_dest_offsets(p.gbfs_rd_, p.stats_);
+          p.td_offsets_ = is_start ? get_td_start_offsets(p.stats_)
+                                   : get_td_dest_offsets(p.stats_);
+        } catch (...) {
+          p.error_ = std::current_exception();
+        }
+      }));
+    }
+  }
+
   UTL_START_TIMING(direct);
-  auto [direct, fastest_direct] =
-      t.has_value() && !direct_modes.empty() && w_ && l_
-          ? route_direct(
-                e, gbfs_rd, lang, from_p, to_p, direct_modes,
-                query.directRentalFormFactors_,
-                query.directRentalPropulsionTypes_,
-                query.directRentalProviders_, query.directRentalProviderGroups_,
-                query.ignoreDirectRentalReturnConstraints_, *t, query.arriveBy_,
-                osr_params, query.pedestrianProfile_, query.elevationCosts_,
-                std::min(std::chrono::seconds{query.maxDirectTime_},
-                         std::chrono::seconds{
-                             config_.get_limits()
-                                 .street_routing_max_direct_seconds_}),
-                query.maxMatchingDistance_, query.fastestDirectFactor_,
-                query.detailedLegs_, api_version)
-          : std::pair{std::vector<api::Itinerary>{}, kInfinityDuration};
+  auto direct_error = std::exception_ptr{};
+  auto [direct, fastest_direct] = [&]() {
+    try {
+      return t.has_value() && !direct_modes.empty() && w_ && l_
+                 ? route_direct(
+                       e, gbfs_rd, lang, from_p, to_p, direct_modes,
+                       query.directRentalFormFactors_,
+                       query.directRentalPropulsionTypes_,
+                       query.directRentalProviders_,
+                       query.directRentalProviderGroups_,
+                       query.ignoreDirectRentalReturnConstraints_, *t,
+                       query.arriveBy_, osr_params, query.pedestrianProfile_,
+                       query.elevationCosts_,
+                       std::min(std::chrono::seconds{query.maxDirectTime_},
+                                std::chrono::seconds{
+                                    config_.get_limits()
+                                        .street_routing_max_direct_seconds_}),
+                       query.maxMatchingDistance_, query.fastestDirectFactor_,
+                       query.detailedLegs_, api_version)
+                 : std::pair{std::vector<api::Itinerary>{}, kInfinityDuration};
+    } catch (...) {
+      if (!parallel_prepare) {
+        throw;
+      }
+      direct_error = std::current_exception();
+      return std::pair{std::vector<api::Itinerary>{}, kInfinityDuration};
+    }
+  }();
   UTL_STOP_TIMING(direct);
 
-  if (!query.transitModes_.empty() && fastest_direct > 5min &&
+  auto prepare_stats = std::map<std::string, std::uint64_t>{};
+  if (parallel_prepare) {
+    // Children reference this stack frame: join before anything can throw.
+    for (auto const& child : prepare_children) {
+      child->val();
+    }
+    init_blocked();  // operation might have been resumed on another thread
+    if (direct_error) {
+      std::rethrow_exception(direct_error);
+    }
+    for (auto& p : prepared) {
+      if (p.error_) {
+        std::rethrow_exception(p.error_);
+      }
+      import_gbfs_transport_modes(gbfs_rd, p.gbfs_rd_, p.offsets_);
+      prepare_stats.insert(begin(p.stats_), end(p.stats_));
+    }
+  }
+
+  if (!query.transitModes_.empty() && fastest_direct > kSkipTransitMaxDirect &&
       max_transfers >= 0) {
     utl::verify(tt_ != nullptr && tags_ != nullptr && loc_tree_ != nullptr,
                 "mode=TRANSIT requires timetable to be loaded");
@@ -835,23 +1085,7 @@ api::plan_response routing::operator()(boost::urls::url_view const& url) const {
           .run();
     }
 
-    auto const pre_transit_time = std::min(
-        std::chrono::seconds{query.maxPreTransitTime_},
-        std::chrono::seconds{
-            config_.get_limits().street_routing_max_prepost_transit_seconds_});
-    auto const post_transit_time = std::min(
-        std::chrono::seconds{query.maxPostTransitTime_},
-        std::chrono::seconds{
-            config_.get_limits().street_routing_max_prepost_transit_seconds_});
-
     UTL_START_TIMING(query_preparation);
-    auto prepare_stats = std::map<std::string, std::uint64_t>{};
-
-    auto const use_radius_start = query.radius_.has_value() &&
-                                  std::holds_alternative<osr::location>(start);
-    auto const use_radius_dest = query.radius_.has_value() &&
-                                 std::holds_alternative<osr::location>(dest);
-
     auto q = n::routing::query{
         .start_time_ = start_time.start_time_,
         .start_match_mode_ = (use_radius_start || is_osr_loaded())
@@ -861,57 +1095,16 @@ api::plan_response routing::operator()(boost::urls::url_view const& url) const {
                                 ? n::routing::location_match_mode::kIntermodal
                                 : n::routing::location_match_mode::kEquivalent,
         .use_start_footpaths_ = !use_radius_start && !is_osr_loaded(),
-        .start_ =
-            use_radius_start
-                ? radius_offsets(*loc_tree_,
-                                 std::get<osr::location>(start).pos_,
-                                 *query.radius_)
-                : get_offsets(
-                      rtt, start,
-                      query.arriveBy_ ? osr::direction::kBackward
-                                      : osr::direction::kForward,
-                      start_modes,
-                      rental_options{start_form_factors, start_propulsion_types,
-                                     start_rental_providers,
-                                     start_rental_provider_groups,
-                                     start_ignore_return_constraints},
-                      osr_params, query.pedestrianProfile_,
-                      query.elevationCosts_,
-                      query.arriveBy_ ? post_transit_time : pre_transit_time,
-                      query.maxMatchingDistance_, gbfs_rd, prepare_stats),
-        .destination_ =
-            use_radius_dest
-                ? radius_offsets(*loc_tree_, std::get<osr::location>(dest).pos_,
-                                 *query.radius_)
-                : get_offsets(
-                      rtt, dest,
-                      query.arriveBy_ ? osr::direction::kForward
-                                      : osr::direction::kBackward,
-                      dest_modes,
-                      rental_options{dest_form_factors, dest_propulsion_types,
-                                     dest_rental_providers,
-                                     dest_rental_provider_groups,
-                                     dest_ignore_return_constraints},
-                      osr_params, query.pedestrianProfile_,
-                      query.elevationCosts_,
-                      query.arriveBy_ ? pre_transit_time : post_transit_time,
-                      query.maxMatchingDistance_, gbfs_rd, prepare_stats),
-        .td_start_ = get_td_offsets(
-            rtt, e, start,
-            query.arriveBy_ ? osr::direction::kBackward
-                            : osr::direction::kForward,
-            start_modes, osr_params, query.pedestrianProfile_,
-            query.elevationCosts_, query.maxMatchingDistance_,
-            query.arriveBy_ ? post_transit_time : pre_transit_time,
-            start_time.start_time_, prepare_stats),
-        .td_dest_ = get_td_offsets(
-            rtt, e, dest,
-            query.arriveBy_ ? osr::direction::kForward
-                            : osr::direction::kBackward,
-            dest_modes, osr_params, query.pedestrianProfile_,
-            query.elevationCosts_, query.maxMatchingDistance_,
-            query.arriveBy_ ? pre_transit_time : post_transit_time,
-            start_time.start_time_, prepare_stats),
+        .start_ = parallel_prepare
+                      ? std::move(prepared[0].offsets_)
+                      : get_start_offsets(gbfs_rd, prepare_stats),
+        .destination_ = parallel_prepare
+                            ? std::move(prepared[1].offsets_)
+                            : get_dest_offsets(gbfs_rd, prepare_stats),
+        .td_start_ = parallel_prepare ? std::move(prepared[0].td_offsets_)
+                                      : get_td_start_offsets(prepare_stats),
+        .td_dest_ = parallel_prepare ? std::move(prepared[1].td_offsets_)
+                                     : get_td_dest_offsets(prepare_stats),
         .max_transfers_ = static_cast<std::uint8_t>(max_transfers),
         .max_travel_time_ = query.maxTravelTime_
                                 .and_then([](std::int64_t const dur) {
@@ -1037,36 +1230,106 @@ api::plan_response routing::operator()(boost::urls::url_view const& url) const {
       q_for_alts.flip_dir();
     }
 
+    UTL_START_TIMING(reconstruction);
+    auto itineraries = std::vector<api::Itinerary>(journeys.size());
+    auto itinerary_ms = std::vector<std::uint64_t>(journeys.size());
+    auto leg_ms = std::vector<std::vector<std::uint64_t>>(journeys.size());
+    auto const reconstruct = [&](std::size_t const i,
+                                 gbfs::gbfs_routing_data& rd,
+                                 street_routing_cache_t& cache) {
+      UTL_START_TIMING(itinerary);
+      itineraries[i] = journey_to_response(
+          w_, l_, pl_, *tt_, *tags_, fa_, e, rtt, matches_, elevations_,
+          shapes_, rd, ae_, tz_, journeys[i], start, dest, cache, blocked.get(),
+          query.requireCarTransport_ && query.useRoutedTransfers_, osr_params,
+          query.pedestrianProfile_, query.elevationCosts_,
+          query.joinInterlinedLegs_, detailed_transfers, query.detailedLegs_,
+          query.withFares_, query.withScheduledSkippedStops_,
+          config_.timetable_.value().max_matching_distance_,
+          query.maxMatchingDistance_, api_version,
+          query.ignorePreTransitRentalReturnConstraints_,
+          query.ignorePostTransitRentalReturnConstraints_, query.language_,
+          true,
+          query.numLegAlternatives_ > 0
+              ? alternatives_context{query_alternatives{
+                    q_for_alts,
+                    static_cast<std::size_t>(query.numLegAlternatives_)}}
+              : alternatives_context{},
+          &leg_ms[i]);
+      itinerary_ms[i] = UTL_GET_TIMING_MS(itinerary);
+    };
+
+    if (parallel && journeys.size() > kItinerariesPerChild) {
+      // Each child reconstructs a contiguous range of journeys into its
+      // own output slots: the output order equals the journey order.
+      auto const n_children = (journeys.size() + kItinerariesPerChild - 1U) /
+                              kItinerariesPerChild;
+      auto errors = std::vector<std::exception_ptr>(n_children);
+      auto children = std::vector<ctx::future_ptr<ctx_data, void>>{};
+      for (auto c = std::size_t{0U}; c != n_children; ++c) {
+        children.emplace_back(spawn_child([&, c]() {
+          try {
+            init_blocked();
+            auto rd = gbfs_rd;  // copy: keeps assigned transport mode ids
+            auto cache = street_routing_cache_t{};
+            auto const to = std::min(journeys.size(),
+                                     (c + 1U) * kItinerariesPerChild);
+            for (auto i = c * kItinerariesPerChild; i != to; ++i) {
+              reconstruct(i, rd, cache);
+            }
+          } catch (...) {
+            errors[c] = std::current_exception();
+          }
+        }));
+      }
+      for (auto const& child : children) {
+        child->val();
+      }
+      init_blocked();
+      for (auto const& err : errors) {
+        if (err) {
+          std::rethrow_exception(err);
+        }
+      }
+    } else {
+      auto cache = street_routing_cache_t{};
+      for (auto i = 0U; i != journeys.size(); ++i) {
+        reconstruct(i, gbfs_rd, cache);
+      }
+    }
+    UTL_STOP_TIMING(reconstruction);
+
+    auto all_leg_ms = std::vector<std::uint64_t>{};
+    for (auto const& x : leg_ms) {
+      utl::concat(all_leg_ms, x);
+    }
+    auto const reconstruction_stats = stats_map_t{
+        {"reconstruction", UTL_TIMING_MS(reconstruction)},
+        {"reconstruction_sum_itineraries",
+         std::accumulate(begin(itinerary_ms), end(itinerary_ms),
+                         std::uint64_t{0U})},
+        {"reconstruction_max_itinerary",
+         itinerary_ms.empty() ? 0U : *std::ranges::max_element(itinerary_ms)},
+        {"reconstruction_sum_legs",
+         std::accumulate(begin(all_leg_ms), end(all_leg_ms),
+                         std::uint64_t{0U})},
+        {"reconstruction_max_leg",
+         all_leg_ms.empty() ? 0U : *std::ranges::max_element(all_leg_ms)},
+        {"reconstruction_n_legs",
+         std::accumulate(begin(journeys), end(journeys), std::uint64_t{0U},
+                         [](std::uint64_t const sum, auto const& j) {
+                           return sum + j.legs_.size();
+                         })}};
+
     return {
         .debugOutput_ =
             join(std::move(prepare_stats), std::move(query_stats),
-                 r.search_stats_.to_map(), std::move(r.algo_stats_)),
+                 r.search_stats_.to_map(), std::move(r.algo_stats_),
+                 reconstruction_stats),
         .from_ = bwd_compat_lvl_adjust(std::move(from_p), api_version),
         .to_ = bwd_compat_lvl_adjust(std::move(to_p), api_version),
         .direct_ = std::move(direct),
-        .itineraries_ = utl::to_vec(
-            journeys,
-            [&, cache = street_routing_cache_t{}](auto&& j) mutable {
-              return journey_to_response(
-                  w_, l_, pl_, *tt_, *tags_, fa_, e, rtt, matches_, elevations_,
-                  shapes_, gbfs_rd, ae_, tz_, j, start, dest, cache,
-                  blocked.get(),
-                  query.requireCarTransport_ && query.useRoutedTransfers_,
-                  osr_params, query.pedestrianProfile_, query.elevationCosts_,
-                  query.joinInterlinedLegs_, detailed_transfers,
-                  query.detailedLegs_, query.withFares_,
-                  query.withScheduledSkippedStops_,
-                  config_.timetable_.value().max_matching_distance_,
-                  query.maxMatchingDistance_, api_version,
-                  query.ignorePreTransitRentalReturnConstraints_,
-                  query.ignorePostTransitRentalReturnConstraints_,
-                  query.language_, true,
-                  query.numLegAlternatives_ > 0
-                      ? alternatives_context{query_alternatives{
-                            q_for_alts, static_cast<std::size_t>(
-                                            query.numLegAlternatives_)}}
-                      : alternatives_context{});
-            }),
+        .itineraries_ = std::move(itineraries),
         .previousPageCursor_ =
             fmt::format("EARLIER|{}", to_seconds(search_interval.from_)),
         .nextPageCursor_ =
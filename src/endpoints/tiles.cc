@@ -1,21 +1,56 @@
 #include "motis/endpoints/tiles.h"
 
+#include <mutex>
 #include <string>
 
+#include "cista/hash.h"
+
+#include "fmt/format.h"
+
+#include "utl/get_or_create.h"
+
 #include "net/web_server/url_decode.h"
 
-#include "tiles/get_tile.h"
 #include "tiles/parse_tile_url.h"
-#include "tiles/perf_counter.h"
 
 #include "motis/tiles_data.h"
+#include "motis/types.h"
 
 #include "pbf_sdf_fonts_res.h"
 
 using namespace std::string_view_literals;
 
+namespace http = boost::beast::http;
+
 namespace motis::ep {
 
+// Tiles only change with a new import (i.e. restart). Clients revalidate
+// with If-None-Match after max-age.
+constexpr auto const kTileCacheControl = "public, max-age=3600"sv;
+constexpr auto const kGlyphCacheControl = "public, max-age=86400"sv;
+
+net::reply not_modified(net::route_request const& req,
+                        std::string_view const etag,
+                        std::string_view const cache_control) {
+  auto res =
+      net::web_server::empty_res_t{http::status::not_modified, req.version()};
+  res.set(http::field::etag, etag);
+  res.set(http::field::cache_control, cache_control);
+  res.keep_alive(req.keep_alive());
+  return res;
+}
+
+// Glyphs are compiled into the binary: hash each resource only once.
+std::string glyph_etag(std::string const& res_name,
+                       std::string_view const glyphs) {
+  static auto mutex = std::mutex{};
+  static auto etags = hash_map<std::string, std::string>{};
+  auto const lock = std::scoped_lock{mutex};
+  return utl::get_or_create(etags, res_name, [&]() {
+    return fmt::format(R"("{:x}")", cista::hash(glyphs));
+  });
+}
+
 net::reply tiles::operator()(net::route_request const& req, bool) const {
   auto const url = boost::url_view{req.target()};
   if (url.path().starts_with("/tiles/glyphs")) {
@@ -32,12 +67,18 @@ net::reply tiles::operator()(net::route_request const& req, bool) const {
 
     try {
       auto const mem = pbf_sdf_fonts_res::get_resource(res_name);
-      auto res = net::web_server::string_res_t{boost::beast::http::status::ok,
-                                               req.version()};
-      res.body() =
+      auto const glyphs =
           std::string_view{reinterpret_cast<char const*>(mem.ptr_), mem.size_};
-      res.insert(boost::beast::http::field::content_type,
-                 "application/x-protobuf");
+      auto const etag = glyph_etag(res_name, glyphs);
+      if (req[http::field::if_none_match] == etag) {
+        return not_modified(req, etag, kGlyphCacheControl);
+      }
+
+      auto res = net::web_server::string_res_t{http::status::ok, req.version()};
+      res.body() = glyphs;
+      res.insert(http::field::content_type, "application/x-protobuf");
+      res.set(http::field::etag, etag);
+      res.set(http::field::cache_control, kGlyphCacheControl);
       res.keep_alive(req.keep_alive());
       return res;
     } catch (std::out_of_range const&) {
@@ -47,21 +88,21 @@ net::reply tiles::operator()(net::route_request const& req, bool) const {
 
   auto const tile = ::tiles::parse_tile_url(url.path());
   if (!tile.has_value()) {
-    return net::web_server::empty_res_t{boost::beast::http::status::not_found,
+    return net::web_server::empty_res_t{http::status::not_found,
                                         req.version()};
   }
 
-  auto pc = ::tiles::null_perf_counter{};
-  auto const rendered_tile =
-      ::tiles::get_tile(tiles_data_.db_handle_, tiles_data_.pack_handle_,
-                        tiles_data_.render_ctx_, *tile, pc);
-
-  auto res = net::web_server::string_res_t{boost::beast::http::status::ok,
-                                           req.version()};
-  res.insert(boost::beast::http::field::content_type,
-             "application/vnd.mapbox-vector-tile");
-  res.insert(boost::beast::http::field::content_encoding, "deflate");
-  res.body() = rendered_tile.value_or("");
+  auto const rendered = tiles_data_.get_tile(*tile);
+  if (req[http::field::if_none_match] == rendered->etag_) {
+    return not_modified(req, rendered->etag_, kTileCacheControl);
+  }
+
+  auto res = net::web_server::string_res_t{http::status::ok, req.version()};
+  res.insert(http::field::content_type, "application/vnd.mapbox-vector-tile");
+  res.insert(http::field::content_encoding, "deflate");
+  res.set(http::field::etag, rendered->etag_);
+  res.set(http::field::cache_control, kTileCacheControl);
+  res.body() = rendered->body_;
   res.keep_alive(req.keep_alive());
   return res;
 }
@@ -5,10 +5,13 @@
 #include "nigiri/rt/create_rt_timetable.h"
 
 #include "motis/constants.h"
+#include "motis/elevators/elevator_footpath_index.h"
 #include "motis/elevators/elevators.h"
 #include "motis/elevators/parse_fasta.h"
 #include "motis/get_loc.h"
+#include "motis/offsets_cache.h"
 #include "motis/railviz.h"
+#include "motis/running_trips.h"
 #include "motis/update_rtt_td_footpaths.h"
 
 namespace json = boost::json;
@@ -39,25 +42,37 @@ json::value update_elevator::operator()(json::value const& query) const {
   it->state_changes_ =
       intervals_to_state_changes(it->out_of_service_, it->status_);
 
-  auto tasks = hash_set<std::pair<n::location_idx_t, osr::direction>>{};
-  loc_rtree_.in_radius(it->pos_, kElevatorUpdateRadius,
-                       [&](n::location_idx_t const l) {
-                         tasks.emplace(l, osr::direction::kForward);
-                         tasks.emplace(l, osr::direction::kBackward);
-                       });
-
+  auto const pos = it->pos_;
   auto new_e =
       elevators{w_, elevator_ids_, elevator_nodes_, std::move(elevators_copy)};
+
+  auto tasks = hash_set<std::pair<n::location_idx_t, osr::direction>>{};
+  if (elevator_footpath_index_ != nullptr) {
+    tasks = elevator_footpath_index_->get_tasks(w_, l_, *e, new_e, pos);
+  } else {
+    loc_rtree_.in_radius(pos, kElevatorUpdateRadius,
+                         [&](n::location_idx_t const l) {
+                           tasks.emplace(l, osr::direction::kForward);
+                           tasks.emplace(l, osr::direction::kBackward);
+                         });
+  }
   auto new_rtt = n::rt::create_rt_timetable(tt_, rtt->base_day_);
   update_rtt_td_footpaths(
-      w_, l_, pl_, tt_, loc_rtree_, new_e, matches_, tasks, rtt, new_rtt,
+      w_, l_, pl_, tt_, loc_rtree_, new_e, matches_, tasks, rtt, false,
+      new_rtt,
       std::chrono::seconds{c_.timetable_.value().max_footpath_length_ * 60});
 
+  auto new_rt_tt = std::make_unique<n::rt_timetable>(std::move(new_rtt));
+  auto running_trips =
+      std::make_unique<running_trips_rt_index>(tt_, *new_rt_tt);
   auto new_rt = std::make_shared<rt>(
-      std::make_unique<n::rt_timetable>(std::move(new_rtt)),
-      std::make_unique<elevators>(std::move(new_e)),
-      std::move(rt_copy->railviz_rt_));
-  std::atomic_store(&rt_, std::move(new_rt));
+      std::move(new_rt_tt), std::make_unique<elevators>(std::move(new_e)),
+      std::move(rt_copy->railviz_rt_), std::move(running_trips));
+  std::atomic_store(&rt_, new_rt);
+
+  if (offsets_cache_ != nullptr) {
+    offsets_cache_->invalidate(tt_, rtt, new_rt->rtt_.get());
+  }
 
   return json::string{{"success", true}};
 }
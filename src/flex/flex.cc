@@ -156,7 +156,7 @@ n::interval<n::day_idx_t> get_relevant_days(
 
 flex_routings_t get_flex_routings(
     n::timetable const& tt,
-    point_rtree<n::location_idx_t> const& loc_rtree,
+    static_point_rtree<n::location_idx_t> const& loc_rtree,
     n::routing::start_time_t const start_time,
     geo::latlng const& pos,
     osr::direction const dir,
@@ -269,7 +269,7 @@ void add_flex_td_offsets(osr::ways const& w,
                          way_matches_storage const* way_matches,
                          n::timetable const& tt,
                          flex_areas const& fa,
-                         point_rtree<n::location_idx_t> const& loc_rtree,
+                         static_point_rtree<n::location_idx_t> const& loc_rtree,
                          n::routing::start_time_t const start_time,
                          osr::location const& pos,
                          osr::direction const dir,
@@ -3,18 +3,34 @@
 #include "osr/lookup.h"
 #include "osr/ways.h"
 
-#include "motis/gbfs/compression.h"
 #include "motis/gbfs/routing_data.h"
 
 namespace motis::gbfs {
 
+products_bitvecs::products_bitvecs(compressed_routing_data const& compressed) {
+  compressed.start_allowed_.to_bitvec(start_allowed_);
+  compressed.end_allowed_.to_bitvec(end_allowed_);
+  compressed.through_allowed_.to_bitvec(through_allowed_);
+}
+
 products_routing_data::products_routing_data(
     std::shared_ptr<provider_routing_data const>&& prd,
-    compressed_routing_data const& compressed)
-    : provider_routing_data_{std::move(prd)}, compressed_{compressed} {
-  decompress_bitvec(compressed_.start_allowed_, start_allowed_);
-  decompress_bitvec(compressed_.end_allowed_, end_allowed_);
-  decompress_bitvec(compressed_.through_allowed_, through_allowed_);
+    compressed_routing_data const& compressed,
+    std::shared_ptr<products_bitvecs const>&& bitvecs)
+    : provider_routing_data_{std::move(prd)},
+      compressed_{compressed},
+      bitvecs_{std::move(bitvecs)} {}
+
+std::shared_ptr<products_bitvecs const> provider_routing_data::get_bitvecs(
+    gbfs_products_idx_t const prod_idx) const {
+  auto const lock = std::scoped_lock{bitvecs_mutex_};
+  bitvecs_.resize(products_.size());
+  auto& bv = bitvecs_.at(to_idx(prod_idx));
+  if (bv == nullptr) {
+    bv = std::make_shared<products_bitvecs const>(
+        products_.at(to_idx(prod_idx)));
+  }
+  return bv;
 }
 
 std::shared_ptr<products_routing_data> gbfs_data::get_products_routing_data(
@@ -1,6 +1,8 @@
 #include "motis/gbfs/osr_mapping.h"
 
+#include <memory>
 #include <optional>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -22,28 +24,49 @@
 #include "motis/types.h"
 
 #include "motis/box_rtree.h"
-#include "motis/gbfs/compression.h"
 #include "motis/gbfs/data.h"
 #include "motis/gbfs/geofencing.h"
 
 namespace motis::gbfs {
 
-struct node_match {
-  osr::way_candidate const& way() const { return wc_; }
-  osr::node_candidate const& node() const {
-    return left_ ? wc_.left_ : wc_.right_;
-  }
-
-  osr::way_candidate wc_;
-  bool left_{};
-};
-
 struct osr_mapping {
   osr_mapping(osr::ways const& w,
               osr::lookup const& l,
-              gbfs_provider const& provider)
-      : w_{w}, l_{l}, provider_{provider} {
+              gbfs_provider const& provider,
+              osr_mapping_cache const* prev)
+      : w_{w}, l_{l}, provider_{provider}, prev_{prev} {
     products_data_.resize(provider.products_.size());
+    if (provider_.file_infos_ == nullptr) {
+      prev_ = nullptr;  // no file hashes to check the cache against
+    } else {
+      next_.station_information_hash_ =
+          provider_.file_infos_->station_information_fi_.hash_;
+    }
+  }
+
+  // Geofencing results of a product depend on the zones (incl. global
+  // rules), the vehicle types and the product's return constraint.
+  cista::hash_t geofencing_key(provider_products const& prod,
+                               bool const station_parking) const {
+    auto const& fi = *provider_.file_infos_;
+    auto h = cista::hash_combine(
+        cista::BASE_HASH, fi.geofencing_zones_fi_.hash_,
+        fi.vehicle_types_fi_.hash_, provider_.geofencing_zones_.zones_.size(),
+        static_cast<std::uint64_t>(prod.return_constraint_),
+        static_cast<std::uint64_t>(station_parking));
+    for (auto const vt : prod.vehicle_types_) {
+      h = cista::hash_combine(h, to_idx(vt));
+    }
+    return h;
+  }
+
+  osr_mapping_cache::geofencing const* find_prev_geofencing(
+      cista::hash_t const key) const {
+    if (prev_ == nullptr) {
+      return nullptr;
+    }
+    auto const it = prev_->geofencing_.find(key);
+    return it == end(prev_->geofencing_) ? nullptr : &it->second;
   }
 
   void map_geofencing_zones() {
@@ -99,13 +122,64 @@ struct osr_mapping {
           default_restrictions.station_parking_.value_or(false);
     }
 
+    // reuse the results of products whose inputs did not change
+    auto const use_cache = provider_.file_infos_ != nullptr;
+    auto compute = std::vector<bool>(products_data_.size(), true);
+    auto keys = std::vector<cista::hash_t>(products_data_.size());
+    if (use_cache) {
+      for (auto const [i, prod] : utl::enumerate(provider_.products_)) {
+        auto& rd = products_data_[i];
+        keys[i] = geofencing_key(prod, rd.station_parking_);
+        auto const* prev = find_prev_geofencing(keys[i]);
+        if (prev == nullptr) {
+          ++next_.stats_.geofencing_computed_;
+          continue;
+        }
+        for (auto const [n, allowed] : prev->end_allowed_) {
+          rd.end_allowed_.set(n, allowed);
+        }
+        for (auto const [n, allowed] : prev->through_allowed_) {
+          rd.through_allowed_.set(n, allowed);
+        }
+        next_.geofencing_.emplace(keys[i], *prev);
+        compute[i] = false;
+        ++next_.stats_.geofencing_reused_;
+      }
+    }
+    auto results =
+        std::vector<osr_mapping_cache::geofencing*>(products_data_.size());
+    if (use_cache) {
+      for (auto i = 0U; i != products_data_.size(); ++i) {
+        if (compute[i]) {
+          next_.geofencing_[keys[i]];
+        }
+      }
+      // no insertions after this point: pointers stay valid
+      for (auto i = 0U; i != products_data_.size(); ++i) {
+        if (compute[i]) {
+          results[i] = &next_.geofencing_.at(keys[i]);
+        }
+      }
+    }
+    if (provider_.geofencing_zones_.zones_.empty() ||
+        utl::none_of(compute, [](bool const x) { return x; })) {
+      return;
+    }
+
     auto done = make_loc_bitvec();
 
     auto zone_indices = std::vector<std::size_t>{};
     zone_indices.reserve(provider_.geofencing_zones_.zones_.size());
     auto const handle_point = [&](osr::node_idx_t const n,
                                   geo::latlng const& pos) {
-      for (auto [prod, rd] : utl::zip(provider_.products_, products_data_)) {
+      for (auto i = 0U; i != products_data_.size(); ++i) {
+        if (!compute[i]) {
+          continue;
+        }
+
+        auto const& prod = provider_.products_[gbfs_products_idx_t{i}];
+        auto& rd = products_data_[i];
+        auto* result = results[i];
         auto start_allowed = std::optional<bool>{};
         auto end_allowed = std::optional<bool>{};
         auto through_allowed = std::optional<bool>{};
@@ -141,9 +215,15 @@ struct osr_mapping {
         }
         if (end_allowed.has_value()) {
           rd.end_allowed_.set(n, *end_allowed);
+          if (result != nullptr) {
+            result->end_allowed_.emplace_back(n, *end_allowed);
+          }
         }
         if (through_allowed.has_value()) {
           rd.through_allowed_.set(n, *through_allowed);
+          if (result != nullptr) {
+            result->through_allowed_.emplace_back(n, *through_allowed);
+          }
         }
       }
     };
@@ -222,6 +302,57 @@ struct osr_mapping {
     return node_matches;
   }
 
+  std::vector<node_match> const& get_cached_node_matches(
+      geo::latlng const& pos) {
+    auto const key = std::pair{pos.lat(), pos.lng()};
+    if (auto const it = next_.node_matches_.find(key);
+        it != end(next_.node_matches_)) {
+      return it->second;
+    }
+    if (prev_ != nullptr) {
+      if (auto const it = prev_->node_matches_.find(key);
+          it != end(prev_->node_matches_)) {
+        ++next_.stats_.locations_reused_;
+        return next_.node_matches_.emplace(key, it->second).first->second;
+      }
+    }
+    ++next_.stats_.locations_computed_;
+    return next_.node_matches_
+        .emplace(key, get_node_matches(osr::location{pos, osr::level_t{}}))
+        .first->second;
+  }
+
+  std::vector<osr::node_idx_t> const& get_station_area_nodes(
+      std::string const& station_id, tg_geom const* geom) {
+    if (auto const it = next_.station_area_nodes_.find(station_id);
+        it != end(next_.station_area_nodes_)) {
+      return it->second;
+    }
+    if (prev_ != nullptr && prev_->station_information_hash_ ==
+                                next_.station_information_hash_) {
+      if (auto const it = prev_->station_area_nodes_.find(station_id);
+          it != end(prev_->station_area_nodes_)) {
+        return next_.station_area_nodes_.emplace(station_id, it->second)
+            .first->second;
+      }
+    }
+
+    auto nodes = std::vector<osr::node_idx_t>{};
+    auto const rect = tg_geom_rect(geom);
+    auto const bb = geo::box{geo::latlng{rect.min.y, rect.min.x},
+                             geo::latlng{rect.max.y, rect.max.x}};
+    auto const* osr_r = w_.r_.get();
+    l_.find(bb, [&](osr::way_idx_t const way) {
+      for (auto const n : osr_r->way_nodes_[way]) {
+        if (multipoly_contains_point(geom, w_.get_node_pos(n).as_latlng())) {
+          nodes.push_back(n);
+        }
+      }
+    });
+    return next_.station_area_nodes_.emplace(station_id, std::move(nodes))
+        .first->second;
+  }
+
   void map_stations() {
     for (auto [prod_b, rd_b] : utl::zip(provider_.products_, products_data_)) {
       auto& prod = prod_b;  // fix for apple clang
@@ -252,8 +383,7 @@ struct osr_mapping {
           continue;
         }
 
-        auto const matches =
-            get_node_matches(osr::location{st.info_.pos_, osr::level_t{}});
+        auto const& matches = get_cached_node_matches(st.info_.pos_);
         if (matches.empty()) {
           continue;
         }
@@ -266,19 +396,10 @@ struct osr_mapping {
         if (is_returning) {
           rd.end_allowed_.set(additional_node_id, true);
           if (st.info_.station_area_) {
-            auto const* geom = st.info_.station_area_.get();
-            auto const rect = tg_geom_rect(geom);
-            auto const bb = geo::box{geo::latlng{rect.min.y, rect.min.x},
-                                     geo::latlng{rect.max.y, rect.max.x}};
-            auto const* osr_r = w_.r_.get();
-            l_.find(bb, [&](osr::way_idx_t const way) {
-              for (auto const n : osr_r->way_nodes_[way]) {
-                if (multipoly_contains_point(geom,
-                                             w_.get_node_pos(n).as_latlng())) {
-                  rd.end_allowed_.set(n, true);
-                }
-              }
-            });
+            for (auto const n :
+                 get_station_area_nodes(id, st.info_.station_area_.get())) {
+              rd.end_allowed_.set(n, true);
+            }
           }
         }
         for (auto const& m : matches) {
@@ -317,8 +438,7 @@ struct osr_mapping {
           continue;
         }
 
-        auto const matches =
-            get_node_matches(osr::location{vs.pos_, osr::level_t{}});
+        auto const& matches = get_cached_node_matches(vs.pos_);
         if (matches.empty()) {
           continue;
         }
@@ -365,15 +485,18 @@ struct osr_mapping {
   osr::ways const& w_;
   osr::lookup const& l_;
   gbfs_provider const& provider_;
+  osr_mapping_cache const* prev_;
 
   std::vector<routing_data> products_data_;
+  osr_mapping_cache next_;
 };
 
 void map_data(osr::ways const& w,
               osr::lookup const& l,
               gbfs_provider const& provider,
-              provider_routing_data& prd) {
-  auto mapping = osr_mapping{w, l, provider};
+              provider_routing_data& prd,
+              osr_mapping_cache const* prev) {
+  auto mapping = osr_mapping{w, l, provider, prev};
   mapping.map_geofencing_zones();
   mapping.map_stations();
   mapping.map_vehicles();
@@ -384,10 +507,12 @@ void map_data(osr::ways const& w,
         .additional_node_coordinates_ =
             std::move(rd.additional_node_coordinates_),
         .additional_edges_ = std::move(rd.additional_edges_),
-        .start_allowed_ = compress_bitvec(rd.start_allowed_),
-        .end_allowed_ = compress_bitvec(rd.end_allowed_),
-        .through_allowed_ = compress_bitvec(rd.through_allowed_)};
+        .start_allowed_ = sparse_bitvec::from(rd.start_allowed_),
+        .end_allowed_ = sparse_bitvec::from(rd.end_allowed_),
+        .through_allowed_ = sparse_bitvec::from(rd.through_allowed_)};
   });
+  prd.mapping_cache_ =
+      std::make_shared<osr_mapping_cache const>(std::move(mapping.next_));
 }
 
 }  // namespace motis::gbfs
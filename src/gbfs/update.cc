@@ -158,12 +158,14 @@ struct gbfs_update {
               osr::ways const& w,
               osr::lookup const& l,
               gbfs_data* d,
-              gbfs_data const* prev_d)
+              gbfs_data const* prev_d,
+              metrics_registry const* metrics)
       : c_{c},
         w_{w},
         l_{l},
         d_{d},
         prev_d_{prev_d},
+        metrics_{metrics},
         timeout_{c.http_timeout_},
         proxy_{c.proxy_.transform([](std::string const& u) {
           auto const url = boost::urls::url{u};
@@ -393,6 +395,7 @@ struct gbfs_update {
       gbfs_provider& provider,
       gbfs_provider const* prev_provider,
       std::optional<gbfs_file> discovery = std::nullopt) {
+    auto const start = std::chrono::steady_clock::now();
     auto& file_infos = provider.file_infos_;
     auto data_changed = false;
     auto geofencing_updated = false;
@@ -556,9 +559,16 @@ struct gbfs_update {
 
         update_rtree(provider, prev_provider, geofencing_updated);
 
+        // the cache was copied from the previous update: reuse its mapping
+        auto const prev_rd = d_->cache_.get(provider.idx_);
+        auto rd = std::shared_ptr<provider_routing_data>{};
         d_->cache_.try_add_or_update(provider.idx_, [&]() {
-          return compute_provider_routing_data(w_, l_, provider);
+          rd = compute_provider_routing_data(w_, l_, provider, prev_rd.get());
+          return rd;
         });
+        if (rd != nullptr && metrics_ != nullptr) {
+          count_mapping_stats(rd->mapping_cache_->stats_);
+        }
       } catch (std::exception const& ex) {
         std::cerr << "[GBFS] error updating provider " << pf.id_ << ": "
                   << ex.what() << "\n";
@@ -568,6 +578,25 @@ struct gbfs_update {
       provider.products_ = prev_provider->products_;
       provider.has_vehicles_to_rent_ = prev_provider->has_vehicles_to_rent_;
     }
+
+    if (metrics_ != nullptr) {
+      metrics_->gbfs_provider_update_seconds_.Add({{"provider", pf.id_}})
+          .Set(std::chrono::duration<double>{
+              std::chrono::steady_clock::now() - start}
+                   .count());
+    }
+  }
+
+  void count_mapping_stats(osr_mapping_cache::stats const& stats) const {
+    auto& m = metrics_->gbfs_osr_mapping_;
+    m.Add({{"part", "geofencing"}, {"result", "reused"}})
+        .Increment(stats.geofencing_reused_);
+    m.Add({{"part", "geofencing"}, {"result", "computed"}})
+        .Increment(stats.geofencing_computed_);
+    m.Add({{"part", "locations"}, {"result", "reused"}})
+        .Increment(stats.locations_reused_);
+    m.Add({{"part", "locations"}, {"result", "computed"}})
+        .Increment(stats.locations_computed_);
   }
 
   void partition_provider(gbfs_provider& provider) {
@@ -1115,6 +1144,7 @@ struct gbfs_update {
 
   gbfs_data* d_;
   gbfs_data const* prev_d_;
+  metrics_registry const* metrics_;
 
   std::chrono::seconds timeout_;
   std::optional<proxy> proxy_;
@@ -1132,9 +1162,13 @@ awaitable<void> update(config const& c,
   }
 
   auto const prev_d = data_ptr;
-  auto const d = std::make_shared<gbfs_data>(c.gbfs_->cache_size_);
+  auto const d = std::make_shared<gbfs_data>(
+      c.gbfs_->cache_size_,
+      metrics == nullptr
+          ? cache_metrics{}
+          : make_cache_metrics(*metrics, "gbfs_provider_routing_data"));
 
-  auto update = gbfs_update{*c.gbfs_, w, l, d.get(), prev_d.get()};
+  auto update = gbfs_update{*c.gbfs_, w, l, d.get(), prev_d.get(), metrics};
   try {
     co_await update.run();
   } catch (std::exception const& e) {
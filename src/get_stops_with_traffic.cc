@@ -12,7 +12,7 @@ namespace motis {
 std::vector<n::location_idx_t> get_stops_with_traffic(
     n::timetable const& tt,
     n::rt_timetable const* rtt,
-    point_rtree<n::location_idx_t> const& rtree,
+    static_point_rtree<n::location_idx_t> const& rtree,
     osr::location const& pos,
     double const distance,
     n::location_idx_t const not_equal_to) {
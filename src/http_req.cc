@@ -1,8 +1,18 @@
 #include "motis/http_req.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "boost/asio/as_tuple.hpp"
 #include "boost/asio/awaitable.hpp"
 #include "boost/asio/cancel_after.hpp"
 #include "boost/asio/co_spawn.hpp"
+#include "boost/asio/execution_context.hpp"
 #include "boost/asio/io_context.hpp"
 #include "boost/asio/ssl.hpp"
 #include "boost/asio/use_awaitable.hpp"
@@ -17,8 +27,15 @@
 #include "boost/iostreams/filtering_streambuf.hpp"
 #include "boost/url/url.hpp"
 
+#include "fmt/format.h"
+
+#include "prometheus/counter.h"
+
 #include "utl/verify.h"
 
+#include "motis/metrics_registry.h"
+#include "motis/types.h"
+
 namespace motis {
 
 namespace beast = boost::beast;
@@ -26,77 +43,212 @@ namespace http = beast::http;
 namespace asio = boost::asio;
 namespace ssl = asio::ssl;
 
-template <typename Stream>
-asio::awaitable<http_response> req(
-    Stream&&,
-    boost::urls::url const&,
-    std::map<std::string, std::string> const&,
-    std::optional<std::string> const& body = std::nullopt);
+using tls_stream = ssl::stream<beast::tcp_stream>;
+using idle_clock_t = std::chrono::steady_clock;
 
-asio::awaitable<http_response> req_no_tls(
-    boost::urls::url const& url,
-    std::map<std::string, std::string> const& headers,
-    std::optional<std::string> const& body,
-    std::chrono::seconds const timeout,
-    std::optional<proxy> const& proxy) {
-  auto executor = co_await asio::this_coro::executor;
-  auto resolver = asio::ip::tcp::resolver{executor};
-  auto stream = beast::tcp_stream{executor};
+constexpr auto const kMaxIdleConnectionsPerHost = 8U;
+constexpr auto const kIdleConnectionTimeout = std::chrono::seconds{30};
+constexpr auto const kMaxConditionalCacheSize =
+    std::size_t{256U} * 1024U * 1024U;  // 256 M
+constexpr auto const kMaxConditionalCacheEntrySize =
+    std::size_t{64U} * 1024U * 1024U;  // 64 M
 
-  auto const host = proxy ? proxy->host_ : url.host();
-  auto const port =
-      proxy ? proxy->port_ : std::string{url.has_port() ? url.port() : "80"};
-  auto const results = co_await resolver.async_resolve(
-      host, port, asio::cancel_after(timeout, asio::use_awaitable));
+std::atomic<metrics_registry const*> http_metrics{nullptr};
 
-  stream.expires_after(timeout);
+void set_http_metrics(metrics_registry const* m) { http_metrics.store(m); }
 
-  co_await stream.async_connect(results);
-  co_return co_await req(std::move(stream), url, headers, body);
+template <typename Fn>
+void update_http_metrics(Fn&& fn) {
+  if (auto const m = http_metrics.load(); m != nullptr) {
+    fn(*m);
+  }
 }
 
-asio::awaitable<http_response> req_tls(
-    boost::urls::url const& url,
-    std::map<std::string, std::string> const& headers,
-    std::optional<std::string> const& body,
-    std::chrono::seconds const timeout,
-    std::optional<proxy> const& proxy) {
-  auto ssl_ctx = ssl::context{ssl::context::tls_client};
-  ssl_ctx.set_default_verify_paths();
-  ssl_ctx.set_verify_mode(ssl::verify_none);
-  ssl_ctx.set_options(ssl::context::default_workarounds |
-                      ssl::context::single_dh_use);
+// One TLS context for all requests: certificates are loaded only once and
+// sessions can be resumed.
+ssl::context& tls_context() {
+  static auto ctx = []() {
+    auto c = ssl::context{ssl::context::tls_client};
+    c.set_default_verify_paths();
+    c.set_verify_mode(ssl::verify_none);
+    c.set_options(ssl::context::default_workarounds |
+                  ssl::context::single_dh_use);
+    SSL_CTX_set_session_cache_mode(c.native_handle(), SSL_SESS_CACHE_CLIENT);
+    return c;
+  }();
+  return ctx;
+}
 
-  auto executor = co_await asio::this_coro::executor;
-  auto resolver = asio::ip::tcp::resolver{executor};
-  auto stream = ssl::stream<beast::tcp_stream>{executor, ssl_ctx};
+// Last TLS session per host to skip the full handshake on new connections.
+struct tls_sessions {
+  ~tls_sessions() {
+    for (auto const& [_, s] : sessions_) {
+      SSL_SESSION_free(s);
+    }
+  }
 
-  auto const host = proxy ? proxy->host_ : url.host();
-  auto const port =
-      proxy ? proxy->port_ : std::string{url.has_port() ? url.port() : "443"};
+  void apply(std::string const& key, SSL* ssl) {
+    auto const lock = std::scoped_lock{mutex_};
+    if (auto const it = sessions_.find(key); it != end(sessions_)) {
+      SSL_set_session(ssl, it->second);
+    }
+  }
 
-  if (!SSL_set_tlsext_host_name(stream.native_handle(),
-                                const_cast<char*>(host.c_str()))) {
-    throw boost::system::system_error{
-        {static_cast<int>(::ERR_get_error()), asio::error::get_ssl_category()}};
+  void store(std::string const& key, SSL* ssl) {
+    auto const s = SSL_get1_session(ssl);
+    if (s == nullptr) {
+      return;
+    }
+    auto const lock = std::scoped_lock{mutex_};
+    auto& entry = sessions_[key];
+    if (entry != nullptr) {
+      SSL_SESSION_free(entry);
+    }
+    entry = s;
   }
 
-  auto const results = co_await resolver.async_resolve(
-      host, port, asio::cancel_after(timeout, asio::use_awaitable));
+  std::mutex mutex_;
+  hash_map<std::string, SSL_SESSION*> sessions_;
+};
+
+tls_sessions& get_tls_sessions() {
+  static auto sessions = tls_sessions{};
+  return sessions;
+}
+
+// Idle keep-alive connections of one execution context. As asio service,
+// the pool is destroyed together with its execution context (e.g. private
+// io_contexts of one-off requests), so no socket outlives its executor.
+struct connection_pool : public asio::execution_context::service {
+  template <typename Stream>
+  struct idle_connection {
+    std::unique_ptr<Stream> stream_;
+    idle_clock_t::time_point since_;
+  };
+
+  template <typename Stream>
+  using idle_map_t =
+      hash_map<std::string, std::vector<idle_connection<Stream>>>;
 
-  stream.next_layer().expires_after(timeout);
+  static asio::execution_context::id id;
 
-  co_await beast::get_lowest_layer(stream).async_connect(results);
-  co_await stream.async_handshake(ssl::stream_base::client);
-  co_return co_await req(std::move(stream), url, headers, body);
+  explicit connection_pool(asio::execution_context& ctx)
+      : asio::execution_context::service{ctx} {}
+
+  template <typename Stream>
+  std::unique_ptr<Stream> get(std::string const& key) {
+    auto const lock = std::scoped_lock{mutex_};
+    auto const it = connections<Stream>().find(key);
+    if (it == end(connections<Stream>())) {
+      return nullptr;
+    }
+    auto& idle = it->second;
+    auto const now = idle_clock_t::now();
+    while (!idle.empty()) {
+      auto c = std::move(idle.back());
+      idle.pop_back();
+      if (now - c.since_ < kIdleConnectionTimeout) {
+        return std::move(c.stream_);
+      }
+    }
+    return nullptr;
+  }
+
+  template <typename Stream>
+  void put(std::string const& key, std::unique_ptr<Stream> stream) {
+    auto const lock = std::scoped_lock{mutex_};
+    auto& idle = connections<Stream>()[key];
+    auto const now = idle_clock_t::now();
+    std::erase_if(idle, [&](idle_connection<Stream> const& c) {
+      return now - c.since_ >= kIdleConnectionTimeout;
+    });
+    if (idle.size() < kMaxIdleConnectionsPerHost) {
+      idle.push_back({std::move(stream), now});
+    }
+  }
+
+private:
+  void shutdown() override {
+    auto const lock = std::scoped_lock{mutex_};
+    plain_.clear();
+    tls_.clear();
+  }
+
+  template <typename Stream>
+  idle_map_t<Stream>& connections() {
+    if constexpr (std::is_same_v<Stream, tls_stream>) {
+      return tls_;
+    } else {
+      return plain_;
+    }
+  }
+
+  std::mutex mutex_;
+  idle_map_t<beast::tcp_stream> plain_;
+  idle_map_t<tls_stream> tls_;
+};
+
+asio::execution_context::id connection_pool::id;
+
+// Responses with validators (ETag, Last-Modified) of GET requests. Requests
+// to the same URL are sent as conditional requests: "304 Not Modified"
+// answers are served from this cache.
+struct conditional_cache {
+  struct entry {
+    http_response res_;
+    std::size_t size_;
+  };
+
+  std::shared_ptr<entry const> get(std::string const& key) {
+    auto const lock = std::scoped_lock{mutex_};
+    auto const it = entries_.find(key);
+    return it == end(entries_) ? nullptr : it->second;
+  }
+
+  void put(std::string const& key, http_response const& res) {
+    auto const size = res.body().size();
+    auto const lock = std::scoped_lock{mutex_};
+    erase(key);
+    if (size > kMaxConditionalCacheEntrySize) {
+      return;
+    }
+    while (size_ + size > kMaxConditionalCacheSize && !order_.empty()) {
+      erase(order_.front());
+    }
+    entries_.emplace(key, std::make_shared<entry const>(res, size));
+    order_.push_back(key);
+    size_ += size;
+  }
+
+private:
+  // requires the lock
+  void erase(std::string const& key) {
+    if (auto const it = entries_.find(key); it != end(entries_)) {
+      size_ -= it->second->size_;
+      entries_.erase(it);
+      std::erase(order_, key);
+    }
+  }
+
+  std::mutex mutex_;
+  hash_map<std::string, std::shared_ptr<entry const>> entries_;
+  std::vector<std::string> order_;  // insertion order, oldest first
+  std::size_t size_{0U};
+};
+
+conditional_cache& get_conditional_cache() {
+  static auto cache = conditional_cache{};
+  return cache;
 }
 
 template <typename Stream>
 asio::awaitable<http_response> req(
-    Stream&& stream,
+    Stream& stream,
     boost::urls::url const& url,
     std::map<std::string, std::string> const& headers,
-    std::optional<std::string> const& body) {
+    std::optional<std::string> const& body,
+    bool& sent,
+    bool& got_response) {
   auto req = http::request<http::string_body>{
       body ? http::verb::post : http::verb::get, url.encoded_target(), 11};
   req.set(http::field::host, url.host());
@@ -112,37 +264,212 @@ asio::awaitable<http_response> req(
   }
 
   co_await http::async_write(stream, req);
+  sent = true;
 
   auto p = http::response_parser<http::dynamic_body>{};
   p.eager(true);
   p.body_limit(kBodySizeLimit);
 
   auto buffer = beast::flat_buffer{};
-  co_await http::async_read(stream, buffer, p);
-
-  auto ec = beast::error_code{};
-  beast::get_lowest_layer(stream).socket().shutdown(
-      asio::ip::tcp::socket::shutdown_both, ec);
+  auto const [ec, _] = co_await http::async_read(
+      stream, buffer, p, asio::as_tuple(asio::use_awaitable));
+  got_response = p.got_some();
+  if (ec) {
+    throw boost::system::system_error{ec};
+  }
   co_return p.release();
 }
 
-asio::awaitable<http::response<http::dynamic_body>> http_GET(
-    boost::urls::url url,
+template <typename Stream>
+asio::awaitable<std::unique_ptr<Stream>> connect(
+    std::string const& host,
+    std::string const& port,
+    std::string const& key,
+    std::chrono::seconds const timeout) {
+  auto executor = co_await asio::this_coro::executor;
+  auto resolver = asio::ip::tcp::resolver{executor};
+
+  auto stream = std::unique_ptr<Stream>{};
+  if constexpr (std::is_same_v<Stream, tls_stream>) {
+    stream = std::make_unique<tls_stream>(executor, tls_context());
+    if (!SSL_set_tlsext_host_name(stream->native_handle(),
+                                  const_cast<char*>(host.c_str()))) {
+      throw boost::system::system_error{{static_cast<int>(::ERR_get_error()),
+                                         asio::error::get_ssl_category()}};
+    }
+    get_tls_sessions().apply(key, stream->native_handle());
+  } else {
+    stream = std::make_unique<beast::tcp_stream>(executor);
+  }
+
+  auto const results = co_await resolver.async_resolve(
+      host, port, asio::cancel_after(timeout, asio::use_awaitable));
+
+  beast::get_lowest_layer(*stream).expires_after(timeout);
+  co_await beast::get_lowest_layer(*stream).async_connect(results);
+  if constexpr (std::is_same_v<Stream, tls_stream>) {
+    co_await stream->async_handshake(ssl::stream_base::client);
+  }
+  co_return stream;
+}
+
+// Keeps the connection for the next request to the same host if the server
+// allows it. TLS session tickets may arrive after the handshake, so the
+// session is stored after the response has been read.
+template <typename Stream>
+void release(connection_pool& pool,
+             std::string const& key,
+             std::unique_ptr<Stream> stream,
+             http_response const& res) {
+  if constexpr (std::is_same_v<Stream, tls_stream>) {
+    get_tls_sessions().store(key, stream->native_handle());
+  }
+  if (res.keep_alive() && !res.need_eof()) {
+    beast::get_lowest_layer(*stream).expires_never();
+    pool.put(key, std::move(stream));
+  }
+}
+
+template <typename Stream>
+asio::awaitable<http_response> pooled_req(
+    boost::urls::url const& url,
+    std::map<std::string, std::string> const& headers,
+    std::optional<std::string> const& body,
+    std::chrono::seconds const timeout,
+    std::optional<proxy> const& proxy) {
+  constexpr auto const kTls = std::is_same_v<Stream, tls_stream>;
+  auto const host = proxy ? proxy->host_ : std::string{url.host()};
+  auto const port = proxy ? proxy->port_
+                          : std::string{url.has_port() ? url.port()
+                                        : kTls        ? "443"
+                                                      : "80"};
+  auto const key = proxy ? fmt::format("{}:{}/{}", host, port, url.host())
+                         : fmt::format("{}:{}", host, port);
+
+  auto executor = co_await asio::this_coro::executor;
+  auto& pool = asio::use_service<connection_pool>(
+      asio::query(executor, asio::execution::context));
+
+  if (auto stream = pool.get<Stream>(key); stream != nullptr) {
+    auto res = std::optional<http_response>{};
+    auto sent = false;
+    auto got_response = false;
+    try {
+      beast::get_lowest_layer(*stream).expires_after(timeout);
+      res = co_await req(*stream, url, headers, body, sent, got_response);
+    } catch (boost::system::system_error const& e) {
+      // The server may have closed the idle connection. Retry with a new
+      // connection if the request could not be sent or - only for GET
+      // requests, POST requests are not idempotent - if the connection was
+      // closed without any response. Timeouts are not retried.
+      auto const closed_before_response = !body.has_value() && !got_response;
+      if (e.code() == beast::error::timeout ||
+          (sent && !closed_before_response)) {
+        throw;
+      }
+    }
+    if (res.has_value()) {
+      update_http_metrics([](metrics_registry const& m) {
+        m.http_connections_reused_.Increment();
+      });
+      release(pool, key, std::move(stream), *res);
+      co_return std::move(*res);
+    }
+  }
+
+  auto stream = co_await connect<Stream>(host, port, key, timeout);
+  update_http_metrics(
+      [](metrics_registry const& m) { m.http_connections_new_.Increment(); });
+  auto sent = false;
+  auto got_response = false;
+  auto res = co_await req(*stream, url, headers, body, sent, got_response);
+  release(pool, key, std::move(stream), res);
+  co_return res;
+}
+
+asio::awaitable<http_response> pooled_req(
+    boost::urls::url const& url,
     std::map<std::string, std::string> const& headers,
+    std::optional<std::string> const& body,
     std::chrono::seconds const timeout,
     std::optional<proxy> const& proxy) {
+  auto const use_tls = proxy.has_value()
+                           ? proxy->use_tls_
+                           : url.scheme_id() == boost::urls::scheme::https;
+  co_return co_await (
+      use_tls ? pooled_req<tls_stream>(url, headers, body, timeout, proxy)
+              : pooled_req<beast::tcp_stream>(url, headers, body, timeout,
+                                              proxy));
+}
+
+// Returns std::nullopt instead of the cached response for "304 Not Modified"
+// answers if `skip_unchanged` is set.
+asio::awaitable<std::optional<http_response>> conditional_GET(
+    boost::urls::url const& url,
+    std::map<std::string, std::string> const& headers,
+    std::chrono::seconds const timeout,
+    std::optional<proxy> const& proxy,
+    bool const skip_unchanged) {
+  if (headers.contains("If-None-Match") ||
+      headers.contains("If-Modified-Since")) {
+    co_return co_await pooled_req(url, headers, std::nullopt, timeout, proxy);
+  }
+
+  auto key = std::string{url.buffer()};
+  for (auto const& [k, v] : headers) {
+    key += fmt::format("\n{}: {}", k, v);
+  }
+
+  auto& cache = get_conditional_cache();
+  auto const cached = cache.get(key);
+  auto conditional_headers = headers;
+  if (cached != nullptr) {
+    if (auto const etag = cached->res_[http::field::etag]; !etag.empty()) {
+      conditional_headers.emplace("If-None-Match", std::string{etag});
+    }
+    if (auto const last_modified = cached->res_[http::field::last_modified];
+        !last_modified.empty()) {
+      conditional_headers.emplace("If-Modified-Since", last_modified);
+    }
+  }
+
+  auto res = co_await pooled_req(url, conditional_headers, std::nullopt,
+                                 timeout, proxy);
+  if (cached != nullptr) {
+    auto const not_modified = res.result() == http::status::not_modified;
+    update_http_metrics([&](metrics_registry const& m) {
+      (not_modified ? m.http_not_modified_ : m.http_modified_).Increment();
+    });
+    if (not_modified) {
+      co_return skip_unchanged ? std::nullopt
+                               : std::optional<http_response>{cached->res_};
+    }
+  }
+  if (res.result() == http::status::ok &&
+      (res.count(http::field::etag) != 0U ||
+       res.count(http::field::last_modified) != 0U)) {
+    cache.put(key, res);
+  }
+  co_return res;
+}
+
+asio::awaitable<std::optional<http_response>> follow_GET(
+    boost::urls::url const& url,
+    std::map<std::string, std::string> const& headers,
+    std::chrono::seconds const timeout,
+    std::optional<proxy> const& proxy,
+    bool const skip_unchanged) {
   auto n_redirects = 0U;
   auto next_url = url;
   while (n_redirects < 3U) {
-    auto const use_tls =
-        proxy.has_value() ? proxy->use_tls_
-                          : next_url.scheme_id() == boost::urls::scheme::https;
-    auto const res = co_await (
-        use_tls ? req_tls(next_url, headers, std::nullopt, timeout, proxy)
-                : req_no_tls(next_url, headers, std::nullopt, timeout, proxy));
-    auto const code = res.base().result_int();
-    if (code >= 300 && code < 400) {
-      next_url = boost::urls::url{res.base()["Location"]};
+    auto res = co_await conditional_GET(next_url, headers, timeout, proxy,
+                                        skip_unchanged);
+    if (!res.has_value()) {
+      co_return std::nullopt;
+    }
+    auto const code = res->base().result_int();
+    if (code >= 300 && code < 400 && code != 304) {
+      next_url = boost::urls::url{res->base()["Location"]};
       ++n_redirects;
       continue;
     } else {
@@ -153,6 +480,23 @@ asio::awaitable<http::response<http::dynamic_body>> http_GET(
                   fmt::streamed(url), fmt::streamed(next_url));
 }
 
+asio::awaitable<http::response<http::dynamic_body>> http_GET(
+    boost::urls::url url,
+    std::map<std::string, std::string> const& headers,
+    std::chrono::seconds const timeout,
+    std::optional<proxy> const& proxy) {
+  co_return std::move(
+      *co_await follow_GET(url, headers, timeout, proxy, false));
+}
+
+asio::awaitable<std::optional<http_response>> http_GET_if_modified(
+    boost::urls::url url,
+    std::map<std::string, std::string> const& headers,
+    std::chrono::seconds const timeout,
+    std::optional<proxy> const& proxy) {
+  co_return co_await follow_GET(url, headers, timeout, proxy, true);
+}
+
 asio::awaitable<http::response<http::dynamic_body>> http_POST(
     boost::urls::url url,
     std::map<std::string, std::string> const& headers,
@@ -162,12 +506,8 @@ asio::awaitable<http::response<http::dynamic_body>> http_POST(
   auto n_redirects = 0U;
   auto next_url = url;
   while (n_redirects < 3U) {
-    auto const use_tls =
-        proxy.has_value() ? proxy->use_tls_
-                          : next_url.scheme_id() == boost::urls::scheme::https;
-    auto const res = co_await (
-        use_tls ? req_tls(next_url, headers, body, timeout, proxy)
-                : req_no_tls(next_url, headers, body, timeout, proxy));
+    auto const res =
+        co_await pooled_req(next_url, headers, body, timeout, proxy);
     auto const code = res.base().result_int();
     if (code >= 300 && code < 400) {
       next_url = boost::urls::url{res.base()["Location"]};
@@ -1,11 +1,21 @@
 #include "motis/import.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <fstream>
 #include <map>
+#include <mutex>
+#include <optional>
 #include <ostream>
+#include <thread>
 #include <tuple>
 #include <vector>
 
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
 #include "fmt/ranges.h"
 
 #include "cista/free_self_allocated.h"
@@ -50,8 +60,11 @@
 #include "motis/clog_redirect.h"
 #include "motis/compute_footpaths.h"
 #include "motis/data.h"
+#include "motis/elevators/match_elevator.h"
 #include "motis/hashes.h"
+#include "motis/railviz.h"
 #include "motis/route_shapes.h"
+#include "motis/startup_indices.h"
 #include "motis/tag_lookup.h"
 #include "motis/tt_location_rtree.h"
 
@@ -111,7 +124,6 @@ struct task {
     write_hashes(data_path, name_, hashes_);
     pt->out_ = 100;
     pt->status("FINISHED");
-    done_ = true;
   }
 
   std::string name_;
@@ -121,8 +133,24 @@ struct task {
   meta_t hashes_;
   bool done_{false};
   utl::progress_tracker_ptr pt_{};
+  config::import::budget budget_{};
+  std::chrono::steady_clock::time_point start_{};
+  std::size_t peak_rss_mb_{0U};  // whole process while the task runs
 };
 
+std::size_t current_rss_mb() {
+#if defined(__linux__)
+  auto statm = std::ifstream{"/proc/self/statm"};
+  auto size = std::size_t{0U};
+  auto resident = std::size_t{0U};
+  statm >> size >> resident;
+  return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) /
+         (1024U * 1024U);
+#else
+  return 0U;
+#endif
+}
+
 }  // namespace motis
 
 template <>
@@ -495,13 +523,25 @@ void import(config const& c,
                  return d.tt_->has_car_transport(r);
                });
              }}};
+        auto const checkpoints_dir = data_path / "osr_footpath_checkpoints";
+        auto const checkpoints =
+            c.import_.has_value() && c.import_->footpath_checkpoints_
+                ? std::optional{footpath_checkpoints{
+                      .dir_ = checkpoints_dir,
+                      .key_ = cista::hash_combine(
+                          tt_hash.second, osm_hash.second,
+                          osr_footpath_settings_hash.second,
+                          osr_version().second,
+                          osr_footpath_version().second, n_version().second)}}
+                : std::nullopt;
         auto const elevator_footpath_map = compute_footpaths(
             *d.w_, *d.l_, *d.pl_, *d.tt_, d.elevations_.get(),
-            c.timetable_->use_osm_stop_coordinates_, profiles);
+            c.timetable_->use_osm_stop_coordinates_, profiles, checkpoints);
 
         cista::write(data_path / "elevator_footpath_map.bin",
                      elevator_footpath_map);
         d.tt_->write(data_path / "tt_ext.bin");
+        fs::remove_all(checkpoints_dir);
 
         cista::free_self_allocated(d.tt_.get());
       },
@@ -583,6 +623,46 @@ void import(config const& c,
             .route_shapes_.value_or(config::timetable::route_shapes{})
             .cache_reuse_old_osm_data_}}};
 
+  auto indices_hashes = meta_t{indices_version()};
+  for (auto const* dep : {&tt, &osr, &osr_footpath, &route_shapes_task}) {
+    if (dep->should_run_) {
+      indices_hashes.insert(begin(dep->hashes_), end(dep->hashes_));
+    }
+  }
+  indices_hashes.emplace(
+      "railviz", c.timetable_.has_value() && c.timetable_->railviz_);
+  auto indices = task{
+      "indices",
+      {&tt, &osr, &osr_footpath, &route_shapes_task},
+      c.timetable_.has_value() || c.use_street_routing(),
+      [&]() {
+        // Built from the imported data only: `data` would load the
+        // (possibly outdated) indices this task replaces.
+        if (c.timetable_) {
+          auto const tt_file = c.osr_footpath_ ? "tt_ext.bin" : "tt.bin";
+          auto timetable = n::timetable::read(data_path / tt_file);
+          timetable->resolve();
+          write_mapped(location_rtree_path(data_path, tt_file),
+                       create_location_rtree(*timetable));
+          if (c.timetable_->railviz_) {
+            auto const shapes =
+                c.timetable_->with_shapes_
+                    ? std::make_unique<n::shapes_storage>(
+                          data_path, cista::mmap::protection::READ)
+                    : nullptr;
+            railviz_static_index{*timetable, shapes.get()}.write(
+                railviz_static_path(data_path));
+          }
+        }
+        if (c.use_street_routing()) {
+          auto const w =
+              osr::ways{data_path / "osr", cista::mmap::protection::READ};
+          write_elevator_nodes(elevator_nodes_path(data_path),
+                               get_elevator_nodes(w));
+        }
+      },
+      std::move(indices_hashes)};
+
   auto tiles = task{
       "tiles",
       {},
@@ -630,9 +710,11 @@ void import(config const& c,
       },
       {tiles_version(), osm_hash, tiles_hash}};
 
-  auto all_tasks = std::vector{&tiles,        &osr,     &adr,
-                               &tt,           &tbd,     &adr_extend,
-                               &osr_footpath, &matches, &route_shapes_task};
+  auto all_tasks =
+      std::vector{&tiles,        &osr,     &adr,
+                  &tt,           &tbd,     &adr_extend,
+                  &osr_footpath, &matches, &route_shapes_task,
+                  &indices};
   auto todo = std::set<task*>{};
   if (task_filter.has_value()) {
     auto q = std::vector<task*>{};
@@ -673,17 +755,127 @@ void import(config const& c,
     t->pt_ = utl::activate_progress_tracker(t->name_);
   }
 
-  while (!tasks.empty()) {
-    auto const task_it = utl::find_if(tasks, [](task const* t) {
-      return utl::all_of(t->dependencies_,
-                         [](task const* t) { return t->done_; });
-    });
-    utl::verify(
-        task_it != end(tasks), "no task to run, remaining tasks: {}",
-        tasks | std::views::transform([](task const* t) { return *t; }));
-    (*task_it)->run(data_path);
-    tasks.erase(task_it);
+  // Run all tasks whose dependencies are done in parallel as long as their
+  // budgets fit. A task is always started if no other task is running.
+  // Tasks without a configured budget claim all threads, so tasks only run
+  // in parallel if `import.tasks` explicitly limits them. Budgets are only
+  // used for admission: the tasks' thread pools and allocations are not
+  // capped, so a budget has to be an estimate of what the task really uses.
+  // Note that progress tracking and RSS are process-global: with parallel
+  // tasks, the displayed progress and memory are only an indication.
+  auto const import_config = c.import_.value_or(config::import{});
+  auto const max_threads =
+      import_config.n_threads_ == 0U
+          ? std::max(1U, std::thread::hardware_concurrency())
+          : import_config.n_threads_;
+  for (auto const& [name, budget] : import_config.tasks_) {
+    auto const it =
+        utl::find_if(all_tasks, [&](task* t) { return t->name_ == name; });
+    utl::verify(it != end(all_tasks), "import budget: unknown task {}", name);
+    (*it)->budget_ = budget;
+  }
+
+  auto m = std::mutex{};
+  auto cv = std::condition_variable{};
+  auto running = std::vector<task*>{};
+  auto workers = std::vector<std::thread>{};
+  auto error = std::exception_ptr{};
+  auto used_threads = 0U;
+  auto used_memory_mb = std::size_t{0U};
+  auto stop = false;
+
+  auto const threads = [&](task const* t) {
+    return t->budget_.n_threads_ == 0U
+               ? max_threads
+               : std::min(t->budget_.n_threads_, max_threads);
+  };
+
+  auto const fits = [&](task const* t) {
+    return running.empty() ||
+           (used_threads + threads(t) <= max_threads &&
+            (import_config.memory_mb_ == 0U ||
+             used_memory_mb + t->budget_.memory_mb_ <=
+                 import_config.memory_mb_));
+  };
+
+  auto const finish = [&](task* t, std::exception_ptr const& e) {
+    auto const lock = std::lock_guard{m};
+    auto const wall_time = std::chrono::duration<double>{
+        std::chrono::steady_clock::now() - t->start_};
+    fmt::println("{} {} after {:.1f}s, process peak RSS at task end {} MB",
+                 t->name_, e == nullptr ? "finished" : "failed",
+                 wall_time.count(),
+                 std::max(t->peak_rss_mb_, current_rss_mb()));
+    if (e == nullptr) {
+      t->done_ = true;
+    } else if (error == nullptr) {
+      error = e;
+    }
+    used_threads -= threads(t);
+    used_memory_mb -= t->budget_.memory_mb_;
+    std::erase(running, t);
+    cv.notify_all();
+  };
+
+  auto rss_sampler = std::thread{[&]() {
+    auto lock = std::unique_lock{m};
+    while (!stop) {
+      auto const rss = current_rss_mb();
+      for (auto* t : running) {
+        t->peak_rss_mb_ = std::max(t->peak_rss_mb_, rss);
+      }
+      cv.wait_for(lock, std::chrono::milliseconds{250});
+    }
+  }};
+
+  {
+    auto lock = std::unique_lock{m};
+    while (true) {
+      for (auto it = begin(tasks); error == nullptr && it != end(tasks);) {
+        auto* t = *it;
+        if (!utl::all_of(t->dependencies_,
+                         [](task const* dep) { return dep->done_; }) ||
+            !fits(t)) {
+          ++it;
+          continue;
+        }
+
+        it = tasks.erase(it);
+        used_threads += threads(t);
+        used_memory_mb += t->budget_.memory_mb_;
+        t->start_ = std::chrono::steady_clock::now();
+        t->peak_rss_mb_ = current_rss_mb();
+        running.push_back(t);
+        workers.emplace_back([&, t]() {
+          try {
+            t->run(data_path);
+            finish(t, nullptr);
+          } catch (...) {
+            finish(t, std::current_exception());
+          }
+        });
+      }
+
+      if (running.empty()) {
+        break;
+      }
+      cv.wait(lock);
+    }
+    stop = true;
+  }
+  cv.notify_all();
+
+  rss_sampler.join();
+  for (auto& w : workers) {
+    w.join();
+  }
+
+  if (error != nullptr) {
+    std::rethrow_exception(error);
   }
+  utl::verify(
+      tasks.empty(), "no task to run, remaining tasks: {}",
+      tasks | std::views::transform([](task const* t) { return *t; }));
 }
 
 }  // namespace motis
@@ -7,6 +7,7 @@
 
 #include "utl/enumerate.h"
 #include "utl/overloaded.h"
+#include "utl/timing.h"
 #include "utl/visit.h"
 
 #include "geo/polyline_format.h"
@@ -204,7 +205,8 @@ api::Itinerary journey_to_response(
     bool const ignore_dest_rental_return_constraints,
     n::lang_t const& lang,
     bool const set_itinerary_id_field,
-    alternatives_context const& alternatives) {
+    alternatives_context const& alternatives,
+    std::vector<std::uint64_t>* leg_ms) {
   auto const itinerary_start_time = j_in.legs_.front().dep_time_;
   auto const itinerary_end_time = j_in.legs_.back().arr_time_;
   auto j = j_in;
@@ -383,6 +385,7 @@ api::Itinerary journey_to_response(
   };
 
   for (auto const [j_leg_idx, j_leg] : utl::enumerate(j.legs_)) {
+    UTL_START_TIMING(leg);
     auto const pred =
         itinerary.legs_.empty() ? nullptr : &itinerary.legs_.back();
     auto const fallback_tz =
@@ -674,6 +677,9 @@ api::Itinerary journey_to_response(
                       std::chrono::minutes{5}));
             }},
         j_leg.uses_);
+    if (leg_ms != nullptr) {
+      leg_ms->push_back(UTL_GET_TIMING_MS(leg));
+    }
   }
 
   cleanup_intermodal(itinerary);
@@ -134,7 +134,107 @@ metrics_registry::metrics_registry(
                        .Help("Timestamp of last RT, GBFS, Elevator updates")
                        .Register(registry_)},
       last_update_rt_{last_update_.Add({{"feed", "rt"}})},
-      last_update_gbfs_{last_update_.Add({{"feed", "gbfs"}})} {}
+      last_update_gbfs_{last_update_.Add({{"feed", "gbfs"}})},
+      offsets_cache_invalidations_{
+          prometheus::BuildCounter()
+              .Name("motis_offsets_cache_invalidations_total")
+              .Help("Number of street offsets cache entries dropped due to "
+                    "real-time updates")
+              .Register(registry_)
+              .Add({})},
+      rt_snapshot_build_duration_seconds_{
+          prometheus::BuildHistogram()
+              .Name("motis_rt_snapshot_build_duration_seconds")
+              .Help("Duration of building a new real-time snapshot")
+              .Register(registry_)},
+      rt_snapshot_build_duration_seconds_copy_{
+          rt_snapshot_build_duration_seconds_.Add({{"stage", "copy"}},
+                                                  time_boundaries)},
+      rt_snapshot_build_duration_seconds_apply_{
+          rt_snapshot_build_duration_seconds_.Add({{"stage", "apply"}},
+                                                  time_boundaries)},
+      rt_snapshot_build_duration_seconds_index_{
+          rt_snapshot_build_duration_seconds_.Add({{"stage", "index"}},
+                                                  time_boundaries)},
+      rt_snapshot_build_duration_seconds_total_{
+          rt_snapshot_build_duration_seconds_.Add({{"stage", "total"}},
+                                                  time_boundaries)},
+      rt_snapshot_transports_copied_{
+          prometheus::BuildCounter()
+              .Name("motis_rt_snapshot_transports_copied_total")
+              .Help("Number of real-time transports copied from the previous "
+                    "real-time snapshot")
+              .Register(registry_)
+              .Add({})},
+      rt_snapshot_reused_{
+          prometheus::BuildCounter()
+              .Name("motis_rt_snapshot_reused_total")
+              .Help("Number of real-time snapshots built into the memory of "
+                    "an unused previous snapshot")
+              .Register(registry_)
+              .Add({})},
+      request_queue_depth_{
+          prometheus::BuildGauge()
+              .Name("motis_request_queue_depth")
+              .Help("Number of requests waiting to be executed")
+              .Register(registry_)},
+      requests_running_{prometheus::BuildGauge()
+                            .Name("motis_requests_running")
+                            .Help("Number of requests currently executed")
+                            .Register(registry_)},
+      request_queue_wait_seconds_{
+          prometheus::BuildHistogram()
+              .Name("motis_request_queue_wait_seconds")
+              .Help("Time requests spent waiting in the queue")
+              .Register(registry_)},
+      requests_rejected_{
+          prometheus::BuildCounter()
+              .Name("motis_requests_rejected_total")
+              .Help("Number of requests rejected because the queue was full")
+              .Register(registry_)},
+      cache_requests_{prometheus::BuildCounter()
+                          .Name("motis_cache_requests_total")
+                          .Help("Number of cache lookups")
+                          .Register(registry_)},
+      cache_evictions_{
+          prometheus::BuildCounter()
+              .Name("motis_cache_evictions_total")
+              .Help("Number of cache entries evicted due to the size limit")
+              .Register(registry_)},
+      gbfs_provider_update_seconds_{
+          prometheus::BuildGauge()
+              .Name("motis_gbfs_provider_update_seconds")
+              .Help("Duration of the last update of a GBFS provider (download, "
+                    "parsing and street network mapping)")
+              .Register(registry_)},
+      gbfs_osr_mapping_{
+          prometheus::BuildCounter()
+              .Name("motis_gbfs_osr_mapping_total")
+              .Help("Number of GBFS geofencing products and station/vehicle "
+                    "locations mapped to the street network")
+              .Register(registry_)},
+      http_connections_{
+          prometheus::BuildCounter()
+              .Name("motis_http_connections_total")
+              .Help("Number of outgoing HTTP requests by connection (new or "
+                    "reused keep-alive connection)")
+              .Register(registry_)},
+      http_connections_new_{http_connections_.Add({{"result", "new"}})},
+      http_connections_reused_{http_connections_.Add({{"result", "reused"}})},
+      http_conditional_requests_{
+          prometheus::BuildCounter()
+              .Name("motis_http_conditional_requests_total")
+              .Help("Number of outgoing conditional HTTP GET requests")
+              .Register(registry_)},
+      http_not_modified_{
+          http_conditional_requests_.Add({{"result", "not_modified"}})},
+      http_modified_{
+          http_conditional_requests_.Add({{"result", "modified"}})},
+      tiles_render_duration_seconds_{
+          prometheus::BuildHistogram()
+              .Name("motis_tiles_render_duration_seconds")
+              .Help("Duration of rendering a vector tile (cache misses)")
+              .Register(registry_)} {}
 
 metrics_registry::~metrics_registry() = default;
 
@@ -1,16 +1,11 @@
 #include "motis/odm/prima.h"
 
-#include "boost/asio/co_spawn.hpp"
-#include "boost/asio/detached.hpp"
-#include "boost/asio/io_context.hpp"
 #include "boost/json.hpp"
 
 #include "nigiri/timetable.h"
 
 #include "utl/erase_if.h"
 
-#include "motis/http_req.h"
-
 namespace n = nigiri;
 namespace json = boost::json;
 using namespace std::chrono_literals;
@@ -96,33 +91,23 @@ bool prima::consume_blacklist_taxi_response(std::string_view json) {
   return true;
 }
 
+std::function<bool()> prima::blacklist_taxi_async(
+    n::timetable const& tt, n::interval<n::unixtime_t> const& taxi_intvl) {
+  n::log(n::log_lvl::debug, "motis.prima", "[blacklist taxi] request for {}",
+         taxi_intvl);
+  auto response =
+      prima_post(taxi_blacklist_, make_blacklist_taxi_request(tt, taxi_intvl),
+                 10s, "blacklist taxi");
+  return [this, response = std::move(response)]() {
+    auto const blacklist_response = response();
+    return blacklist_response.has_value() &&
+           consume_blacklist_taxi_response(*blacklist_response);
+  };
+}
+
 bool prima::blacklist_taxi(n::timetable const& tt,
                            n::interval<n::unixtime_t> const& taxi_intvl) {
-  auto blacklist_response = std::optional<std::string>{};
-  auto ioc = boost::asio::io_context{};
-  try {
-    n::log(n::log_lvl::debug, "motis.prima", "[blacklist taxi] request for {}",
-           taxi_intvl);
-    boost::asio::co_spawn(
-        ioc,
-        [&]() -> boost::asio::awaitable<void> {
-          auto const prima_msg = co_await http_POST(
-              taxi_blacklist_, kReqHeaders,
-              make_blacklist_taxi_request(tt, taxi_intvl), 10s);
-          blacklist_response = get_http_body(prima_msg);
-        },
-        boost::asio::detached);
-    ioc.run();
-  } catch (std::exception const& e) {
-    n::log(n::log_lvl::debug, "motis.prima",
-           "[blacklist taxi] networking failed: {}", e.what());
-    blacklist_response = std::nullopt;
-  }
-  if (!blacklist_response) {
-    return false;
-  }
-
-  return consume_blacklist_taxi_response(*blacklist_response);
+  return blacklist_taxi_async(tt, taxi_intvl)();
 }
 
 }  // namespace motis::odm
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "motis/odm/meta_router.h"
 
+#include <exception>
 #include <vector>
 
 #include "boost/asio/io_context.hpp"
@@ -199,26 +200,19 @@ n::routing::query meta_router::get_base_query(
                              : std::optional{fastest_direct_}};
 }
 
-std::vector<meta_router::routing_result> meta_router::search_interval(
-    std::vector<n::routing::query> const& sub_queries) const {
-  auto const tasks = utl::to_vec(sub_queries, [&](n::routing::query const& q) {
-    auto fn = [&, q = std::move(q)]() mutable {
-      auto const timeout = std::chrono::seconds{query_.timeout_.value_or(
-          r_.config_.get_limits().routing_max_timeout_seconds_)};
-      auto search_state = n::routing::search_state{};
-      auto raptor_state = n::routing::raptor_state{};
-      return routing_result{raptor_search(
-          *tt_, rtt_, search_state, raptor_state, std::move(q),
-          query_.arriveBy_ ? n::direction::kBackward : n::direction::kForward,
-          timeout)};
-    };
-    return ctx_call(ctx_data{}, std::move(fn));
-  });
-  return utl::to_vec(
-      tasks,
-      [](ctx::future_ptr<ctx_data, meta_router::routing_result> const& t) {
-        return t->val();
-      });
+ctx::future_ptr<ctx_data, meta_router::routing_result>
+meta_router::search_interval(n::routing::query q) const {
+  auto fn = [&, q = std::move(q)]() mutable {
+    auto const timeout = std::chrono::seconds{query_.timeout_.value_or(
+        r_.config_.get_limits().routing_max_timeout_seconds_)};
+    auto search_state = n::routing::search_state{};
+    auto raptor_state = n::routing::raptor_state{};
+    return routing_result{raptor_search(
+        *tt_, rtt_, search_state, raptor_state, std::move(q),
+        query_.arriveBy_ ? n::direction::kBackward : n::direction::kForward,
+        timeout)};
+  };
+  return ctx_call(ctx_data{}, std::move(fn));
 }
 
 std::vector<n::routing::journey> collect_odm_journeys(
@@ -326,35 +320,13 @@ api::plan_response meta_router::run() {
                   p.direct_taxi_.size()),
       r_.metrics_->routing_execution_duration_seconds_init_);
 
-  auto const blacklist_start = std::chrono::steady_clock::now();
-  auto const blacklisted_taxis = p.blacklist_taxi(*tt_, taxi_intvl);
-  print_time(blacklist_start,
-             fmt::format("[blacklist taxi] (#first_mile_offsets: {}, "
-                         "#last_mile_offsets: {}, #direct_rides: {})",
-                         p.first_mile_taxi_.size(), p.last_mile_taxi_.size(),
-                         p.direct_taxi_.size()),
-             r_.metrics_->routing_execution_duration_seconds_blacklisting_);
-
-  auto const whitelist_ride_sharing_start = std::chrono::steady_clock::now();
-  auto const whitelisted_ride_sharing = p.whitelist_ride_sharing(*tt_);
-  n::log(n::log_lvl::debug, "motis.prima",
-         "[whitelist ride-sharing] ride-sharing events after whitelisting: {}",
-         p.n_ride_sharing_events());
-  print_time(
-      whitelist_ride_sharing_start,
-      fmt::format("[whitelist ride-sharing] (#first_mile_ride_sharing: {}, "
-                  "#last_mile_ride_sharing: {}, #direct_ride_sharing: {})",
-                  p.first_mile_ride_sharing_.size(),
-                  p.last_mile_ride_sharing_.size(),
-                  p.direct_ride_sharing_.size()),
-      r_.metrics_->routing_execution_duration_seconds_blacklisting_);
+  // The taxi blacklist and the ride-sharing whitelist are independent. Both
+  // requests are in flight while the walking offsets are computed and the
+  // PT-only search runs. Waiting for PRIMA suspends this operation only.
+  auto const blacklist_taxi = p.blacklist_taxi_async(*tt_, taxi_intvl);
+  auto const whitelist_ride_sharing = p.whitelist_ride_sharing_async(*tt_);
 
   auto const prep_queries_start = std::chrono::steady_clock::now();
-  auto const [first_mile_taxi_short, first_mile_taxi_long] =
-      get_td_offsets_split(p.first_mile_taxi_, p.first_mile_taxi_times_,
-                           kOdmTransportModeId);
-  auto const [last_mile_taxi_short, last_mile_taxi_long] = get_td_offsets_split(
-      p.last_mile_taxi_, p.last_mile_taxi_times_, kOdmTransportModeId);
   auto const params = get_osr_parameters(query_);
   auto const pre_transit_time = std::min(
       std::chrono::seconds{query_.maxPreTransitTime_},
@@ -364,7 +336,7 @@ api::plan_response meta_router::run() {
       std::chrono::seconds{query_.maxPostTransitTime_},
       std::chrono::seconds{
           r_.config_.get_limits().street_routing_max_prepost_transit_seconds_});
-  auto const qf = query_factory{
+  auto qf = query_factory{
       .base_query_ = get_base_query(context_intvl),
       .start_walk_ = r_.get_offsets(
           rtt_, start_,
@@ -403,34 +375,106 @@ api::plan_response meta_router::run() {
           dest_modes_, params, query_.pedestrianProfile_,
           query_.elevationCosts_, query_.maxMatchingDistance_,
           query_.arriveBy_ ? pre_transit_time : post_transit_time,
-          context_intvl, prepare_stats),
-      .start_taxi_short_ =
-          query_.arriveBy_ ? last_mile_taxi_short : first_mile_taxi_short,
-      .start_taxi_long_ =
-          query_.arriveBy_ ? last_mile_taxi_long : first_mile_taxi_long,
-      .dest_taxi_short_ =
-          query_.arriveBy_ ? first_mile_taxi_short : last_mile_taxi_short,
-      .dest_taxi_long_ =
-          query_.arriveBy_ ? first_mile_taxi_long : last_mile_taxi_long,
-      .start_ride_sharing_ = query_.arriveBy_
-                                 ? get_td_offsets(p.last_mile_ride_sharing_,
-                                                  kRideSharingTransportModeId)
-                                 : get_td_offsets(p.first_mile_ride_sharing_,
-                                                  kRideSharingTransportModeId),
-      .dest_ride_sharing_ = query_.arriveBy_
-                                ? get_td_offsets(p.first_mile_ride_sharing_,
-                                                 kRideSharingTransportModeId)
-                                : get_td_offsets(p.last_mile_ride_sharing_,
-                                                 kRideSharingTransportModeId)};
+          context_intvl, prepare_stats)};
   print_time(prep_queries_start, "[prepare queries]",
              r_.metrics_->routing_execution_duration_seconds_preparing_);
 
+  // The PT-only query doesn't depend on PRIMA. Searches reference this
+  // meta_router: all started searches are awaited before an exception
+  // leaves run().
   auto const routing_start = std::chrono::steady_clock::now();
-  auto sub_queries =
-      qf.make_queries(blacklisted_taxis, whitelisted_ride_sharing);
-  n::log(n::log_lvl::debug, "motis.prima",
-         "[prepare queries] {} queries prepared", sub_queries.size());
-  auto const results = search_interval(sub_queries);
+  auto pt_query = qf.make_queries(false, false);
+  auto searches = std::vector<ctx::future_ptr<ctx_data, routing_result>>{};
+  searches.emplace_back(search_interval(std::move(pt_query.front())));
+  auto const await_searches = [&]() {
+    auto results = std::vector<routing_result>{};
+    auto error = std::exception_ptr{};
+    for (auto const& search : searches) {
+      try {
+        results.emplace_back(search->val());
+      } catch (...) {
+        if (!error) {
+          error = std::current_exception();
+        }
+      }
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return results;
+  };
+
+  auto whitelisted_ride_sharing = false;
+  try {
+    // Only the time spent waiting for PRIMA delays routing: the blacklisting
+    // metric covers the wait for each response, not the request in flight.
+    auto const blacklist_start = std::chrono::steady_clock::now();
+    auto const blacklisted_taxis = blacklist_taxi();
+    print_time(blacklist_start,
+               fmt::format("[blacklist taxi] (#first_mile_offsets: {}, "
+                           "#last_mile_offsets: {}, #direct_rides: {})",
+                           p.first_mile_taxi_.size(), p.last_mile_taxi_.size(),
+                           p.direct_taxi_.size()),
+               r_.metrics_->routing_execution_duration_seconds_blacklisting_);
+
+    auto const whitelist_ride_sharing_start = std::chrono::steady_clock::now();
+    whitelisted_ride_sharing = whitelist_ride_sharing();
+    n::log(n::log_lvl::debug, "motis.prima",
+           "[whitelist ride-sharing] ride-sharing events after "
+           "whitelisting: {}",
+           p.n_ride_sharing_events());
+    print_time(
+        whitelist_ride_sharing_start,
+        fmt::format("[whitelist ride-sharing] (#first_mile_ride_sharing: {}, "
+                    "#last_mile_ride_sharing: {}, #direct_ride_sharing: {})",
+                    p.first_mile_ride_sharing_.size(),
+                    p.last_mile_ride_sharing_.size(),
+                    p.direct_ride_sharing_.size()),
+        r_.metrics_->routing_execution_duration_seconds_blacklisting_);
+
+    auto const [first_mile_taxi_short, first_mile_taxi_long] =
+        get_td_offsets_split(p.first_mile_taxi_, p.first_mile_taxi_times_,
+                             kOdmTransportModeId);
+    auto const [last_mile_taxi_short, last_mile_taxi_long] =
+        get_td_offsets_split(p.last_mile_taxi_, p.last_mile_taxi_times_,
+                             kOdmTransportModeId);
+    qf.start_taxi_short_ =
+        query_.arriveBy_ ? last_mile_taxi_short : first_mile_taxi_short;
+    qf.start_taxi_long_ =
+        query_.arriveBy_ ? last_mile_taxi_long : first_mile_taxi_long;
+    qf.dest_taxi_short_ =
+        query_.arriveBy_ ? first_mile_taxi_short : last_mile_taxi_short;
+    qf.dest_taxi_long_ =
+        query_.arriveBy_ ? first_mile_taxi_long : last_mile_taxi_long;
+    qf.start_ride_sharing_ =
+        query_.arriveBy_
+            ? get_td_offsets(p.last_mile_ride_sharing_,
+                             kRideSharingTransportModeId)
+            : get_td_offsets(p.first_mile_ride_sharing_,
+                             kRideSharingTransportModeId);
+    qf.dest_ride_sharing_ =
+        query_.arriveBy_
+            ? get_td_offsets(p.first_mile_ride_sharing_,
+                             kRideSharingTransportModeId)
+            : get_td_offsets(p.last_mile_ride_sharing_,
+                             kRideSharingTransportModeId);
+
+    auto sub_queries =
+        qf.make_queries(blacklisted_taxis, whitelisted_ride_sharing);
+    n::log(n::log_lvl::debug, "motis.prima",
+           "[prepare queries] {} queries prepared", sub_queries.size());
+    searches.reserve(sub_queries.size());
+    for (auto& q : sub_queries | std::views::drop(1)) {
+      searches.emplace_back(search_interval(std::move(q)));
+    }
+  } catch (...) {
+    try {
+      await_searches();
+    } catch (...) {
+    }
+    throw;
+  }
+  auto const results = await_searches();
   utl::verify(!results.empty(), "prima: public transport result expected");
   auto const& pt_result = results.front();
   auto taxi_journeys = collect_odm_journeys(results, kOdmTransportModeId);
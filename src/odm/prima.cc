@@ -1,10 +1,15 @@
 #include "motis/odm/prima.h"
 
+#include <exception>
+#include <memory>
 #include <variant>
 
+#include "boost/asio/co_spawn.hpp"
 #include "boost/asio/io_context.hpp"
 #include "boost/json.hpp"
 
+#include "ctx/ctx.h"
+
 #include "utl/erase_if.h"
 #include "utl/pipes.h"
 #include "utl/zip.h"
@@ -13,6 +18,7 @@
 #include "nigiri/logging.h"
 #include "nigiri/timetable.h"
 
+#include "motis/ctx_data.h"
 #include "motis/elevators/elevators.h"
 #include "motis/endpoints/routing.h"
 #include "motis/http_req.h"
@@ -26,6 +32,62 @@ namespace json = boost::json;
 
 namespace motis::odm {
 
+boost::asio::awaitable<prima_response_t> post_request(
+    boost::urls::url url, std::string body, std::chrono::seconds timeout) {
+  co_return get_http_body(
+      co_await http_POST(std::move(url), kReqHeaders, body, timeout));
+}
+
+prima_response_t get_response(std::exception_ptr const& e,
+                              prima_response_t response,
+                              std::string_view const log_tag) {
+  if (e != nullptr) {
+    try {
+      std::rethrow_exception(e);
+    } catch (std::exception const& ex) {
+      n::log(n::log_lvl::debug, "motis.prima", "[{}] networking failed: {}",
+             log_tag, ex.what());
+    } catch (...) {
+      n::log(n::log_lvl::debug, "motis.prima", "[{}] networking failed",
+             log_tag);
+    }
+    return std::nullopt;
+  }
+  return response;
+}
+
+std::function<prima_response_t()> prima_post(boost::urls::url const& url,
+                                             std::string body,
+                                             std::chrono::seconds const timeout,
+                                             std::string_view const log_tag) {
+  auto const op = ctx::current_op<ctx_data>();
+  if (op == nullptr) {
+    return [url, body = std::move(body), timeout,
+            log_tag = std::string{log_tag}]() {
+      auto response = prima_response_t{};
+      auto ioc = boost::asio::io_context{};
+      boost::asio::co_spawn(
+          ioc, post_request(url, body, timeout),
+          [&](std::exception_ptr const& e, prima_response_t r) {
+            response = get_response(e, std::move(r), log_tag);
+          });
+      ioc.run();
+      return response;
+    };
+  }
+
+  auto f = std::make_shared<ctx::future<ctx_data, prima_response_t>>(
+      ctx::op_id(CTX_LOCATION));
+  boost::asio::co_spawn(
+      op->sched_.runner_.ios(),
+      post_request(url, std::move(body), timeout),
+      [f, log_tag = std::string{log_tag}](std::exception_ptr const& e,
+                                          prima_response_t r) {
+        f->set(get_response(e, std::move(r), log_tag));
+      });
+  return [f]() -> prima_response_t { return f->val(); };
+}
+
 prima::prima(std::string const& prima_url,
              osr::location const& from,
              osr::location const& to,
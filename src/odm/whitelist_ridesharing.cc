@@ -1,11 +1,7 @@
 #include "motis/odm/prima.h"
 
-#include "boost/asio/co_spawn.hpp"
-#include "boost/asio/detached.hpp"
-#include "boost/asio/io_context.hpp"
 #include "boost/json.hpp"
 
-#include "motis/http_req.h"
 #include "motis/odm/odm.h"
 
 namespace n = nigiri;
@@ -141,35 +137,27 @@ bool prima::consume_ride_sharing_response(std::string_view json) {
   return true;
 }
 
-bool prima::whitelist_ride_sharing(n::timetable const& tt) {
-  auto response = std::optional<std::string>{};
-  auto ioc = boost::asio::io_context{};
-  try {
-    n::log(n::log_lvl::debug, "motis.prima",
-           "[whitelist ride-sharing] request for {} events",
-           n_ride_sharing_events());
-    boost::asio::co_spawn(
-        ioc,
-        [&]() -> boost::asio::awaitable<void> {
-          auto const prima_msg =
-              co_await http_POST(ride_sharing_whitelist_, kReqHeaders,
-                                 make_ride_sharing_request(tt), 30s);
-          response = get_http_body(prima_msg);
-        },
-        boost::asio::detached);
-    ioc.run();
-  } catch (std::exception const& e) {
-    n::log(n::log_lvl::debug, "motis.prima",
-           "[whitelist ride-sharing] networking failed: {}", e.what());
-    response = std::nullopt;
-  }
-  if (!response) {
-    n::log(n::log_lvl::debug, "motis.prima",
-           "[whitelist ride share] failed, discarding ride share journeys");
-    return false;
-  }
+std::function<bool()> prima::whitelist_ride_sharing_async(
+    n::timetable const& tt) {
+  n::log(n::log_lvl::debug, "motis.prima",
+         "[whitelist ride-sharing] request for {} events",
+         n_ride_sharing_events());
+  auto response = prima_post(ride_sharing_whitelist_,
+                             make_ride_sharing_request(tt), 30s,
+                             "whitelist ride-sharing");
+  return [this, response = std::move(response)]() {
+    auto const whitelist_response = response();
+    if (!whitelist_response) {
+      n::log(n::log_lvl::debug, "motis.prima",
+             "[whitelist ride share] failed, discarding ride share journeys");
+      return false;
+    }
+    return consume_ride_sharing_response(*whitelist_response);
+  };
+}
 
-  return consume_ride_sharing_response(*response);
+bool prima::whitelist_ride_sharing(n::timetable const& tt) {
+  return whitelist_ride_sharing_async(tt)();
 }
 
 }  // namespace motis::odm
\ No newline at end of file
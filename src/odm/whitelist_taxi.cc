@@ -1,13 +1,9 @@
 #include "motis/odm/prima.h"
 
-#include "boost/asio/co_spawn.hpp"
-#include "boost/asio/detached.hpp"
-#include "boost/asio/io_context.hpp"
 #include "boost/json.hpp"
 
 #include "utl/erase_duplicates.h"
 
-#include "motis/http_req.h"
 #include "motis/odm/odm.h"
 #include "motis/transport_mode_ids.h"
 
@@ -216,32 +212,16 @@ bool prima::whitelist_taxi(std::vector<nr::journey>& taxi_journeys,
   extract_taxis(taxi_journeys, first_mile_taxi_rides, last_mile_taxi_rides);
   extract_taxis_for_persisting(taxi_journeys);
 
-  auto whitelist_response = std::optional<std::string>{};
-  auto ioc = boost::asio::io_context{};
-  try {
-    n::log(n::log_lvl::debug, "motis.prima",
-           "[whitelist taxi] request for {} rides",
-           first_mile_taxi_rides.size() + last_mile_taxi_rides.size() +
-               direct_taxi_.size());
-
-    boost::asio::co_spawn(
-        ioc,
-        [&]() -> boost::asio::awaitable<void> {
-          auto const prima_msg = co_await http_POST(
-              taxi_whitelist_, kReqHeaders,
-              make_whitelist_request(from_, to_, first_mile_taxi_rides,
-                                     last_mile_taxi_rides, direct_taxi_, fixed_,
-                                     cap_, tt),
-              10s);
-          whitelist_response = get_http_body(prima_msg);
-        },
-        boost::asio::detached);
-    ioc.run();
-  } catch (std::exception const& e) {
-    n::log(n::log_lvl::debug, "motis.prima",
-           "[whitelist taxi] networking failed: {}", e.what());
-    whitelist_response = std::nullopt;
-  }
+  n::log(n::log_lvl::debug, "motis.prima",
+         "[whitelist taxi] request for {} rides",
+         first_mile_taxi_rides.size() + last_mile_taxi_rides.size() +
+             direct_taxi_.size());
+  auto const whitelist_response =
+      prima_post(taxi_whitelist_,
+                 make_whitelist_request(from_, to_, first_mile_taxi_rides,
+                                        last_mile_taxi_rides, direct_taxi_,
+                                        fixed_, cap_, tt),
+                 10s, "whitelist taxi")();
   if (!whitelist_response) {
     n::log(n::log_lvl::debug, "motis.prima",
            "[whitelist taxi] failed, discarding taxi journeys");
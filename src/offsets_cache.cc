@@ -0,0 +1,87 @@
+#include "motis/offsets_cache.h"
+
+#include <cmath>
+
+#include "prometheus/counter.h"
+
+#include "nigiri/rt/rt_timetable.h"
+#include "nigiri/special_stations.h"
+#include "nigiri/timetable.h"
+
+#include "motis/metrics_registry.h"
+#include "motis/point_rtree.h"
+
+namespace n = nigiri;
+
+namespace motis {
+
+constexpr auto const kCoordinatePrecision = 1'000'000.0;
+constexpr auto const kNoLevel = -1000.0F;
+
+offsets_cache_key make_offsets_cache_key(osr::location const& pos,
+                                         osr::search_profile const profile,
+                                         osr::direction const dir,
+                                         osr_parameters const& params,
+                                         std::chrono::seconds const max,
+                                         double const max_matching_distance,
+                                         bool const with_rt) {
+  return {
+      .lat_ = static_cast<std::int32_t>(
+          std::round(pos.pos_.lat() * kCoordinatePrecision)),
+      .lng_ = static_cast<std::int32_t>(
+          std::round(pos.pos_.lng() * kCoordinatePrecision)),
+      .lvl_ = pos.lvl_.has_level() ? pos.lvl_.to_float() : kNoLevel,
+      .profile_ = profile,
+      .dir_ = dir,
+      .pedestrian_speed_ = params.pedestrian_speed_,
+      .cycling_speed_ = params.cycling_speed_,
+      .use_wheelchair_ = params.use_wheelchair_,
+      .max_ = max.count(),
+      .max_matching_distance_ = max_matching_distance,
+      .with_rt_ = with_rt};
+}
+
+offsets_cache::offsets_cache(std::size_t const max_size,
+                             metrics_registry* metrics)
+    : metrics_{metrics},
+      cache_{max_size, make_cache_metrics(*metrics, "offsets")} {}
+
+offsets_cache::offsets_t offsets_cache::get(offsets_cache_key const& key) {
+  auto const e = cache_.lookup(key);
+  return e == nullptr ? nullptr : offsets_t{e, &e->offsets_};
+}
+
+void offsets_cache::invalidate(n::timetable const& tt,
+                               n::rt_timetable const* prev,
+                               n::rt_timetable const* next) {
+  auto const has_rt_traffic = [](n::rt_timetable const* rtt,
+                                 n::location_idx_t const l) {
+    return rtt != nullptr && !rtt->location_rt_transports_[l].empty();
+  };
+
+  auto changed = point_rtree<n::location_idx_t>{};
+  auto n_changed = 0U;
+  for (auto l = n::location_idx_t{n::kNSpecialStations}; l != tt.n_locations();
+       ++l) {
+    if (tt.location_routes_[l].empty() &&
+        has_rt_traffic(prev, l) != has_rt_traffic(next, l)) {
+      changed.add(tt.locations_.coordinates_[l], l);
+      ++n_changed;
+    }
+  }
+
+  if (n_changed == 0U) {
+    return;
+  }
+
+  auto const n_removed = cache_.remove_if(
+      [&](offsets_cache_key const& key, std::shared_ptr<entry> const& e) {
+        return key.with_rt_ && !changed.in_radius(e->pos_, e->radius_).empty();
+      });
+  metrics_->offsets_cache_invalidations_.Increment(
+      static_cast<double>(n_removed));
+}
+
+std::size_t offsets_cache::size() const { return cache_.size(); }
+
+}  // namespace motis
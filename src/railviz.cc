@@ -2,13 +2,17 @@
 
 #include <algorithm>
 #include <bit>
+#include <cmath>
 #include <cstddef>
+#include <numbers>
 #include <optional>
 #include <ranges>
 #include <string_view>
 #include <type_traits>
 
+#include "cista/containers/array.h"
 #include "cista/containers/rtree.h"
+#include "cista/io.h"
 #include "cista/reflection/comparable.h"
 
 #include "net/bad_request_exception.h"
@@ -41,6 +45,8 @@
 #include "motis/journey_to_response.h"
 #include "motis/parse_location.h"
 #include "motis/place.h"
+#include "motis/sharded_cache.h"
+#include "motis/startup_indices.h"
 #include "motis/tag_lookup.h"
 #include "motis/timetable/clasz_to_mode.h"
 #include "motis/timetable/time_conv.h"
@@ -51,7 +57,14 @@ constexpr auto const kTripsLimit = 12'000U;
 constexpr auto const kRoutesLimit = 20'000U;
 constexpr auto const kRoutesPolylinesLimit = 20'000U;
 
-using static_rtree = cista::raw::rtree<n::route_idx_t>;
+constexpr auto const kTripsCacheMaxTiles = 64U;
+constexpr auto const kTripsCacheMaxViewportTiles = 16U;
+constexpr auto const kTripsTileZoomOffset = 2;
+constexpr auto const kTripsTileMaxZoom = 22;
+constexpr auto const kTripsTimeBucket = n::i32_minutes{10};
+constexpr auto const kMaxMercatorLat = 85.0511287798;
+
+using static_rtree = cista::offset::rtree<n::route_idx_t>;
 using rt_rtree = cista::raw::rtree<n::rt_transport_idx_t>;
 
 using int_clasz = std::underlying_type_t<n::clasz>;
@@ -61,8 +74,131 @@ namespace motis {
 struct stop_pair {
   n::rt::run r_;
   n::stop_idx_t from_{}, to_{};
+  geo::box box_{};
+  n::interval<n::unixtime_t> active_{};
+};
+
+// Identifies the segment of a run. Used to deduplicate segments that are
+// contained in more than one cached tile.
+struct trip_segment_key {
+  CISTA_COMPARABLE()
+
+  n::transport_idx_t t_idx_;
+  n::day_idx_t day_;
+  n::rt_transport_idx_t rt_;
+  n::stop_idx_t from_;
+};
+
+struct trip_segment {
+  trip_segment_key key_;
+  geo::box box_;
+  n::interval<n::unixtime_t> active_;
+  api::TripSegment segment_;
+};
+
+// Encoded trip segments of one web mercator tile and time bucket.
+struct trips_tile {
+  bool too_many_{false};
+  std::vector<trip_segment> segments_;
+};
+
+// Approximate memory footprint, dominated by the encoded polylines.
+struct trips_tile_size {
+  std::size_t operator()(trips_tile const& t) const {
+    auto size = sizeof(trips_tile) + t.segments_.size() * sizeof(trip_segment);
+    for (auto const& s : t.segments_) {
+      size += s.segment_.polyline_.size() +
+              s.segment_.trips_.size() * sizeof(api::TripInfo);
+    }
+    return size;
+  }
 };
 
+struct trips_tile_key {
+  bool operator==(trips_tile_key const&) const = default;
+
+  cista::hash_t hash() const noexcept {
+    auto h = cista::build_hash(x_, y_, z_, zoom_, bucket_, precision_,
+                               api_version_, language_.has_value());
+    if (language_.has_value()) {
+      for (auto const& l : *language_) {
+        h = cista::hash(l, h);
+      }
+    }
+    return h;
+  }
+
+  std::uint32_t x_;
+  std::uint32_t y_;
+  int z_;     // tile zoom
+  int zoom_;  // display zoom level (see `should_display`)
+  std::int32_t bucket_;
+  std::int8_t precision_;
+  unsigned api_version_;
+  n::lang_t language_;
+};
+
+std::uint32_t lng_to_tile_x(double const lng, int const z) {
+  auto const tiles = static_cast<double>(1U << z);
+  auto const x = std::floor((lng + 180.0) / 360.0 * tiles);
+  return static_cast<std::uint32_t>(std::clamp(x, 0.0, tiles - 1.0));
+}
+
+std::uint32_t lat_to_tile_y(double const lat, int const z) {
+  auto const tiles = static_cast<double>(1U << z);
+  auto const rad =
+      std::clamp(lat, -kMaxMercatorLat, kMaxMercatorLat) * std::numbers::pi /
+      180.0;
+  auto const y = std::floor(
+      (1.0 - std::asinh(std::tan(rad)) / std::numbers::pi) / 2.0 * tiles);
+  return static_cast<std::uint32_t>(std::clamp(y, 0.0, tiles - 1.0));
+}
+
+std::size_t n_area_tiles(geo::box const& area, int const z) {
+  return static_cast<std::size_t>(lng_to_tile_x(area.max_.lng_, z) -
+                                  lng_to_tile_x(area.min_.lng_, z) + 1U) *
+         (lat_to_tile_y(area.min_.lat_, z) - lat_to_tile_y(area.max_.lat_, z) +
+          1U);
+}
+
+// Zoom of the cached tiles. A viewport at `zoom_level` spans about 8x5 tiles
+// of this zoom level (256px tiles), two zoom levels lower it is covered by
+// about 3x2 to 4x3 tiles. Larger viewports use larger tiles.
+int tile_zoom(geo::box const& area, int const zoom_level) {
+  auto z = std::clamp(zoom_level - kTripsTileZoomOffset, 0, kTripsTileMaxZoom);
+  while (z > 0 && n_area_tiles(area, z) > kTripsCacheMaxViewportTiles) {
+    --z;
+  }
+  return z;
+}
+
+// Slightly enlarged (rtree search uses float coordinates) and extended to
+// the poles for the first/last row.
+geo::box tile_box(std::uint32_t const x, std::uint32_t const y, int const z) {
+  constexpr auto const kPadding = 1E-5;
+  auto const tiles = static_cast<double>(1U << z);
+  auto const lng = [&](std::uint32_t const i) {
+    return i / tiles * 360.0 - 180.0;
+  };
+  auto const lat = [&](std::uint32_t const i) {
+    return std::atan(std::sinh(std::numbers::pi * (1.0 - 2.0 * i / tiles))) *
+           180.0 / std::numbers::pi;
+  };
+  auto const max_lat = y == 0U ? 90.0 : lat(y) + kPadding;
+  auto const min_lat = y + 1U == (1U << z) ? -90.0 : lat(y + 1U) - kPadding;
+  return geo::make_box({geo::latlng{min_lat, lng(x) - kPadding},
+                        geo::latlng{max_lat, lng(x + 1U) + kPadding}});
+}
+
+std::int32_t time_bucket(n::unixtime_t const t) {
+  return t.time_since_epoch().count() / kTripsTimeBucket.count();
+}
+
+n::interval<n::unixtime_t> time_bucket_interval(std::int32_t const bucket) {
+  auto const from = n::unixtime_t{bucket * kTripsTimeBucket};
+  return n::interval{from, from + kTripsTimeBucket};
+}
+
 int min_zoom_level(n::clasz const clasz, float const distance) {
   switch (clasz) {
     // long distance
@@ -113,50 +249,48 @@ bool should_display(n::clasz const clasz,
   return zoom_level >= min_zoom_level(clasz, distance);
 }
 
-struct route_geo_index {
-  route_geo_index() = default;
-
-  route_geo_index(n::timetable const& tt,
-                  n::shapes_storage const* shapes_data,
-                  n::clasz const clasz,
-                  n::vector_map<n::route_idx_t, float>& distances) {
-    // Fallback, if no route bounding box can be loaded
-    auto const get_box = [&](n::route_idx_t const route_idx) {
-      auto bounding_box = geo::box{};
-      for (auto const l : tt.route_location_seq_[route_idx]) {
-        bounding_box.extend(
-            tt.locations_.coordinates_.at(n::stop{l}.location_idx()));
-      }
-      return bounding_box;
-    };
-    for (auto const [i, claszes] : utl::enumerate(tt.route_section_clasz_)) {
-      auto const r = n::route_idx_t{i};
-      if (claszes.at(0) != clasz) {
-        continue;
-      }
-      auto const bounding_box = (shapes_data == nullptr)
-                                    ? get_box(r)
-                                    : shapes_data->get_bounding_box(r);
-
-      rtree_.insert(bounding_box.min_.lnglat_float(),
-                    bounding_box.max_.lnglat_float(), r);
-      distances[r] = static_cast<float>(
-          geo::distance(bounding_box.max_, bounding_box.min_));
+static_rtree build_route_geo_index(
+    n::timetable const& tt,
+    n::shapes_storage const* shapes_data,
+    n::clasz const clasz,
+    cista::offset::vector_map<n::route_idx_t, float>& distances) {
+  // Fallback, if no route bounding box can be loaded
+  auto const get_box = [&](n::route_idx_t const route_idx) {
+    auto bounding_box = geo::box{};
+    for (auto const l : tt.route_location_seq_[route_idx]) {
+      bounding_box.extend(
+          tt.locations_.coordinates_.at(n::stop{l}.location_idx()));
     }
+    return bounding_box;
+  };
+  auto rtree = static_rtree{};
+  for (auto const [i, claszes] : utl::enumerate(tt.route_section_clasz_)) {
+    auto const r = n::route_idx_t{i};
+    if (claszes.at(0) != clasz) {
+      continue;
+    }
+    auto const bounding_box = (shapes_data == nullptr)
+                                  ? get_box(r)
+                                  : shapes_data->get_bounding_box(r);
+
+    rtree.insert(bounding_box.min_.lnglat_float(),
+                 bounding_box.max_.lnglat_float(), r);
+    distances[r] =
+        static_cast<float>(geo::distance(bounding_box.max_, bounding_box.min_));
   }
+  return rtree;
+}
 
-  std::vector<n::route_idx_t> get_routes(geo::box const& b) const {
-    auto routes = std::vector<n::route_idx_t>{};
-    rtree_.search(b.min_.lnglat_float(), b.max_.lnglat_float(),
-                  [&](auto, auto, n::route_idx_t const r) {
-                    routes.push_back(r);
-                    return true;
-                  });
-    return routes;
-  }
-
-  static_rtree rtree_{};
-};
+std::vector<n::route_idx_t> find_routes(static_rtree const& rtree,
+                                        geo::box const& b) {
+  auto routes = std::vector<n::route_idx_t>{};
+  rtree.search(b.min_.lnglat_float(), b.max_.lnglat_float(),
+               [&](auto, auto, n::route_idx_t const r) {
+                 routes.push_back(r);
+                 return true;
+               });
+  return routes;
+}
 
 struct rt_transport_geo_index {
   rt_transport_geo_index() = default;
@@ -203,30 +337,49 @@ struct rt_transport_geo_index {
 };
 
 struct railviz_static_index::impl {
-  std::array<route_geo_index, n::kNumClasses> static_geo_indices_;
-  n::vector_map<n::route_idx_t, float> static_distances_{};
+  cista::array<static_rtree, n::kNumClasses> static_geo_indices_;
+  cista::offset::vector_map<n::route_idx_t, float> static_distances_{};
 };
 
 railviz_static_index::railviz_static_index(n::timetable const& tt,
                                            n::shapes_storage const* shapes_data)
-    : impl_{std::make_unique<impl>()} {
+    : impl_{cista::raw::make_unique<impl>()} {
   impl_->static_distances_.resize(tt.route_location_seq_.size());
   for (auto c = int_clasz{0U}; c != n::kNumClasses; ++c) {
-    impl_->static_geo_indices_[c] =
-        route_geo_index{tt, shapes_data, n::clasz{c}, impl_->static_distances_};
+    impl_->static_geo_indices_[c] = build_route_geo_index(
+        tt, shapes_data, n::clasz{c}, impl_->static_distances_);
   }
 }
 
+railviz_static_index::railviz_static_index(std::filesystem::path const& p)
+    : impl_{read_mapped<impl>(p)} {}
+
+void railviz_static_index::write(std::filesystem::path const& p) const {
+  write_mapped(p, *impl_);
+}
+
 railviz_static_index::~railviz_static_index() = default;
 
 struct railviz_rt_index::impl {
+  impl(std::size_t const cache_size, cache_metrics const metrics)
+      : trips_cache_{cache_size, metrics} {}
+
   std::array<rt_transport_geo_index, n::kNumClasses> rt_geo_indices_;
   n::vector_map<n::rt_transport_idx_t, float> rt_distances_{};
+
+  // Belongs to this RT snapshot: publishing a new snapshot invalidates it.
+  mutable sharded_cache<trips_tile_key, trips_tile, trips_tile_size>
+      trips_cache_;
 };
 
 railviz_rt_index::railviz_rt_index(nigiri::timetable const& tt,
-                                   nigiri::rt_timetable const& rtt)
-    : impl_{std::make_unique<impl>()} {
+                                   nigiri::rt_timetable const& rtt,
+                                   std::size_t const cache_size,
+                                   metrics_registry const* metrics)
+    : impl_{std::make_unique<impl>(
+          cache_size,
+          metrics == nullptr ? cache_metrics{}
+                             : make_cache_metrics(*metrics, "railviz_trips"))} {
   impl_->rt_distances_.resize(rtt.rt_transport_location_seq_.size());
   for (auto c = int_clasz{0U}; c != n::kNumClasses; ++c) {
     impl_->rt_geo_indices_[c] =
@@ -258,7 +411,9 @@ void add_rt_transports(n::timetable const& tt,
       runs.emplace_back(
           stop_pair{.r_ = fr,  // NOLINT(cppcoreguidelines-slicing)
                     .from_ = from.stop_idx_,
-                    .to_ = to.stop_idx_});
+                    .to_ = to.stop_idx_,
+                    .box_ = box,
+                    .active_ = active});
     }
   }
 }
@@ -270,18 +425,60 @@ void add_static_transports(n::timetable const& tt,
                            geo::box const& area,
                            n::shapes_storage const* shapes_data,
                            std::vector<stop_pair>& runs) {
-  auto const is_active = [&](n::transport const t) -> bool {
-    return (rtt == nullptr
-                ? tt.bitfields_[tt.transport_traffic_days_[t.t_idx_]]
-                : rtt->bitfields_[rtt->transport_traffic_days_[t.t_idx_]])
-        .test(to_idx(t.day_));
+  auto const traffic_days =
+      [&](n::transport_idx_t const t) -> n::bitfield const& {
+    return rtt == nullptr
+               ? tt.bitfields_[tt.transport_traffic_days_[t]]
+               : rtt->bitfields_[rtt->transport_traffic_days_[t]];
   };
 
   auto const seq = tt.route_location_seq_[r];
+  auto const transports = tt.route_transport_ranges_[r];
   auto const stop_indices =
       n::interval{n::stop_idx_t{0U}, static_cast<n::stop_idx_t>(seq.size())};
   auto const [start_day, _] = tt.day_idx_mam(time_interval.from_);
   auto const [end_day, _1] = tt.day_idx_mam(time_interval.to_);
+
+  // Transport days of this route that can overlap the time window: the
+  // traffic days of each transport are intersected with the day window once
+  // (word-wise), so transports that don't run in the window are skipped for
+  // all segments at once instead of being tested per segment and day.
+  auto active = std::optional<std::vector<n::transport>>{};
+  auto const get_active = [&]() -> std::vector<n::transport> const& {
+    if (active.has_value()) {
+      return *active;
+    }
+    active.emplace();
+
+    auto const last_arr = tt.event_times_at_stop(
+        r, static_cast<n::stop_idx_t>(seq.size() - 1U), n::event_type::kArr);
+    auto max_day_offset = n::day_idx_t::value_t{0U};
+    for (auto const t : last_arr) {
+      max_day_offset = std::max(
+          max_day_offset, static_cast<n::day_idx_t::value_t>(t.days()));
+    }
+    auto const first_day = to_idx(start_day) > max_day_offset
+                               ? start_day - max_day_offset
+                               : n::day_idx_t{0U};
+
+    auto window = n::bitfield{};
+    for (auto d = first_day; d <= end_day && to_idx(d) < n::kMaxDays; ++d) {
+      window.set(to_idx(d));
+    }
+    for (auto const t_idx : transports) {
+      auto const days = traffic_days(t_idx) & window;
+      if (!days.any()) {
+        continue;
+      }
+      for (auto d = first_day; d <= end_day && to_idx(d) < n::kMaxDays; ++d) {
+        if (days.test(to_idx(d))) {
+          active->push_back(n::transport{t_idx, d});
+        }
+      }
+    }
+    return *active;
+  };
+
   auto const get_box = [&](std::size_t segment) {
     if (shapes_data != nullptr) {
       auto const box = shapes_data->get_bounding_box(r, segment);
@@ -301,29 +498,30 @@ void add_static_transports(n::timetable const& tt,
       continue;
     }
 
-    auto const arr_times = tt.event_times_at_stop(r, to, n::event_type::kArr);
-    for (auto const [i, t_idx] :
-         utl::enumerate(tt.route_transport_ranges_[r])) {
-      auto const day_offset =
-          static_cast<n::day_idx_t::value_t>(arr_times[i].days());
-      for (auto traffic_day = start_day - day_offset; traffic_day <= end_day;
-           ++traffic_day) {
-        auto const t = n::transport{t_idx, traffic_day};
-        if (time_interval.overlaps({tt.event_time(t, from, n::event_type::kDep),
-                                    tt.event_time(t, to, n::event_type::kArr) +
-                                        n::unixtime_t::duration{1}}) &&
-            is_active(t)) {
-          utl::verify<net::too_many_exception>(runs.size() < kTripsLimit,
-                                               "too many trips");
-          runs.emplace_back(stop_pair{
-              .r_ = n::rt::run{.t_ = t,
-                               .stop_range_ = {from, static_cast<n::stop_idx_t>(
-                                                         to + 1U)},
-                               .rt_ = n::rt_transport_idx_t::invalid()},
-              .from_ = 0,
-              .to_ = 1});
-        }
+    auto const& transport_days = get_active();
+    if (transport_days.empty()) {
+      return;
+    }
+
+    for (auto const t : transport_days) {
+      auto const active_interval =
+          n::interval{tt.event_time(t, from, n::event_type::kDep),
+                      tt.event_time(t, to, n::event_type::kArr) +
+                          n::unixtime_t::duration{1}};
+      if (!time_interval.overlaps(active_interval)) {
+        continue;
       }
+      utl::verify<net::too_many_exception>(runs.size() < kTripsLimit,
+                                           "too many trips");
+      runs.emplace_back(stop_pair{
+          .r_ = n::rt::run{.t_ = t,
+                           .stop_range_ = {from,
+                                           static_cast<n::stop_idx_t>(to + 1U)},
+                           .rt_ = n::rt_transport_idx_t::invalid()},
+          .from_ = 0,
+          .to_ = 1,
+          .box_ = box,
+          .active_ = active_interval});
     }
   }
 }
@@ -353,84 +551,168 @@ api::trips_response get_trains(tag_lookup const& tags,
       std::chrono::time_point_cast<n::unixtime_t::duration>(*query.endTime_);
   auto const time_interval = n::interval{start_time, end_time};
   auto const area = geo::make_box({min->pos_, max->pos_});
+  auto const precision = static_cast<std::int8_t>(query.precision_);
+  utl::verify<net::bad_request_exception>(
+      precision >= 0 && precision < 7,
+      "invalid precision for polylines, allowed are [0, 6]");
 
-  // Collect runs within time+location window.
-  auto runs = std::vector<stop_pair>{};
-  for (auto c = int_clasz{0U}; c != n::kNumClasses; ++c) {
-    auto const cl = n::clasz{c};
-    if (!should_display(cl, zoom_level,
-                        std::numeric_limits<float>::infinity())) {
-      continue;
-    }
+  // Collect runs within time+location window and encode their segments.
+  auto const get_segments = [&](geo::box const& a,
+                                n::interval<n::unixtime_t> const interval) {
+    auto runs = std::vector<stop_pair>{};
+    for (auto c = int_clasz{0U}; c != n::kNumClasses; ++c) {
+      auto const cl = n::clasz{c};
+      if (!should_display(cl, zoom_level,
+                          std::numeric_limits<float>::infinity())) {
+        continue;
+      }
+
+      if (rtt != nullptr) {
+        for (auto const& rt_t :
+             rt_index.rt_geo_indices_[c].get_rt_transports(*rtt, a)) {
+          if (should_display(cl, zoom_level, rt_index.rt_distances_[rt_t])) {
+            add_rt_transports(tt, *rtt, rt_t, interval, a, runs);
+          }
+        }
+      }
 
-    if (rtt != nullptr) {
-      for (auto const& rt_t :
-           rt_index.rt_geo_indices_[c].get_rt_transports(*rtt, area)) {
-        if (should_display(cl, zoom_level, rt_index.rt_distances_[rt_t])) {
-          add_rt_transports(tt, *rtt, rt_t, time_interval, area, runs);
+      for (auto const& r :
+           find_routes(static_index.static_geo_indices_[c], a)) {
+        if (should_display(cl, zoom_level, static_index.static_distances_[r])) {
+          add_static_transports(tt, rtt, r, interval, a, shapes, runs);
         }
       }
     }
 
-    for (auto const& r : static_index.static_geo_indices_[c].get_routes(area)) {
-      if (should_display(cl, zoom_level, static_index.static_distances_[r])) {
-        add_static_transports(tt, rtt, r, time_interval, area, shapes, runs);
+    return geo::with_polyline_encoder(precision, [&](auto enc) mutable {
+      return utl::to_vec(runs, [&](stop_pair const& r) -> trip_segment {
+        enc.reset();
+
+        auto const fr = n::rt::frun{tt, rtt, r.r_};
+
+        auto const from = fr[r.from_];
+        auto const to = fr[r.to_];
+
+        fr.for_each_shape_point(
+            shapes, {r.from_, static_cast<n::stop_idx_t>(r.to_ + 1U)},
+            [&](auto&& p) { enc.push_nonzero_diff(p, 2); });
+
+        return {
+            .key_ = {.t_idx_ = r.r_.t_.t_idx_,
+                     .day_ = r.r_.t_.day_,
+                     .rt_ = r.r_.rt_,
+                     .from_ = static_cast<n::stop_idx_t>(
+                         r.r_.stop_range_.from_ + r.from_)},
+            .box_ = r.box_,
+            .active_ = r.active_,
+            .segment_ = {
+                .trips_ = {api::TripInfo{
+                    .tripId_ = tags.id(tt, from, n::event_type::kDep),
+                    .routeShortName_ =
+                        api_version < 4
+                            ? std::optional{std::string{from.display_name(
+                                  n::event_type::kDep, query.language_)}}
+                            : std::nullopt,
+                    .displayName_ =
+                        api_version >= 4
+                            ? std::optional{std::string{from.display_name(
+                                  n::event_type::kDep, query.language_)}}
+                            : std::nullopt}},
+                .routeColor_ =
+                    to_str(from.get_route_color(n::event_type::kDep).color_),
+                .mode_ =
+                    to_mode(from.get_clasz(n::event_type::kDep), api_version),
+                .distance_ =
+                    fr.is_rt() ? rt_index.rt_distances_[fr.rt_]
+                               : static_index.static_distances_
+                                     [tt.transport_route_[fr.t_.t_idx_]],
+                .from_ = bwd_compat_lvl_adjust(
+                    to_place(&tt, &tags, w, pl, matches, ae, tz,
+                             query.language_, tt_location{from}),
+                    api_version),
+                .to_ = bwd_compat_lvl_adjust(
+                    to_place(&tt, &tags, w, pl, matches, ae, tz,
+                             query.language_, tt_location{to}),
+                    api_version),
+                .departure_ = from.time(n::event_type::kDep),
+                .arrival_ = to.time(n::event_type::kArr),
+                .scheduledDeparture_ = from.scheduled_time(n::event_type::kDep),
+                .scheduledArrival_ = to.scheduled_time(n::event_type::kArr),
+                .realTime_ = fr.is_rt(),
+                .polyline_ = std::move(enc.buf_)}};
+      });
+    });
+  };
+
+  auto const to_response = [](std::vector<trip_segment>&& segments) {
+    return utl::to_vec(segments,
+                       [](trip_segment& s) { return std::move(s.segment_); });
+  };
+
+  // Assemble the response from cached web mercator tiles and time buckets.
+  // Tiles contain every segment overlapping them, so the union of the tiles
+  // covering the query window filtered by the window is the exact result.
+  auto const z = tile_zoom(area, zoom_level);
+  auto const x_range = std::pair{lng_to_tile_x(area.min_.lng_, z),
+                                 lng_to_tile_x(area.max_.lng_, z)};
+  auto const y_range = std::pair{lat_to_tile_y(area.max_.lat_, z),
+                                 lat_to_tile_y(area.min_.lat_, z)};
+  auto const bucket_range = std::pair{
+      time_bucket(start_time),
+      time_bucket(std::max(start_time, end_time - n::i32_minutes{1}))};
+  auto const n_tiles =
+      static_cast<std::size_t>(x_range.second - x_range.first + 1U) *
+      (y_range.second - y_range.first + 1U) *
+      static_cast<std::size_t>(bucket_range.second - bucket_range.first + 1);
+  if (n_tiles > kTripsCacheMaxTiles) {
+    return to_response(get_segments(area, time_interval));
+  }
+
+  auto segments = std::vector<trip_segment>{};
+  for (auto x = x_range.first; x <= x_range.second; ++x) {
+    for (auto y = y_range.first; y <= y_range.second; ++y) {
+      for (auto b = bucket_range.first; b <= bucket_range.second; ++b) {
+        auto const key = trips_tile_key{.x_ = x,
+                                        .y_ = y,
+                                        .z_ = z,
+                                        .zoom_ = zoom_level,
+                                        .bucket_ = b,
+                                        .precision_ = precision,
+                                        .api_version_ = api_version,
+                                        .language_ = query.language_};
+        auto const tile = rt_index.trips_cache_.get_or_compute(key, [&]() {
+          auto t = std::make_shared<trips_tile>();
+          try {
+            t->segments_ =
+                get_segments(tile_box(x, y, z), time_bucket_interval(b));
+          } catch (net::too_many_exception const&) {
+            t->too_many_ = true;
+          }
+          return t;
+        });
+        if (tile->too_many_) {
+          return to_response(get_segments(area, time_interval));
+        }
+        for (auto const& s : tile->segments_) {
+          if (s.box_.overlaps(area) && s.active_.overlaps(time_interval)) {
+            segments.push_back(s);
+          }
+        }
       }
     }
   }
 
-  auto const precision = static_cast<std::int8_t>(query.precision_);
-  utl::verify<net::bad_request_exception>(
-      precision >= 0 && precision < 7,
-      "invalid precision for polylines, allowed are [0, 6]");
-  return geo::with_polyline_encoder(precision, [&](auto enc) mutable {
-    return utl::to_vec(runs, [&](stop_pair const& r) -> api::TripSegment {
-      enc.reset();
-
-      auto const fr = n::rt::frun{tt, rtt, r.r_};
-
-      auto const from = fr[r.from_];
-      auto const to = fr[r.to_];
-
-      fr.for_each_shape_point(shapes,
-                              {r.from_, static_cast<n::stop_idx_t>(r.to_ + 1U)},
-                              [&](auto&& p) { enc.push_nonzero_diff(p, 2); });
-
-      return {
-          .trips_ = {api::TripInfo{
-              .tripId_ = tags.id(tt, from, n::event_type::kDep),
-              .routeShortName_ =
-                  api_version < 4 ? std::optional{std::string{from.display_name(
-                                        n::event_type::kDep, query.language_)}}
-                                  : std::nullopt,
-              .displayName_ = api_version >= 4
-                                  ? std::optional{std::string{from.display_name(
-                                        n::event_type::kDep, query.language_)}}
-                                  : std::nullopt}},
-          .routeColor_ =
-              to_str(from.get_route_color(n::event_type::kDep).color_),
-          .mode_ = to_mode(from.get_clasz(n::event_type::kDep), api_version),
-          .distance_ =
-              fr.is_rt()
-                  ? rt_index.rt_distances_[fr.rt_]
-                  : static_index
-                        .static_distances_[tt.transport_route_[fr.t_.t_idx_]],
-          .from_ = bwd_compat_lvl_adjust(
-              to_place(&tt, &tags, w, pl, matches, ae, tz, query.language_,
-                       tt_location{from}),
-              api_version),
-          .to_ =
-              bwd_compat_lvl_adjust(to_place(&tt, &tags, w, pl, matches, ae, tz,
-                                             query.language_, tt_location{to}),
-                                    api_version),
-          .departure_ = from.time(n::event_type::kDep),
-          .arrival_ = to.time(n::event_type::kArr),
-          .scheduledDeparture_ = from.scheduled_time(n::event_type::kDep),
-          .scheduledArrival_ = to.scheduled_time(n::event_type::kArr),
-          .realTime_ = fr.is_rt(),
-          .polyline_ = std::move(enc.buf_)};
-    });
+  utl::sort(segments, [](trip_segment const& a, trip_segment const& b) {
+    return a.key_ < b.key_;
   });
+  segments.erase(std::unique(begin(segments), end(segments),
+                             [](trip_segment const& a, trip_segment const& b) {
+                               return a.key_ == b.key_;
+                             }),
+                 end(segments));
+  utl::verify<net::too_many_exception>(segments.size() <= kTripsLimit,
+                                       "too many trips");
+  return to_response(std::move(segments));
 }
 
 struct route_info {
@@ -664,7 +946,8 @@ api::routes_response get_routes(tag_lookup const& tags,
       continue;
     }
 
-    for (auto const& r : static_index.static_geo_indices_[c].get_routes(area)) {
+    for (auto const& r :
+         find_routes(static_index.static_geo_indices_[c], area)) {
       if (should_display(cl, zoom_level, static_index.static_distances_[r])) {
         route_indexes.emplace_back(r);
       } else {
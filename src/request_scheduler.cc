@@ -0,0 +1,139 @@
+#include "motis/request_scheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "prometheus/counter.h"
+#include "prometheus/gauge.h"
+#include "prometheus/histogram.h"
+
+#include "motis/metrics_registry.h"
+
+namespace motis {
+
+namespace {
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+thread_local auto current_request_class = request_class::kInteractive;
+}  // namespace
+
+std::string_view to_str(request_class const c) {
+  switch (c) {
+    case request_class::kInteractive: return "interactive";
+    case request_class::kRouting: return "routing";
+    case request_class::kBatch: return "batch";
+  }
+  std::unreachable();
+}
+
+request_class classify_request(std::string_view target) {
+  target = target.substr(0U, target.find('?'));
+  if (target.contains("one-to-all") || target.contains("one-to-many") ||
+      target.starts_with("/api/debug/") || target == "/api/matches" ||
+      target == "/api/graph" || target == "/api/route" ||
+      target == "/api/platforms" || target == "/api/elevators") {
+    return request_class::kBatch;
+  }
+  if (target.ends_with("/plan") || target.ends_with("/refresh-itinerary") ||
+      target == "/ojp20") {
+    return request_class::kRouting;
+  }
+  return request_class::kInteractive;
+}
+
+request_class get_current_request_class() { return current_request_class; }
+
+void set_current_request_class(request_class const c) {
+  current_request_class = c;
+}
+
+bool request_scheduler::is_enabled(config const& c) {
+  auto const s = c.server_.value_or(config::server{});
+  return s.interactive_requests_.has_value() ||
+         s.routing_requests_.has_value() || s.batch_requests_.has_value();
+}
+
+request_scheduler::request_scheduler(config const& c, metrics_registry& m)
+    : max_running_{std::max(1U, c.n_threads())} {
+  auto const s = c.server_.value_or(config::server{});
+  auto const limits = std::array{s.interactive_requests_, s.routing_requests_,
+                                 s.batch_requests_};
+  for (auto i = 0U; i != kNumRequestClasses; ++i) {
+    auto& q = queues_[i];
+    auto const cls = static_cast<request_class>(i);
+    auto const labels = prometheus::Labels{{"class", std::string{to_str(cls)}}};
+    auto const limit = limits[i].value_or(config::server::request_limit{});
+    q.max_running_ = limit.max_running_;
+    q.max_queued_ = limit.max_queued_;
+    q.depth_ = &m.request_queue_depth_.Add(labels);
+    q.running_gauge_ = &m.requests_running_.Add(labels);
+    q.wait_ = &m.request_queue_wait_seconds_.Add(
+        labels, prometheus::Histogram::BucketBoundaries{
+                    0.001, 0.005, 0.01, 0.05, 0.1, 0.25, 0.5, 1, 2, 5, 10});
+    q.rejected_ = &m.requests_rejected_.Add(labels);
+  }
+}
+
+bool request_scheduler::submit(request_class const c, task_t start_task) {
+  auto& q = queues_[static_cast<std::size_t>(c)];
+  {
+    auto const lock = std::scoped_lock{mutex_};
+    if (q.tasks_.empty() && can_run(q)) {
+      start(q, std::chrono::steady_clock::now());
+    } else if (q.max_queued_ != 0U && q.tasks_.size() >= q.max_queued_) {
+      q.rejected_->Increment();
+      return false;
+    } else {
+      q.tasks_.push_back(
+          {std::move(start_task), std::chrono::steady_clock::now()});
+      q.depth_->Set(static_cast<double>(q.tasks_.size()));
+      return true;
+    }
+  }
+  start_task();
+  return true;
+}
+
+void request_scheduler::finish(request_class const c) {
+  auto next = std::optional<queued_task>{};
+  {
+    auto const lock = std::scoped_lock{mutex_};
+    auto& q = queues_[static_cast<std::size_t>(c)];
+    --q.running_;
+    --running_;
+    q.running_gauge_->Set(static_cast<double>(q.running_));
+    next = pop_next();
+  }
+  if (next.has_value()) {
+    next->start_();
+  }
+}
+
+bool request_scheduler::can_run(queue const& q) const {
+  return running_ < max_running_ &&
+         (q.max_running_ == 0U || q.running_ < q.max_running_);
+}
+
+void request_scheduler::start(
+    queue& q, std::chrono::steady_clock::time_point const enqueued) {
+  ++q.running_;
+  ++running_;
+  q.running_gauge_->Set(static_cast<double>(q.running_));
+  q.wait_->Observe(std::chrono::duration<double>{
+      std::chrono::steady_clock::now() - enqueued}
+                       .count());
+}
+
+std::optional<request_scheduler::queued_task> request_scheduler::pop_next() {
+  for (auto& q : queues_) {
+    if (!q.tasks_.empty() && can_run(q)) {
+      auto task = std::move(q.tasks_.front());
+      q.tasks_.pop_front();
+      q.depth_->Set(static_cast<double>(q.tasks_.size()));
+      start(q, task.enqueued_);
+      return task;
+    }
+  }
+  return std::nullopt;
+}
+
+}  // namespace motis
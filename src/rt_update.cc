@@ -1,16 +1,30 @@
 #include "motis/rt_update.h"
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
 #include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
 
 #include "boost/asio/co_spawn.hpp"
 #include "boost/asio/detached.hpp"
 #include "boost/asio/experimental/parallel_group.hpp"
+#include "boost/asio/redirect_error.hpp"
+#include "boost/asio/steady_timer.hpp"
 #include "boost/asio/this_coro.hpp"
+#include "boost/asio/thread_pool.hpp"
 #include "boost/asio/use_awaitable.hpp"
 #include "boost/beast/core/buffers_to_string.hpp"
 
+#include "gtfsrt/gtfs-realtime.pb.h"
+
+#include "utl/helpers/algorithm.h"
 #include "utl/read_file.h"
 #include "utl/timer.h"
+#include "utl/verify.h"
 
 #include "nigiri/rt/create_rt_timetable.h"
 #include "nigiri/rt/gtfsrt_update.h"
@@ -20,8 +34,10 @@
 #include "motis/data.h"
 #include "motis/elevators/update_elevators.h"
 #include "motis/http_req.h"
+#include "motis/offsets_cache.h"
 #include "motis/railviz.h"
 #include "motis/repeat.h"
+#include "motis/running_trips.h"
 #include "motis/rt/auser.h"
 #include "motis/rt/rt_metrics.h"
 #include "motis/tag_lookup.h"
@@ -35,14 +51,16 @@ namespace motis {
 
 asio::awaitable<ptr<elevators>> update_elevators(config const& c,
                                                  data const& d,
-                                                 n::rt_timetable& new_rtt) {
+                                                 n::rt_timetable& new_rtt,
+                                                 bool const new_rtt_is_copy) {
   utl::verify(c.has_elevators() && c.get_elevators()->url_ && c.timetable_,
               "elevator update requires settings for timetable + elevators");
   auto const res =
       co_await http_GET(boost::urls::url{*c.get_elevators()->url_},
                         c.get_elevators()->headers_.value_or(headers_t{}),
                         std::chrono::seconds{c.get_elevators()->http_timeout_});
-  co_return update_elevators(c, d, get_http_body(res), new_rtt);
+  co_return update_elevators(c, d, get_http_body(res), new_rtt,
+                             new_rtt_is_copy);
 }
 
 std::string get_dump_path(auto&& ep) {
@@ -69,6 +87,7 @@ struct gtfs_rt_endpoint {
   n::source_idx_t src_;
   std::string tag_;
   gtfsrt_metrics metrics_;
+  rt_latency_metrics latency_;
 };
 
 struct auser_endpoint {
@@ -76,22 +95,168 @@ struct auser_endpoint {
   n::source_idx_t src_;
   std::string tag_;
   vdvaus_metrics metrics_;
+  rt_latency_metrics latency_;
+};
+
+using endpoint_t = std::variant<gtfs_rt_endpoint, auser_endpoint>;
+using endpoints_t = std::vector<endpoint_t>;
+using rt_stats_t = std::variant<n::rt::statistics, n::rt::vdv_aus::statistics>;
+
+double seconds_since(std::chrono::steady_clock::time_point const start) {
+  return std::chrono::duration<double>{std::chrono::steady_clock::now() -
+                                       start}
+      .count();
+}
+
+std::shared_ptr<transit_realtime::FeedMessage const> parse_gtfsrt(
+    gtfs_rt_endpoint const& g, std::string_view body) {
+  auto const start = std::chrono::steady_clock::now();
+  auto msg = std::make_shared<transit_realtime::FeedMessage>();
+  auto const success =
+      msg->ParseFromArray(body.data(), static_cast<int>(body.size()));
+  g.latency_.parse_.Observe(seconds_since(start));
+  return success ? std::move(msg) : nullptr;
+}
+
+n::rt::statistics apply_gtfsrt(data const& d,
+                               n::rt_timetable& rtt,
+                               gtfs_rt_endpoint const& g,
+                               transit_realtime::FeedMessage const* msg) {
+  if (msg == nullptr) {
+    return n::rt::statistics{.parser_error_ = true};
+  }
+  auto const start = std::chrono::steady_clock::now();
+  auto const stats =
+      n::rt::gtfsrt_update_msg(*d.tt_, rtt, g.src_, g.tag_, *msg);
+  g.latency_.apply_.Observe(seconds_since(start));
+  return stats;
+}
+
+// RT timetable of a snapshot that nobody reads anymore. Only this allocation
+// is kept (not the indices of the snapshot): the next incremental update
+// copies into it instead of allocating a new RT timetable.
+struct spare_rtt {
+  std::mutex mutex_;
+  std::unique_ptr<n::rt_timetable> rtt_;
 };
 
-using endpoints_t = std::vector<std::variant<gtfs_rt_endpoint, auser_endpoint>>;
+// Creates the RT timetable the next update is applied to.
+std::unique_ptr<n::rt_timetable> create_rtt(
+    config const& c,
+    data& d,
+    spare_rtt& spare,
+    std::chrono::steady_clock::time_point const build_start) {
+  auto const today = std::chrono::time_point_cast<date::days>(
+      std::chrono::system_clock::now());
+  auto rtt = std::unique_ptr<n::rt_timetable>{};
+  if (c.timetable_->incremental_rt_update_) {
+    auto const current = std::atomic_load(&d.rt_);
+    {
+      auto const lock = std::scoped_lock{spare.mutex_};
+      rtt = std::move(spare.rtt_);
+    }
+    if (rtt != nullptr) {
+      *rtt = *current->rtt_;
+      d.metrics_->rt_snapshot_reused_.Increment();
+    } else {
+      rtt = std::make_unique<n::rt_timetable>(*current->rtt_);
+    }
+    d.metrics_->rt_snapshot_transports_copied_.Increment(
+        static_cast<double>(current->rtt_->n_rt_transports()));
+  } else {
+    rtt = std::make_unique<n::rt_timetable>(
+        n::rt::create_rt_timetable(*d.tt_, today));
+  }
+  d.metrics_->rt_snapshot_build_duration_seconds_copy_.Observe(
+      seconds_since(build_start));
+  return rtt;
+}
+
+// Builds the indices for `rtt` and publishes it as new RT snapshot.
+awaitable<void> publish_rt(
+    config const& c,
+    data& d,
+    std::unique_ptr<n::rt_timetable> rtt,
+    std::shared_ptr<spare_rtt> const& spare,
+    std::chrono::steady_clock::time_point const build_start) {
+  // Update lbs.
+  auto const index_start = std::chrono::steady_clock::now();
+  rtt->update_lbs(*d.tt_);
+
+  // Update real-time timetable shared pointer.
+  auto railviz_rt = std::make_unique<railviz_rt_index>(
+      *d.tt_, *rtt, c.timetable_->railviz_cache_mb_ * 1024U * 1024U,
+      d.metrics_.get());
+  auto running_trips = std::make_unique<running_trips_rt_index>(*d.tt_, *rtt);
+  d.metrics_->rt_snapshot_build_duration_seconds_index_.Observe(
+      seconds_since(index_start));
+  auto elevators = std::unique_ptr<motis::elevators>{};
+  if (c.has_elevators() && c.get_elevators()->url_) {
+    try {
+      elevators = co_await update_elevators(
+          c, d, *rtt, c.timetable_->incremental_rt_update_);
+    } catch (std::exception const& e) {
+      n::log(n::log_lvl::error, "motis.rt",
+             "elevator update failed, keeping previous elevators: {}",
+             e.what());
+      elevators = std::move(d.rt_->e_);
+    }
+  } else {
+    elevators = std::move(d.rt_->e_);
+  }
+  auto const prev_rt = std::atomic_load(&d.rt_);
+  auto const snapshot = new rt{std::move(rtt), std::move(elevators),
+                               std::move(railviz_rt), std::move(running_trips)};
+  auto const new_rt =
+      c.timetable_->reuse_rt_snapshot_memory_
+          ? std::shared_ptr<rt>{snapshot,
+                                [spare](rt* x) {
+                                  {
+                                    auto const lock =
+                                        std::scoped_lock{spare->mutex_};
+                                    spare->rtt_ = std::move(x->rtt_);
+                                  }
+                                  delete x;
+                                }}
+          : std::shared_ptr<rt>{snapshot};
+  std::atomic_store(&d.rt_, new_rt);
+  d.metrics_->rt_snapshot_build_duration_seconds_total_.Observe(
+      seconds_since(build_start));
+
+  // Drop cached offsets that depend on stops whose real-time traffic changed.
+  // This has to happen after publishing the new RT timetable (see
+  // `offsets_cache::put`).
+  if (d.offsets_cache_ != nullptr) {
+    d.offsets_cache_->invalidate(*d.tt_, prev_rt->rtt_.get(),
+                                 new_rt->rtt_.get());
+  }
+
+  d.metrics_->last_update_rt_.SetToCurrentTime();
+}
+
+// With incremental updates, the copied RT timetable already contains feeds
+// that did not change since the last update: std::nullopt for these.
+awaitable<std::optional<http_response>> fetch_feed(
+    config const& c,
+    boost::urls::url const& url,
+    headers_t const& headers,
+    std::chrono::seconds const timeout) {
+  if (c.timetable_->incremental_rt_update_) {
+    co_return co_await http_GET_if_modified(url, headers, timeout);
+  }
+  co_return co_await http_GET(url, headers, timeout);
+}
 
 awaitable<void> update_rt(config const& c,
                           data& d,
                           bool const dump_rt,
-                          endpoints_t const& endpoints) {
+                          endpoints_t const& endpoints,
+                          std::shared_ptr<spare_rtt> const& spare) {
   auto executor = co_await asio::this_coro::executor;
-  // Create new real-time timetable.
-  auto const today = std::chrono::time_point_cast<date::days>(
-      std::chrono::system_clock::now());
-  auto rtt = std::make_unique<n::rt_timetable>(
-      c.timetable_->incremental_rt_update_
-          ? n::rt_timetable{*d.rt_->rtt_}
-          : n::rt::create_rt_timetable(*d.tt_, today));
+  auto const build_start = std::chrono::steady_clock::now();
+
+  auto rtt = create_rtt(c, d, *spare, build_start);
+  auto const apply_start = std::chrono::steady_clock::now();
 
   // Schedule updates for each real-time endpoint.
   auto const timeout = std::chrono::seconds{c.timetable_->http_timeout_};
@@ -151,25 +316,32 @@ awaitable<void> update_rt(config const& c,
         [&](std::variant<gtfs_rt_endpoint, auser_endpoint> const& x) {
           return boost::asio::co_spawn(
               executor,
-              [&]() -> awaitable<std::variant<n::rt::statistics,
-                                              n::rt::vdv_aus::statistics>> {
-                auto ret = std::variant<n::rt::statistics,
-                                        n::rt::vdv_aus::statistics>{};
+              [&]() -> awaitable<std::optional<rt_stats_t>> {
+                // std::nullopt: unchanged feed, already in the copied RT
+                // timetable (incremental updates only)
+                auto ret = std::optional<rt_stats_t>{};
                 co_await std::visit(
                     utl::overloaded{
                         [&](gtfs_rt_endpoint const& g) -> awaitable<void> {
                           g.metrics_.updates_requested_.Increment();
                           try {
-                            auto const res = co_await http_GET(
-                                boost::urls::url{g.ep_.url_},
+                            auto const fetch_start =
+                                std::chrono::steady_clock::now();
+                            auto const res = co_await fetch_feed(
+                                c, boost::urls::url{g.ep_.url_},
                                 g.ep_.headers_.value_or(headers_t{}), timeout);
-                            auto const body = get_http_body(res);
+                            g.latency_.fetch_.Observe(
+                                seconds_since(fetch_start));
+                            if (!res.has_value()) {
+                              co_return;
+                            }
+                            auto const body = get_http_body(*res);
                             if (dump_rt) {
                               std::ofstream{get_dump_path(g)}.write(
                                   body.c_str(), static_cast<long>(body.size()));
                             }
-                            ret = n::rt::gtfsrt_update_buf(*d.tt_, *rtt, g.src_,
-                                                           g.tag_, body);
+                            ret = apply_gtfsrt(d, *rtt, g,
+                                               parse_gtfsrt(g, body).get());
                           } catch (std::exception const& e) {
                             g.metrics_.updates_error_.Increment();
                             n::log(n::log_lvl::error, "motis.rt",
@@ -187,15 +359,26 @@ awaitable<void> update_rt(config const& c,
                                 boost::urls::url{auser.fetch_url(a.ep_.url_)};
                             fmt::println("[auser] fetch url: {}",
                                          fetch_url.c_str());
-                            auto const res = co_await http_GET(
-                                fetch_url, a.ep_.headers_.value_or(headers_t{}),
-                                timeout);
-                            auto body = get_http_body(res);
+                            auto const fetch_start =
+                                std::chrono::steady_clock::now();
+                            auto const res = co_await fetch_feed(
+                                c, fetch_url,
+                                a.ep_.headers_.value_or(headers_t{}), timeout);
+                            a.latency_.fetch_.Observe(
+                                seconds_since(fetch_start));
+                            if (!res.has_value()) {
+                              co_return;
+                            }
+                            auto body = get_http_body(*res);
                             if (dump_rt) {
                               std::ofstream{get_dump_path(a)}.write(
                                   body.c_str(), static_cast<long>(body.size()));
                             }
+                            auto const apply_start =
+                                std::chrono::steady_clock::now();
                             ret = auser.consume_update(body, *rtt, true);
+                            a.latency_.apply_.Observe(
+                                seconds_since(apply_start));
                           } catch (std::exception const& e) {
                             a.metrics_.updates_error_.Increment();
                             n::log(
@@ -220,6 +403,15 @@ awaitable<void> update_rt(config const& c,
 
     //  Print statistics.
     for (auto const [ep, ex, s] : utl::zip(endpoints, exceptions, stats)) {
+      if (!ex && !s.has_value()) {
+        std::visit(
+            [](auto const& x) {
+              n::log(n::log_lvl::info, "motis.rt",
+                     "RT feed unchanged: tag={}, url={}", x.tag_, x.ep_.url_);
+            },
+            ep);
+        continue;
+      }
       std::visit(
           utl::overloaded{
               [&](gtfs_rt_endpoint const& g) {
@@ -230,12 +422,12 @@ awaitable<void> update_rt(config const& c,
 
                   g.metrics_.updates_successful_.Increment();
                   g.metrics_.last_update_timestamp_.SetToCurrentTime();
-                  g.metrics_.update(std::get<n::rt::statistics>(s));
+                  g.metrics_.update(std::get<n::rt::statistics>(*s));
 
                   n::log(n::log_lvl::info, "motis.rt",
                          "GTFS-RT update stats for tag={}, url={}: {}", g.tag_,
                          g.ep_.url_,
-                         fmt::streamed(std::get<n::rt::statistics>(s)));
+                         fmt::streamed(std::get<n::rt::statistics>(*s)));
                 } catch (std::exception const& e) {
                   g.metrics_.updates_error_.Increment();
                   n::log(n::log_lvl::error, "motis.rt",
@@ -251,13 +443,13 @@ awaitable<void> update_rt(config const& c,
 
                   a.metrics_.updates_successful_.Increment();
                   a.metrics_.last_update_timestamp_.SetToCurrentTime();
-                  a.metrics_.update(std::get<n::rt::vdv_aus::statistics>(s));
+                  a.metrics_.update(std::get<n::rt::vdv_aus::statistics>(*s));
 
                   n::log(
                       n::log_lvl::info, "motis.rt",
                       "VDV AUS update stats for tag={}, url={}:\n{}", a.tag_,
                       a.ep_.url_,
-                      fmt::streamed(std::get<n::rt::vdv_aus::statistics>(s)));
+                      fmt::streamed(std::get<n::rt::vdv_aus::statistics>(*s)));
                 } catch (std::exception const& e) {
                   a.metrics_.updates_error_.Increment();
                   n::log(n::log_lvl::error, "motis.rt",
@@ -269,29 +461,249 @@ awaitable<void> update_rt(config const& c,
     }
   }
 
-  // Update lbs.
-  rtt->update_lbs(*d.tt_);
+  d.metrics_->rt_snapshot_build_duration_seconds_apply_.Observe(
+      seconds_since(apply_start));
 
-  // Update real-time timetable shared pointer.
-  auto railviz_rt = std::make_unique<railviz_rt_index>(*d.tt_, *rtt);
-  auto elevators = std::unique_ptr<motis::elevators>{};
-  if (c.has_elevators() && c.get_elevators()->url_) {
-    try {
-      elevators = co_await update_elevators(c, d, *rtt);
-    } catch (std::exception const& e) {
-      n::log(n::log_lvl::error, "motis.rt",
-             "elevator update failed, keeping previous elevators: {}",
-             e.what());
-      elevators = std::move(d.rt_->e_);
+  co_await publish_rt(c, d, std::move(rtt), spare, build_start);
+}
+
+// State of an endpoint in the staged update mode (see `update_rt_staged`).
+struct staged_feed {
+  bool in_flight_{false};
+  bool has_update_{false};
+  std::string body_;  // VDV AUS
+  std::shared_ptr<transit_realtime::FeedMessage const> msg_;  // GTFS-RT
+
+  // Without incremental updates, each RT timetable starts from scratch:
+  // the latest GTFS-RT message is applied again if no newer one arrived.
+  std::shared_ptr<transit_realtime::FeedMessage const> last_msg_;
+};
+
+struct rt_pipeline {
+  rt_pipeline(asio::any_io_executor const& executor,
+              std::size_t const n_endpoints)
+      : feeds_(n_endpoints),
+        fetch_done_{executor},
+        workers_{std::clamp(std::size_t{std::thread::hardware_concurrency()},
+                            std::size_t{1U},
+                            std::max(n_endpoints, std::size_t{1U}))} {}
+
+  bool in_flight() const {
+    return utl::any_of(feeds_,
+                       [](staged_feed const& f) { return f.in_flight_; });
+  }
+
+  // Fetches are detached coroutines referencing this pipeline (and the
+  // endpoints): wait for them before destroying it.
+  awaitable<void> join() {
+    while (in_flight()) {
+      fetch_done_.expires_at(asio::steady_timer::time_point::max());
+      auto ec = boost::system::error_code{};
+      co_await fetch_done_.async_wait(
+          asio::redirect_error(asio::use_awaitable, ec));
     }
-  } else {
-    elevators = std::move(d.rt_->e_);
   }
-  auto new_rt = std::make_shared<rt>(std::move(rtt), std::move(elevators),
-                                     std::move(railviz_rt));
-  std::atomic_store(&d.rt_, std::move(new_rt));
 
-  d.metrics_->last_update_rt_.SetToCurrentTime();
+  std::vector<staged_feed> feeds_;
+  asio::steady_timer fetch_done_;
+  asio::thread_pool workers_;
+};
+
+awaitable<void> fetch_staged(config const& c,
+                             data& d,
+                             bool const dump_rt,
+                             endpoint_t const& x,
+                             staged_feed& feed,
+                             rt_pipeline& p) {
+  auto const timeout = std::chrono::seconds{c.timetable_->http_timeout_};
+  try {
+    co_await std::visit(
+        utl::overloaded{
+            [&](gtfs_rt_endpoint const& g) -> awaitable<void> {
+              g.metrics_.updates_requested_.Increment();
+              auto const fetch_start = std::chrono::steady_clock::now();
+              // Unchanged: nothing to apply (without incremental updates,
+              // the last message is applied again, see `last_msg_`).
+              auto const res = co_await http_GET_if_modified(
+                  boost::urls::url{g.ep_.url_},
+                  g.ep_.headers_.value_or(headers_t{}), timeout);
+              g.latency_.fetch_.Observe(seconds_since(fetch_start));
+              if (!res.has_value()) {
+                co_return;
+              }
+              auto const body = get_http_body(*res);
+              if (dump_rt) {
+                std::ofstream{get_dump_path(g)}.write(
+                    body.c_str(), static_cast<long>(body.size()));
+              }
+              using msg_ptr_t =
+                  std::shared_ptr<transit_realtime::FeedMessage const>;
+              auto msg = co_await asio::co_spawn(
+                  p.workers_,
+                  [&]() -> awaitable<msg_ptr_t> {
+                    co_return parse_gtfsrt(g, body);
+                  },
+                  asio::use_awaitable);
+              utl::verify(msg != nullptr, "GTFS-RT parser error");
+              feed.msg_ = std::move(msg);
+              feed.has_update_ = true;
+            },
+            [&](auser_endpoint const& a) -> awaitable<void> {
+              a.metrics_.updates_requested_.Increment();
+              auto& auser = d.auser_->at(a.ep_.url_);
+              auto const fetch_start = std::chrono::steady_clock::now();
+              auto const res = co_await http_GET_if_modified(
+                  boost::urls::url{auser.fetch_url(a.ep_.url_)},
+                  a.ep_.headers_.value_or(headers_t{}), timeout);
+              a.latency_.fetch_.Observe(seconds_since(fetch_start));
+              if (!res.has_value()) {
+                co_return;
+              }
+              feed.body_ = get_http_body(*res);
+              if (dump_rt) {
+                std::ofstream{get_dump_path(a)}.write(
+                    feed.body_.c_str(), static_cast<long>(feed.body_.size()));
+              }
+              feed.has_update_ = true;
+            }},
+        x);
+  } catch (std::exception const& e) {
+    std::visit(
+        [&](auto const& ep) {
+          ep.metrics_.updates_error_.Increment();
+          n::log(n::log_lvl::error, "motis.rt",
+                 "RT FETCH ERROR: tag={}, url={}, error={}", ep.tag_,
+                 ep.ep_.url_, e.what());
+        },
+        x);
+  }
+  feed.in_flight_ = false;
+  p.fetch_done_.cancel();
+}
+
+// Publishes a new RT snapshot at the latest `rt_publish_deadline` seconds after
+// the start of the update. Each feed is fetched and parsed independently of
+// the update cycle: feeds that arrive after the deadline are applied with the
+// next update instead of delaying all other feeds.
+awaitable<void> update_rt_staged(config const& c,
+                                 data& d,
+                                 bool const dump_rt,
+                                 endpoints_t const& endpoints,
+                                 rt_pipeline& p,
+                                 std::shared_ptr<spare_rtt> const& spare) {
+  auto executor = co_await asio::this_coro::executor;
+  auto const deadline =
+      std::chrono::steady_clock::now() +
+      std::chrono::seconds{c.timetable_->rt_publish_deadline_.value()};
+
+  for (auto const [ep, feed] : utl::zip(endpoints, p.feeds_)) {
+    if (!feed.in_flight_ && !feed.has_update_) {
+      feed.in_flight_ = true;
+      asio::co_spawn(executor, fetch_staged(c, d, dump_rt, ep, feed, p),
+                     asio::detached);
+    }
+  }
+
+  while (p.in_flight() && std::chrono::steady_clock::now() < deadline) {
+    p.fetch_done_.expires_at(deadline);
+    auto ec = boost::system::error_code{};
+    co_await p.fetch_done_.async_wait(
+        asio::redirect_error(asio::use_awaitable, ec));
+  }
+
+  struct staged_update {
+    std::shared_ptr<transit_realtime::FeedMessage const> msg_;
+    std::string body_;
+    bool is_new_{false};
+    std::optional<rt_stats_t> stats_;
+  };
+  auto updates = utl::to_vec(p.feeds_, [&](staged_feed& f) {
+    auto u = staged_update{};
+    if (f.has_update_) {
+      u.msg_ = std::move(f.msg_);
+      u.body_ = std::move(f.body_);
+      u.is_new_ = true;
+      f.has_update_ = false;
+      if (u.msg_ != nullptr) {
+        f.last_msg_ = u.msg_;
+      }
+    } else if (!c.timetable_->incremental_rt_update_) {
+      u.msg_ = f.last_msg_;
+    }
+    return u;
+  });
+
+  auto const build_start = std::chrono::steady_clock::now();
+  auto rtt = create_rtt(c, d, *spare, build_start);
+  auto const apply_start = std::chrono::steady_clock::now();
+
+  // Apply on the worker pool: fetches of slow feeds continue meanwhile.
+  co_await asio::co_spawn(
+      p.workers_,
+      [&]() -> awaitable<void> {
+        for (auto const [ep, u] : utl::zip(endpoints, updates)) {
+          try {
+            std::visit(
+                utl::overloaded{
+                    [&](gtfs_rt_endpoint const& g) {
+                      if (u.msg_ != nullptr) {
+                        u.stats_ = apply_gtfsrt(d, *rtt, g, u.msg_.get());
+                      }
+                    },
+                    [&](auser_endpoint const& a) {
+                      if (u.is_new_) {
+                        auto const start = std::chrono::steady_clock::now();
+                        u.stats_ = d.auser_->at(a.ep_.url_)
+                                       .consume_update(u.body_, *rtt, true);
+                        a.latency_.apply_.Observe(seconds_since(start));
+                      }
+                    }},
+                ep);
+          } catch (std::exception const& e) {
+            std::visit(
+                [&](auto const& x) {
+                  x.metrics_.updates_error_.Increment();
+                  n::log(n::log_lvl::error, "motis.rt",
+                         "RT update failed: tag={}, url={}, error={}", x.tag_,
+                         x.ep_.url_, e.what());
+                },
+                ep);
+          }
+        }
+        co_return;
+      },
+      asio::use_awaitable);
+
+  for (auto const [ep, u] : utl::zip(endpoints, updates)) {
+    if (!u.is_new_ || !u.stats_.has_value()) {
+      continue;
+    }
+    std::visit(
+        utl::overloaded{
+            [&](gtfs_rt_endpoint const& g) {
+              auto const& s = std::get<n::rt::statistics>(*u.stats_);
+              g.metrics_.updates_successful_.Increment();
+              g.metrics_.last_update_timestamp_.SetToCurrentTime();
+              g.metrics_.update(s);
+              n::log(n::log_lvl::info, "motis.rt",
+                     "GTFS-RT update stats for tag={}, url={}: {}", g.tag_,
+                     g.ep_.url_, fmt::streamed(s));
+            },
+            [&](auser_endpoint const& a) {
+              auto const& s = std::get<n::rt::vdv_aus::statistics>(*u.stats_);
+              a.metrics_.updates_successful_.Increment();
+              a.metrics_.last_update_timestamp_.SetToCurrentTime();
+              a.metrics_.update(s);
+              n::log(n::log_lvl::info, "motis.rt",
+                     "VDV AUS update stats for tag={}, url={}:\n{}", a.tag_,
+                     a.ep_.url_, fmt::streamed(s));
+            }},
+        ep);
+  }
+
+  d.metrics_->rt_snapshot_build_duration_seconds_apply_.Observe(
+      seconds_since(apply_start));
+  co_await publish_rt(c, d, std::move(rtt), spare, build_start);
 }
 
 void run_rt_update(boost::asio::io_context& ioc, config const& c, data& d) {
@@ -317,14 +729,16 @@ void run_rt_update(boost::asio::io_context& ioc, config const& c, data& d) {
                 switch (ep.protocol_) {
                   case config::timetable::dataset::rt::protocol::gtfsrt:
                     endpoints.push_back(gtfs_rt_endpoint{
-                        ep, src, tag, gtfsrt_metrics{tag, metric_families}});
+                        ep, src, tag, gtfsrt_metrics{tag, metric_families},
+                        rt_latency_metrics{tag, metric_families}});
                     break;
                   case config::timetable::dataset::rt::protocol::siri_json:
                   case config::timetable::dataset::rt::protocol::siri:
                     [[fallthrough]];
                   case config::timetable::dataset::rt::protocol::auser:
                     endpoints.push_back(auser_endpoint{
-                        ep, src, tag, vdvaus_metrics{tag, metric_families}});
+                        ep, src, tag, vdvaus_metrics{tag, metric_families},
+                        rt_latency_metrics{tag, metric_families}});
                     break;
                 }
               }
@@ -333,9 +747,31 @@ void run_rt_update(boost::asio::io_context& ioc, config const& c, data& d) {
           return endpoints;
         }();
 
-        co_await repeat(std::chrono::seconds{c.timetable_->update_interval_},
-                        "rt update",
-                        [&] { return update_rt(c, d, dump_rt, endpoints); });
+        auto const spare = std::make_shared<spare_rtt>();
+        if (c.timetable_->rt_publish_deadline_.has_value() &&
+            !c.timetable_->canned_rt_) {
+          auto pipeline = rt_pipeline{executor, endpoints.size()};
+          auto error = std::exception_ptr{};
+          try {
+            co_await repeat(
+                std::chrono::seconds{c.timetable_->update_interval_},
+                "rt update", [&] {
+                  return update_rt_staged(c, d, dump_rt, endpoints, pipeline,
+                                          spare);
+                });
+          } catch (...) {
+            error = std::current_exception();
+          }
+          co_await pipeline.join();
+          if (error) {
+            std::rethrow_exception(error);
+          }
+        } else {
+          co_await repeat(
+              std::chrono::seconds{c.timetable_->update_interval_},
+              "rt update",
+              [&] { return update_rt(c, d, dump_rt, endpoints, spare); });
+        }
       },
       boost::asio::detached);
 }
@@ -0,0 +1,194 @@
+#include "motis/running_trips.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "nigiri/rt/frun.h"
+#include "nigiri/rt/rt_timetable.h"
+#include "nigiri/timetable.h"
+
+namespace n = nigiri;
+
+namespace motis {
+
+constexpr auto const kMinutesPerHour = std::int64_t{60};
+constexpr auto const kMinutesPerDay = std::int64_t{1440};
+
+std::int64_t floor_div(std::int64_t const a, std::int64_t const b) {
+  return a / b - ((a % b != 0) && ((a < 0) != (b < 0)) ? 1 : 0);
+}
+
+n::unixtime_t timetable_begin(n::timetable const& tt) {
+  return std::chrono::time_point_cast<n::unixtime_t::duration>(
+      tt.internal_interval_days().from_);
+}
+
+running_trips_static_index::running_trips_static_index(
+    n::timetable const& tt) {
+  auto const base = timetable_begin(tt);
+  for (auto r = n::route_idx_t{0U}; r != tt.n_routes(); ++r) {
+    auto const last =
+        static_cast<n::stop_idx_t>(tt.route_location_seq_[r].size() - 1U);
+    for (auto const t_idx : tt.route_transport_ranges_[r]) {
+      auto const t = n::transport{t_idx, n::day_idx_t{0U}};
+      auto const provider = n::rt::frun::from_t(tt, nullptr, t)[0]
+                                .get_provider_idx(n::event_type::kDep);
+      if (provider == n::provider_idx_t::invalid()) {
+        continue;
+      }
+
+      auto const from = std::clamp(
+          static_cast<std::int64_t>(
+              (tt.event_time(t, 0U, n::event_type::kDep) - base).count()),
+          std::int64_t{0},
+          std::int64_t{std::numeric_limits<std::uint16_t>::max() - 1});
+      auto const to = std::clamp(
+          static_cast<std::int64_t>(
+              (tt.event_time(t, last, n::event_type::kArr) - base).count()) +
+              1,
+          from + 1, std::int64_t{std::numeric_limits<std::uint16_t>::max()});
+
+      auto const e = entry{.t_ = t_idx,
+                           .provider_ = provider,
+                           .from_ = static_cast<std::uint16_t>(from),
+                           .to_ = static_cast<std::uint16_t>(to)};
+      auto const last_bucket =
+          static_cast<std::size_t>((to - 1) / kMinutesPerHour);
+      if (buckets_.size() <= last_bucket) {
+        buckets_.resize(last_bucket + 1U);
+      }
+      for (auto h = static_cast<std::size_t>(from / kMinutesPerHour);
+           h <= last_bucket; ++h) {
+        buckets_[h].push_back(e);
+      }
+      max_days_ = std::max(max_days_, (to - 1) / kMinutesPerDay);
+    }
+  }
+}
+
+void running_trips_static_index::for_each_running(
+    n::timetable const& tt,
+    n::rt_timetable const* rtt,
+    n::interval<n::unixtime_t> const interval,
+    std::function<void(n::provider_idx_t)> const& fn) const {
+  if (buckets_.empty() || interval.from_ >= interval.to_) {
+    return;
+  }
+
+  auto const base = timetable_begin(tt);
+  auto const rel_from =
+      static_cast<std::int64_t>((interval.from_ - base).count());
+  auto const rel_to = static_cast<std::int64_t>((interval.to_ - base).count());
+  auto const first_day = std::max(
+      std::int64_t{0}, floor_div(rel_from, kMinutesPerDay) - max_days_);
+  auto const last_day = std::min(std::int64_t{n::kMaxDays - 1},
+                                 floor_div(rel_to - 1, kMinutesPerDay));
+  auto const n_buckets = static_cast<std::int64_t>(buckets_.size());
+
+  for (auto day = first_day; day <= last_day; ++day) {
+    // Interval relative to midnight of the service day.
+    auto const from = rel_from - day * kMinutesPerDay;
+    auto const to = rel_to - day * kMinutesPerDay;
+    if (to <= 0) {
+      continue;
+    }
+
+    auto const first_bucket =
+        std::max(from, std::int64_t{0}) / kMinutesPerHour;
+    auto const last_bucket =
+        std::min((to - 1) / kMinutesPerHour, n_buckets - 1);
+    for (auto h = first_bucket; h <= last_bucket; ++h) {
+      for (auto const& e : buckets_[static_cast<std::size_t>(h)]) {
+        if (h != first_bucket && e.from_ / kMinutesPerHour != h) {
+          continue;  // already seen in a previous bucket
+        }
+        if (!(e.from_ < to && from < e.to_)) {
+          continue;
+        }
+        auto const& traffic_days =
+            rtt == nullptr
+                ? tt.bitfields_[tt.transport_traffic_days_[e.t_]]
+                : rtt->bitfields_[rtt->transport_traffic_days_[e.t_]];
+        if (traffic_days.test(static_cast<std::size_t>(day))) {
+          fn(e.provider_);
+        }
+      }
+    }
+  }
+}
+
+running_trips_rt_index::running_trips_rt_index(n::timetable const& tt,
+                                               n::rt_timetable const& rtt)
+    : origin_{timetable_begin(tt)} {
+  auto const hour = [&](n::unixtime_t const t) {
+    return floor_div((t - origin_).count(), kMinutesPerHour);
+  };
+
+  auto entries = std::vector<entry>{};
+  for (auto rt_t = n::rt_transport_idx_t{0U}; rt_t < rtt.n_rt_transports();
+       ++rt_t) {
+    auto const fr = n::rt::frun::from_rt(tt, &rtt, rt_t);
+    if (!fr.is_scheduled()) {
+      continue;
+    }
+    auto const provider = fr[0].get_provider_idx(n::event_type::kDep);
+    auto const active = n::interval{
+        fr[0].time(n::event_type::kDep),
+        fr[static_cast<n::stop_idx_t>(fr.stop_range_.size() - 1)].time(
+            n::event_type::kArr) +
+            n::unixtime_t::duration{1}};
+    if (provider != n::provider_idx_t::invalid() &&
+        active.from_ < active.to_) {
+      entries.push_back({.provider_ = provider, .active_ = active});
+    }
+  }
+
+  if (entries.empty()) {
+    return;
+  }
+
+  first_hour_ = hour(std::ranges::min(entries, {}, [](entry const& e) {
+                       return e.active_.from_;
+                     }).active_.from_);
+  auto const last_hour =
+      hour(std::ranges::max(entries, {}, [](entry const& e) {
+             return e.active_.to_;
+           }).active_.to_ -
+           n::unixtime_t::duration{1});
+  buckets_.resize(static_cast<std::size_t>(last_hour - first_hour_ + 1));
+  for (auto const& e : entries) {
+    for (auto h = hour(e.active_.from_);
+         h <= hour(e.active_.to_ - n::unixtime_t::duration{1}); ++h) {
+      buckets_[static_cast<std::size_t>(h - first_hour_)].push_back(e);
+    }
+  }
+}
+
+void running_trips_rt_index::for_each_running(
+    n::interval<n::unixtime_t> const interval,
+    std::function<void(n::provider_idx_t)> const& fn) const {
+  if (buckets_.empty() || interval.from_ >= interval.to_) {
+    return;
+  }
+
+  auto const hour = [&](n::unixtime_t const t) {
+    return floor_div((t - origin_).count(), kMinutesPerHour) - first_hour_;
+  };
+  auto const first_bucket = std::max(hour(interval.from_), std::int64_t{0});
+  auto const last_bucket =
+      std::min(hour(interval.to_ - n::unixtime_t::duration{1}),
+               static_cast<std::int64_t>(buckets_.size()) - 1);
+  for (auto h = first_bucket; h <= last_bucket; ++h) {
+    for (auto const& e : buckets_[static_cast<std::size_t>(h)]) {
+      if (h != first_bucket && hour(e.active_.from_) != h) {
+        continue;  // already seen in a previous bucket
+      }
+      if (e.active_.overlaps(interval)) {
+        fn(e.provider_);
+      }
+    }
+  }
+}
+
+}  // namespace motis
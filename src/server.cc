@@ -1,3 +1,4 @@
+#include <memory>
 #include <string_view>
 
 #include "boost/asio/io_context.hpp"
@@ -20,7 +21,9 @@
 #include "motis/ctx_data.h"
 #include "motis/ctx_exec.h"
 #include "motis/data.h"
+#include "motis/http_req.h"
 #include "motis/motis_instance.h"
+#include "motis/request_scheduler.h"
 
 namespace fs = std::filesystem;
 
@@ -28,8 +31,12 @@ namespace motis {
 
 int server(data d, config const& c, std::string_view const motis_version) {
   auto scheduler = ctx::scheduler<ctx_data>{};
-  auto m = motis_instance{ctx_exec{scheduler.runner_.ios(), scheduler}, d, c,
-                          motis_version};
+  auto req_sched = request_scheduler::is_enabled(c)
+                       ? std::make_unique<request_scheduler>(c, *d.metrics_)
+                       : nullptr;
+  auto m = motis_instance{
+      ctx_exec{scheduler.runner_.ios(), scheduler, req_sched.get()}, d, c,
+      motis_version};
 
   auto lbs = std::vector<net::lb>{};
   if (c.server_.value_or(config::server{}).lbs_) {
@@ -41,7 +48,18 @@ int server(data d, config const& c, std::string_view const motis_version) {
 
   auto s = net::web_server{scheduler.runner_.ios()};
   s.set_timeout(std::chrono::minutes{5});
-  s.on_http_request(m.qr_);
+  if (req_sched != nullptr) {
+    s.on_http_request([&](net::web_server::http_req_t req,
+                          net::web_server::http_res_cb_t const& cb,
+                          bool const is_ssl) {
+      set_current_request_class(
+          classify_request(std::string_view{req.target()}));
+      m.qr_(std::move(req), cb, is_ssl);
+      set_current_request_class(request_class::kInteractive);
+    });
+  } else {
+    s.on_http_request(m.qr_);
+  }
 
   auto ec = boost::system::error_code{};
   auto const server_config = c.server_.value_or(config::server{});
@@ -67,6 +85,7 @@ int server(data d, config const& c, std::string_view const motis_version) {
       c.n_threads(), server_config.host_, server_config.port_,
       server_config.port_);
 
+  set_http_metrics(d.metrics_.get());
   for (auto& lb : lbs) {
     lb.run();
   }
@@ -74,6 +93,7 @@ int server(data d, config const& c, std::string_view const motis_version) {
   m.run(d, c);
   scheduler.runner_.run(c.n_threads());
   m.join();
+  set_http_metrics(nullptr);
 
   return 0;
 }
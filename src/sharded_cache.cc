@@ -0,0 +1,38 @@
+#include "motis/sharded_cache.h"
+
+#include <string>
+
+#include "prometheus/counter.h"
+
+#include "motis/metrics_registry.h"
+
+namespace motis {
+
+void cache_metrics::hit() const {
+  if (hits_ != nullptr) {
+    hits_->Increment();
+  }
+}
+
+void cache_metrics::miss() const {
+  if (misses_ != nullptr) {
+    misses_->Increment();
+  }
+}
+
+void cache_metrics::eviction() const {
+  if (evictions_ != nullptr) {
+    evictions_->Increment();
+  }
+}
+
+cache_metrics make_cache_metrics(metrics_registry const& m,
+                                 std::string_view const name) {
+  auto const cache = std::string{name};
+  return {
+      .hits_ = &m.cache_requests_.Add({{"cache", cache}, {"result", "hit"}}),
+      .misses_ = &m.cache_requests_.Add({{"cache", cache}, {"result", "miss"}}),
+      .evictions_ = &m.cache_evictions_.Add({{"cache", cache}})};
+}
+
+}  // namespace motis
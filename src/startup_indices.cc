@@ -0,0 +1,75 @@
+#include "motis/startup_indices.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "utl/helpers/algorithm.h"
+
+#include "motis/config.h"
+#include "motis/hashes.h"
+
+namespace fs = std::filesystem;
+
+namespace motis {
+
+fs::path location_rtree_path(fs::path const& data_path,
+                             fs::path const& tt_file) {
+  return data_path / (tt_file.stem().generic_string() + "_location_rtree.bin");
+}
+
+fs::path elevator_nodes_path(fs::path const& data_path) {
+  return data_path / "elevator_nodes.bin";
+}
+
+fs::path railviz_static_path(fs::path const& data_path) {
+  return data_path / "railviz_static.bin";
+}
+
+bool indices_up_to_date(fs::path const& data_path, config const& c) {
+  auto const indices = read_hashes(data_path, "indices");
+  auto const [ver_key, ver] = indices_version();
+  if (auto const it = indices.find(ver_key);
+      it == end(indices) || it->second != ver) {
+    return false;
+  }
+
+  auto deps = std::vector<std::string>{};
+  if (c.timetable_.has_value()) {
+    deps.emplace_back("tt");
+    if (c.timetable_->route_shapes_.has_value()) {
+      deps.emplace_back("route_shapes");
+    }
+  }
+  if (c.use_street_routing()) {
+    deps.emplace_back("osr");
+  }
+  if (c.osr_footpath_ && c.timetable_.has_value()) {
+    deps.emplace_back("osr_footpath");
+  }
+
+  return utl::all_of(deps, [&](std::string const& dep) {
+    return utl::all_of(read_hashes(data_path, dep), [&](auto const& entry) {
+      auto const it = indices.find(entry.first);
+      return it != end(indices) && it->second == entry.second;
+    });
+  });
+}
+
+void write_elevator_nodes(fs::path const& p,
+                          hash_set<osr::node_idx_t> const& nodes) {
+  auto sorted = cista::offset::vector<osr::node_idx_t>{};
+  sorted.reserve(nodes.size());
+  for (auto const n : nodes) {
+    sorted.push_back(n);
+  }
+  std::ranges::sort(sorted);
+  write_mapped(p, sorted);
+}
+
+hash_set<osr::node_idx_t> read_elevator_nodes(fs::path const& p) {
+  auto const nodes = read_mapped<cista::offset::vector<osr::node_idx_t>>(p);
+  return {begin(*nodes), end(*nodes)};
+}
+
+}  // namespace motis
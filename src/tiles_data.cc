@@ -0,0 +1,150 @@
+#include "motis/tiles_data.h"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+#include "boost/asio/post.hpp"
+
+#include "cista/hash.h"
+
+#include "fmt/format.h"
+
+#include "osmium/io/pbf_input.hpp"
+#include "osmium/io/reader.hpp"
+
+#include "prometheus/histogram.h"
+
+#include "tiles/fixed/convert.h"
+#include "tiles/fixed/fixed_geometry.h"
+#include "tiles/perf_counter.h"
+
+#include "nigiri/timetable.h"
+
+#include "motis/data.h"
+#include "motis/metrics_registry.h"
+
+namespace motis {
+
+rendered_tile render_tile(tiles_data& d, geo::tile const& t) {
+  auto const start = std::chrono::steady_clock::now();
+  auto pc = ::tiles::null_perf_counter{};
+  auto body =
+      ::tiles::get_tile(d.db_handle_, d.pack_handle_, d.render_ctx_, t, pc)
+          .value_or("");
+  if (d.metrics_ != nullptr) {
+    d.metrics_->tiles_render_duration_seconds_
+        .Add({{"zoom", std::to_string(t.z_)}},
+             prometheus::Histogram::BucketBoundaries{
+                 0.001, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5})
+        .Observe(std::chrono::duration<double>{
+            std::chrono::steady_clock::now() - start}
+                     .count());
+  }
+  auto etag = fmt::format(R"("{:x}")", cista::hash(body));
+  return {.body_ = std::move(body), .etag_ = std::move(etag)};
+}
+
+// Only reads the file header, not the data blocks.
+std::optional<geo::box> osm_header_box(std::filesystem::path const& path) {
+  try {
+    auto reader =
+        osmium::io::Reader{path.string(), osmium::osm_entity_bits::nothing};
+    auto const box = reader.header().box();
+    reader.close();
+    if (box.valid()) {
+      return geo::box{{box.bottom_left().lat(), box.bottom_left().lon()},
+                      {box.top_right().lat(), box.top_right().lon()}};
+    }
+  } catch (std::exception const&) {
+    // missing file or not a PBF file: fall back to the timetable stops
+  }
+  return std::nullopt;
+}
+
+geo::box tiles_prewarm_area(data const& d) {
+  if (d.config_.osm_.has_value()) {
+    if (auto const box = osm_header_box(*d.config_.osm_); box.has_value()) {
+      return *box;
+    }
+  }
+
+  auto area = geo::box{};
+  if (d.tt_ != nullptr) {
+    for (auto const& pos : d.tt_->locations_.coordinates_) {
+      area.extend(pos);
+    }
+  }
+  return area.min_.lat_ > area.max_.lat_
+             ? geo::box{{-90.0, -180.0}, {90.0, 180.0}}
+             : area;
+}
+
+tiles_data::tiles_data(std::string const& path,
+                       std::size_t const db_size,
+                       std::size_t const cache_size,
+                       std::size_t const low_zoom_cache_size,
+                       metrics_registry const* metrics)
+    : db_env_{::tiles::make_tile_database(path.c_str(), db_size)},
+      db_handle_{db_env_},
+      render_ctx_{::tiles::make_render_ctx(db_handle_)},
+      pack_handle_{path.c_str()},
+      metrics_{metrics},
+      low_zoom_cache_{low_zoom_cache_size,
+                      metrics == nullptr
+                          ? cache_metrics{}
+                          : make_cache_metrics(*metrics, "tiles_low_zoom")},
+      high_zoom_cache_{cache_size,
+                       metrics == nullptr
+                           ? cache_metrics{}
+                           : make_cache_metrics(*metrics, "tiles")} {}
+
+std::shared_ptr<rendered_tile> tiles_data::get_tile(geo::tile const& t) {
+  auto& cache = t.z_ <= kTilesLowZoomMax ? low_zoom_cache_ : high_zoom_cache_;
+  return cache.get_or_compute(tile_key{t.x_, t.y_, t.z_}, [&]() {
+    return std::make_shared<rendered_tile>(render_tile(*this, t));
+  });
+}
+
+void tiles_data::prewarm(boost::asio::io_context& ioc,
+                         geo::box const& area,
+                         unsigned const max_zoom) {
+  auto const a = ::tiles::latlng_to_fixed(area.min_);
+  auto const b = ::tiles::latlng_to_fixed(area.max_);
+  for (auto z = 0U; z <= std::min(max_zoom, kTilesLowZoomMax); ++z) {
+    auto const tile_coord = [&](::tiles::fixed_coord_t const c) {
+      auto const extent = static_cast<::tiles::fixed_coord_t>(
+          ::tiles::kTileSize * (1ULL << (::tiles::kMaxZoomLevel - z)));
+      return static_cast<std::uint32_t>(
+          std::clamp(c / extent, ::tiles::fixed_coord_t{0},
+                     static_cast<::tiles::fixed_coord_t>((1U << z) - 1U)));
+    };
+    auto const x_min = tile_coord(std::min(a.x(), b.x()));
+    auto const x_max = tile_coord(std::max(a.x(), b.x()));
+    auto const y_min = tile_coord(std::min(a.y(), b.y()));
+    auto const y_max = tile_coord(std::max(a.y(), b.y()));
+    for (auto y = y_min; y <= y_max; ++y) {
+      boost::asio::post(ioc, [this, x_min, x_max, y, z]() {
+        for (auto x = x_min; x <= x_max; ++x) {
+          if (low_zoom_cache_.full()) {
+            return;
+          }
+          auto const key = tile_key{x, y, z};
+          if (low_zoom_cache_.contains(key)) {
+            continue;
+          }
+          auto tile = render_tile(*this, geo::tile{x, y, z});
+          if (!tile.body_.empty()) {
+            low_zoom_cache_.try_add_or_update(key, [&]() {
+              return std::make_shared<rendered_tile>(std::move(tile));
+            });
+          }
+        }
+      });
+    }
+  }
+}
+
+}  // namespace motis
@@ -1,9 +1,18 @@
 #include "motis/update_rtt_td_footpaths.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <map>
+#include <numeric>
+#include <optional>
+#include <type_traits>
 
 #include "utl/equal_ranges_linear.h"
+#include "utl/helpers/algorithm.h"
 #include "utl/parallel_for.h"
+#include "utl/to_vec.h"
+#include "utl/zip.h"
 
 #include "osr/routing/parameters.h"
 #include "osr/routing/route.h"
@@ -21,6 +30,16 @@ namespace motis {
 using node_states_t =
     std::pair<nodes_t, std::vector<std::pair<n::unixtime_t, states_t>>>;
 
+std::vector<state_change<n::unixtime_t>> get_node_state_changes(
+    osr::ways const& w, elevators const& e, osr::node_idx_t const node) {
+  auto const ne = match_elevator(e.elevators_rtree_, e.elevators_, w, node);
+  if (ne == elevator_idx_t::invalid()) {
+    return {{.valid_from_ = n::unixtime_t{n::unixtime_t::duration{0}},
+             .state_ = true}};
+  }
+  return e.elevators_[ne].get_state_changes();
+}
+
 node_states_t get_node_states(osr::ways const& w,
                               osr::lookup const& l,
                               elevators const& e,
@@ -28,21 +47,9 @@ node_states_t get_node_states(osr::ways const& w,
   auto e_nodes =
       utl::to_vec(l.find_elevators(geo::box{pos, kElevatorUpdateRadius}));
   auto e_state_changes =
-      get_state_changes(
-          utl::to_vec(
-              e_nodes,
-              [&](osr::node_idx_t const n)
-                  -> std::vector<state_change<n::unixtime_t>> {
-                auto const ne =
-                    match_elevator(e.elevators_rtree_, e.elevators_, w, n);
-                if (ne == elevator_idx_t::invalid()) {
-                  return {
-                      {.valid_from_ = n::unixtime_t{n::unixtime_t::duration{0}},
-                       .state_ = true}};
-                }
-                return e.elevators_[ne].get_state_changes();
-              }))
-          .to_vec();
+      get_state_changes(utl::to_vec(e_nodes, [&](osr::node_idx_t const n) {
+        return get_node_state_changes(w, e, n);
+      })).to_vec();
   return {std::move(e_nodes), std::move(e_state_changes)};
 }
 
@@ -76,13 +83,40 @@ std::optional<std::pair<nodes_t, states_t>> get_states_at(
   return std::pair{e_nodes, std::prev(it)->second};
 }
 
+namespace {
+
+// Result of one street search for a set of elevator states.
+struct td_search {
+  states_t const* states_{};
+  std::vector<std::optional<osr::cost_t>> costs_;
+
+  // Nearby elevator nodes the path to each neighbor passes through.
+  std::vector<nodes_t> elevators_on_path_;
+};
+
+std::size_t n_blocked(states_t const& states) {
+  return static_cast<std::size_t>(std::ranges::count(states, false));
+}
+
+// Every elevator blocked in `a` is also blocked in `b`.
+bool blocks_subset(states_t const& a, states_t const& b) {
+  for (auto const [x, y] : utl::zip(a, b)) {
+    if (!x && y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
 std::vector<n::td_footpath> get_td_footpaths(
     osr::ways const& w,
     osr::lookup const& l,
     osr::platforms const& pl,
     nigiri::timetable const& tt,
     nigiri::rt_timetable const* rtt,
-    point_rtree<n::location_idx_t> const& loc_rtree,
+    static_point_rtree<n::location_idx_t> const& loc_rtree,
     elevators const& e,
     platform_matches_t const& matches,
     n::location_idx_t const start_l,
@@ -96,25 +130,111 @@ std::vector<n::td_footpath> get_td_footpaths(
   blocked_mem.resize(w.n_nodes());
 
   auto const [e_nodes, e_state_changes] = get_node_states(w, l, e, start.pos_);
+  if (e_state_changes.empty()) {
+    return {};
+  }
 
-  auto fps = std::vector<n::td_footpath>{};
+  auto const neighbors = get_stops_with_traffic(
+      tt, rtt, loc_rtree, start, get_max_distance(profile, osr_params, max),
+      start_l);
+  auto const neighbor_locs = utl::to_vec(
+      neighbors, [&](auto&& x) { return get_loc(tt, w, pl, matches, x); });
+  auto const params = to_profile_parameters(profile, osr_params);
+
+  // One search per distinct state vector. Searches with fewer blocked
+  // elevators run first: a path that avoids all additionally blocked
+  // elevators stays optimal when more elevators are blocked, so only
+  // neighbors whose paths are affected need to be routed again.
+  auto search_idx = std::map<states_t, std::size_t>{};
   for (auto const& [t, states] : e_state_changes) {
-    set_blocked(e_nodes, states, blocked_mem);
+    search_idx.emplace(states, 0U);
+  }
+  auto searches = utl::to_vec(search_idx, [](auto const& x) {
+    return td_search{.states_ = &x.first};
+  });
+  std::ranges::stable_sort(searches, std::less<>{}, [](td_search const& x) {
+    return n_blocked(*x.states_);
+  });
 
-    auto const neighbors = get_stops_with_traffic(
-        tt, rtt, loc_rtree, start, get_max_distance(profile, osr_params, max),
-        start_l);
+  auto newly_blocked = nodes_t{};
+  auto reroute = std::vector<std::size_t>{};
+  for (auto i = 0U; i != searches.size(); ++i) {
+    auto& s = searches[i];
+    auto const& states = *s.states_;
+    search_idx[states] = i;
+
+    auto const base =
+        std::find_if(std::make_reverse_iterator(begin(searches) + i),
+                     std::make_reverse_iterator(begin(searches)),
+                     [&](td_search const& x) {
+                       return blocks_subset(*x.states_, states);
+                     });
+
+    s.costs_.resize(neighbors.size());
+    s.elevators_on_path_.resize(neighbors.size());
+    reroute.clear();
+    if (base == std::make_reverse_iterator(begin(searches))) {
+      reroute.resize(neighbors.size());
+      std::iota(begin(reroute), end(reroute), std::size_t{0U});
+    } else {
+      newly_blocked.clear();
+      for (auto k = 0U; k != e_nodes.size(); ++k) {
+        if ((*base->states_)[k] && !states[k]) {
+          newly_blocked.push_back(e_nodes[k]);
+        }
+      }
+      for (auto j = 0U; j != neighbors.size(); ++j) {
+        auto const& on_path = base->elevators_on_path_[j];
+        if (std::ranges::any_of(on_path, [&](osr::node_idx_t const x) {
+              return utl::find(newly_blocked, x) != end(newly_blocked);
+            })) {
+          reroute.push_back(j);
+        } else {
+          s.costs_[j] = base->costs_[j];
+          s.elevators_on_path_[j] = on_path;
+        }
+      }
+    }
+
+    if (reroute.empty()) {
+      continue;
+    }
+
+    set_blocked(e_nodes, states, blocked_mem);
     auto const results = osr::route(
-        to_profile_parameters(profile, osr_params), w, l, profile, start,
-        utl::to_vec(neighbors,
-                    [&](auto&& x) { return get_loc(tt, w, pl, matches, x); }),
+        params, w, l, profile, start,
+        utl::to_vec(reroute, [&](std::size_t const j) {
+          return neighbor_locs[j];
+        }),
         static_cast<osr::cost_t>(max.count()), dir, max_matching_distance,
-        &blocked_mem);
+        &blocked_mem, nullptr, nullptr,
+        [](osr::path const& p) { return p.uses_elevator_; });
+
+    for (auto const [j, p] : utl::zip(reroute, results)) {
+      if (!p.has_value()) {
+        continue;
+      }
+      s.costs_[j] = p->cost_;
+      for (auto const& seg : p->segments_) {
+        for (auto const x : {seg.from_, seg.to_}) {
+          if (utl::find(e_nodes, x) != end(e_nodes) &&
+              utl::find(s.elevators_on_path_[j], x) ==
+                  end(s.elevators_on_path_[j])) {
+            s.elevators_on_path_[j].push_back(x);
+          }
+        }
+      }
+    }
+  }
 
-    for (auto const [to, p] : utl::zip(neighbors, results)) {
-      auto const duration = p.has_value() && (n::duration_t{p->cost_ / 60U} <
-                                              n::footpath::kMaxDuration)
-                                ? n::duration_t{p->cost_ / 60U}
+  auto fps = std::vector<n::td_footpath>{};
+  fps.reserve(e_state_changes.size() * neighbors.size());
+  for (auto const& [t, states] : e_state_changes) {
+    auto const& s = searches[search_idx.at(states)];
+    for (auto const [to, cost] : utl::zip(neighbors, s.costs_)) {
+      auto const duration = cost.has_value() && (n::duration_t{*cost / 60U} <
+                                                 n::footpath::kMaxDuration)
+                                ? n::duration_t{*cost / 60U}
                                 : n::footpath::kMaxDuration;
       fps.push_back(n::td_footpath{
           to, t,
@@ -140,16 +260,116 @@ std::vector<n::td_footpath> get_td_footpaths(
   return fps;
 }
 
+namespace {
+
+// Replaces the buckets of `updated` locations. Unchanged ranges between them
+// are copied as a whole and the following bucket starts are shifted, instead
+// of rebuilding the table bucket by bucket.
+template <typename TdFootpaths>
+void replace_buckets(
+    std::map<n::location_idx_t, std::vector<n::td_footpath>> const& updated,
+    TdFootpaths& out) {
+  if (utl::all_of(updated, [&](auto const& x) {
+        return out[x.first].size() == x.second.size();
+      })) {
+    for (auto const& [l, fps] : updated) {
+      std::ranges::copy(fps, out[l].begin());
+    }
+    return;
+  }
+
+  auto deltas = std::vector<std::pair<std::size_t, std::int64_t>>{};
+  auto size = static_cast<std::int64_t>(out.data_.size());
+  for (auto const& [l, fps] : updated) {
+    auto const delta = static_cast<std::int64_t>(fps.size()) -
+                       static_cast<std::int64_t>(out[l].size());
+    deltas.emplace_back(to_idx(l), delta);
+    size += delta;
+  }
+
+  auto data = decltype(out.data_){};
+  data.resize(static_cast<std::size_t>(size));
+  auto to = begin(data);
+  auto from = std::size_t{0U};
+  for (auto const& [l, fps] : updated) {
+    auto const i = to_idx(l);
+    to = std::copy(begin(out.data_) + from,
+                   begin(out.data_) + out.bucket_starts_[i], to);
+    to = std::copy(begin(fps), end(fps), to);
+    from = out.bucket_starts_[i + 1U];
+  }
+  std::copy(begin(out.data_) + from, end(out.data_), to);
+  out.data_ = std::move(data);
+
+  using index_t = std::decay_t<decltype(out.bucket_starts_[0])>;
+  auto shift = std::int64_t{0};
+  auto next = begin(deltas);
+  for (auto i = std::size_t{0U}; i != out.bucket_starts_.size(); ++i) {
+    for (; next != end(deltas) && next->first < i; ++next) {
+      shift += next->second;
+    }
+    out.bucket_starts_[i] = static_cast<index_t>(
+        static_cast<std::int64_t>(out.bucket_starts_[i]) + shift);
+  }
+}
+
+// Writes the footpaths of `updated` locations to `out`. All other locations
+// keep their footpaths from `prev` (none if `prev` is nullptr). If `out`
+// already holds the footpaths of `prev` (`out_is_copy`: RT timetable copied
+// from the previous snapshot, or `prev == &out`), only the updated buckets
+// are replaced.
+template <typename TdFootpaths, typename Bitvec>
+void patch_td_footpaths(
+    n::timetable const& tt,
+    std::map<n::location_idx_t, std::vector<n::td_footpath>> const& updated,
+    TdFootpaths const* prev,
+    Bitvec const* prev_has,
+    bool const out_is_copy,
+    TdFootpaths& out,
+    Bitvec& has) {
+  if (prev != nullptr && (out_is_copy || prev == &out) &&
+      out.size() == tt.n_locations()) {
+    replace_buckets(updated, out);
+    for (auto const& [l, fps] : updated) {
+      has.set(l, true);
+    }
+    return;
+  }
+
+  auto prev_copy = std::optional<TdFootpaths>{};
+  if (prev == &out) {
+    prev = &prev_copy.emplace(out);
+  }
+
+  out.clear();
+  for (auto i = n::location_idx_t{0U}; i != tt.n_locations(); ++i) {
+    auto const it = updated.find(i);
+    if (it != end(updated)) {
+      has.set(i, true);
+      out.emplace_back(it->second);
+    } else if (prev != nullptr) {
+      has.set(i, prev_has->test(i));
+      out.emplace_back((*prev)[i]);
+    } else {
+      has.set(i, false);
+      out.emplace_back(std::initializer_list<n::td_footpath>{});
+    }
+  }
+}
+
+}  // namespace
+
 void update_rtt_td_footpaths(
     osr::ways const& w,
     osr::lookup const& l,
     osr::platforms const& pl,
     nigiri::timetable const& tt,
-    point_rtree<n::location_idx_t> const& loc_rtree,
+    static_point_rtree<n::location_idx_t> const& loc_rtree,
     elevators const& e,
     platform_matches_t const& matches,
     hash_set<std::pair<n::location_idx_t, osr::direction>> const& tasks,
     nigiri::rt_timetable const* old_rtt,
+    bool const rtt_is_copy,
     nigiri::rt_timetable& rtt,
     std::chrono::seconds const max) {
   auto in_mutex = std::mutex{}, out_mutex = std::mutex{};
@@ -171,69 +391,51 @@ void update_rtt_td_footpaths(
         }
       });
 
-  rtt.td_footpaths_out_[2].clear();
-  for (auto i = n::location_idx_t{0U}; i != tt.n_locations(); ++i) {
-    auto const it = out.find(i);
-    if (it != end(out)) {
-      rtt.has_td_footpaths_out_[2].set(i, true);
-      rtt.td_footpaths_out_[2].emplace_back(it->second);
-    } else if (old_rtt != nullptr) {
-      rtt.has_td_footpaths_out_[2].set(
-          i, old_rtt->has_td_footpaths_out_[2].test(i));
-      rtt.td_footpaths_out_[2].emplace_back(old_rtt->td_footpaths_out_[2][i]);
-    } else {
-      rtt.has_td_footpaths_out_[2].set(i, false);
-      rtt.td_footpaths_out_[2].emplace_back(
-          std::initializer_list<n::td_footpath>{});
-    }
-  }
-
-  rtt.td_footpaths_in_[2].clear();
-  for (auto i = n::location_idx_t{0U}; i != tt.n_locations(); ++i) {
-    auto const it = in.find(i);
-    if (it != end(in)) {
-      rtt.has_td_footpaths_in_[2].set(i, true);
-      rtt.td_footpaths_in_[2].emplace_back(it->second);
-    } else if (old_rtt != nullptr) {
-      rtt.has_td_footpaths_in_[2].set(i,
-                                      old_rtt->has_td_footpaths_in_[2].test(i));
-      rtt.td_footpaths_in_[2].emplace_back(old_rtt->td_footpaths_in_[2][i]);
-    } else {
-      rtt.has_td_footpaths_in_[2].set(i, false);
-      rtt.td_footpaths_in_[2].emplace_back(
-          std::initializer_list<n::td_footpath>{});
-    }
-  }
+  patch_td_footpaths(
+      tt, out,
+      old_rtt == nullptr ? nullptr : &old_rtt->td_footpaths_out_[2],
+      old_rtt == nullptr ? nullptr : &old_rtt->has_td_footpaths_out_[2],
+      rtt_is_copy, rtt.td_footpaths_out_[2], rtt.has_td_footpaths_out_[2]);
+  patch_td_footpaths(
+      tt, in, old_rtt == nullptr ? nullptr : &old_rtt->td_footpaths_in_[2],
+      old_rtt == nullptr ? nullptr : &old_rtt->has_td_footpaths_in_[2],
+      rtt_is_copy, rtt.td_footpaths_in_[2], rtt.has_td_footpaths_in_[2]);
 }
 
-void update_rtt_td_footpaths(osr::ways const& w,
-                             osr::lookup const& l,
-                             osr::platforms const& pl,
-                             nigiri::timetable const& tt,
-                             point_rtree<n::location_idx_t> const& loc_rtree,
-                             elevators const& e,
-                             elevator_footpath_map_t const& elevators_in_paths,
-                             platform_matches_t const& matches,
-                             nigiri::rt_timetable& rtt,
-                             std::chrono::seconds const max) {
+void update_rtt_td_footpaths(
+    osr::ways const& w,
+    osr::lookup const& l,
+    osr::platforms const& pl,
+    nigiri::timetable const& tt,
+    static_point_rtree<n::location_idx_t> const& loc_rtree,
+    elevators const& e,
+    elevator_footpath_map_t const& elevators_in_paths,
+    platform_matches_t const& matches,
+    nigiri::rt_timetable& rtt,
+    std::chrono::seconds const max) {
   auto tasks = hash_set<std::pair<n::location_idx_t, osr::direction>>{};
-  for (auto const& [e_in_path, from_to] : elevators_in_paths) {
-    auto const e_idx =
-        match_elevator(e.elevators_rtree_, e.elevators_, w, e_in_path);
-    if (e_idx == elevator_idx_t::invalid()) {
-      continue;
-    }
-    auto const& el = e.elevators_[e_idx];
-    if (el.out_of_service_.empty() && el.status_) {
-      continue;
-    }
-    for (auto const& [from, to] : from_to) {
-      tasks.emplace(from, osr::direction::kForward);
-      tasks.emplace(to, osr::direction::kBackward);
-    }
-  }
+  utl::equal_ranges_linear(
+      elevators_in_paths,
+      [](elevator_footpath const& a, elevator_footpath const& b) {
+        return a.elevator_ == b.elevator_;
+      },
+      [&](auto&& lb, auto&& ub) {
+        auto const e_idx =
+            match_elevator(e.elevators_rtree_, e.elevators_, w, lb->elevator_);
+        if (e_idx == elevator_idx_t::invalid()) {
+          return;
+        }
+        auto const& el = e.elevators_[e_idx];
+        if (el.out_of_service_.empty() && el.status_) {
+          return;
+        }
+        for (auto it = lb; it != ub; ++it) {
+          tasks.emplace(it->from_, osr::direction::kForward);
+          tasks.emplace(it->to_, osr::direction::kBackward);
+        }
+      });
   update_rtt_td_footpaths(w, l, pl, tt, loc_rtree, e, matches, tasks, nullptr,
-                          rtt, max);
+                          false, rtt, max);
 }
 
 }  // namespace motis
@@ -0,0 +1,161 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "fmt/format.h"
+
+#include "cista/free_self_allocated.h"
+
+#include "utl/to_vec.h"
+
+#include "osr/routing/profile.h"
+
+#include "nigiri/timetable.h"
+
+#include "motis/compute_footpaths.h"
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/import.h"
+
+using namespace std::string_view_literals;
+using namespace std::chrono_literals;
+using namespace motis;
+namespace n = nigiri;
+
+namespace {
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon,location_type,parent_station,platform_code,wheelchair_boarding
+DA,DA Hbf,49.87260,8.63085,1,,,1
+DA_3,DA Hbf,49.87355,8.63003,0,DA,3,1
+DA_10,DA Hbf,49.87336,8.62926,0,DA,10,1
+DA_12,DA Hbf,49.87330,8.62880,0,DA,12,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+RE,DB,RE,,,106
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id,wheelchair_accessible
+RE,S1,RE_1,,,1
+RE,S1,RE_2,,,1
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+RE_1,01:00:00,01:00:00,DA_3,0,0,0
+RE_1,01:10:00,01:10:00,DA_10,1,0,0
+RE_2,02:00:00,02:00:00,DA_12,0,0,0
+RE_2,02:10:00,02:10:00,DA,1,0,0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+constexpr auto const kDataPath = "test/data_compute_footpaths";
+
+using footpaths_t =
+    std::vector<std::vector<std::pair<n::location_idx_t, n::duration_t>>>;
+
+struct result {
+  elevator_footpath_map_t elevators_;
+  footpaths_t foot_, wheelchair_;
+};
+
+result run(std::optional<footpath_checkpoints> const& checkpoints) {
+  auto d = data{kDataPath};
+  d.load_tt("tt.bin");
+  d.load_osr();
+
+  auto const profiles = std::vector<routed_transfers_settings>{
+      {.profile_ = osr::search_profile::kFoot,
+       .profile_idx_ = n::kFootProfile,
+       .max_matching_distance_ = 25.0,
+       .max_duration_ = 15min},
+      {.profile_ = osr::search_profile::kWheelchair,
+       .profile_idx_ = n::kWheelchairProfile,
+       .max_matching_distance_ = 8.0,
+       .max_duration_ = 15min}};
+  auto r = result{};
+  r.elevators_ =
+      compute_footpaths(*d.w_, *d.l_, *d.pl_, *d.tt_, d.elevations_.get(),
+                        true, profiles, checkpoints);
+
+  auto const get = [&](n::profile_idx_t const p) {
+    return utl::to_vec(d.tt_->locations_.footpaths_out_[p], [](auto&& fps) {
+      return utl::to_vec(fps, [](n::footpath const fp) {
+        return std::pair{fp.target(), fp.duration()};
+      });
+    });
+  };
+  r.foot_ = get(n::kFootProfile);
+  r.wheelchair_ = get(n::kWheelchairProfile);
+
+  cista::free_self_allocated(d.tt_.get());
+  return r;
+}
+
+void expect_equal(result const& expected, result const& actual) {
+  EXPECT_EQ(expected.elevators_, actual.elevators_);
+  EXPECT_EQ(expected.foot_, actual.foot_);
+  EXPECT_EQ(expected.wheelchair_, actual.wheelchair_);
+}
+
+}  // namespace
+
+TEST(motis, compute_footpaths_checkpoints) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all(kDataPath, ec);
+
+  auto const c = config{
+      .osm_ = {"test/resources/test_case.osm.pbf"},
+      .timetable_ =
+          config::timetable{
+              .first_day_ = "2019-05-01",
+              .num_days_ = 2,
+              .use_osm_stop_coordinates_ = true,
+              .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}},
+      .street_routing_ = true,
+      .osr_footpath_ = true};
+  import(c, kDataPath);
+
+  auto const dir = std::filesystem::path{kDataPath} / "checkpoints";
+  auto const checkpoints = footpath_checkpoints{.dir_ = dir, .key_ = 42U};
+  auto const file = [&](n::profile_idx_t const p) {
+    return dir / fmt::format("{}_0.bin", static_cast<unsigned>(p));
+  };
+
+  auto const expected = run(std::nullopt);
+  ASSERT_FALSE(expected.elevators_.empty());
+  EXPECT_FALSE(std::filesystem::exists(dir));
+
+  // First run writes all (profile, partition) results.
+  expect_equal(expected, run(checkpoints));
+  ASSERT_TRUE(std::filesystem::exists(file(n::kFootProfile)));
+  ASSERT_TRUE(std::filesystem::exists(file(n::kWheelchairProfile)));
+
+  // Everything restored from checkpoints, including elevator footpaths.
+  expect_equal(expected, run(checkpoints));
+
+  // Partially checkpointed: only the foot profile is restored.
+  std::filesystem::remove(file(n::kWheelchairProfile));
+  expect_equal(expected, run(checkpoints));
+  EXPECT_TRUE(std::filesystem::exists(file(n::kWheelchairProfile)));
+
+  // Checkpoints of another input are discarded and recomputed.
+  std::ofstream{file(n::kFootProfile), std::ios::trunc} << "garbage";
+  expect_equal(expected, run(footpath_checkpoints{.dir_ = dir, .key_ = 7U}));
+  EXPECT_TRUE(std::filesystem::exists(file(n::kFootProfile)));
+  expect_equal(expected, run(footpath_checkpoints{.dir_ = dir, .key_ = 7U}));
+}
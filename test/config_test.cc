@@ -39,11 +39,14 @@ tiles:
   profile: deps/tiles/profile/profile.lua
   db_size: 274877906944
   flush_threshold: 100000
+  cache_mb: 256
+  low_zoom_cache_mb: 64
 timetable:
   first_day: 2024-10-02
   num_days: 2
   tb: false
   railviz: true
+  railviz_cache_mb: 64
   with_shapes: true
   adjust_footpaths: true
   merge_dupes_intra_src: false
@@ -53,6 +56,7 @@ timetable:
   http_timeout: 30
   canned_rt: false
   incremental_rt_update: false
+  reuse_rt_snapshot_memory: false
   use_osm_stop_coordinates: false
   extend_missing_footpaths: false
   max_footpath_length: 15
@@ -0,0 +1,172 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "boost/beast/http.hpp"
+
+#include "fmt/format.h"
+
+#include "gtfsrt/gtfs-realtime.pb.h"
+
+#include "net/web_server/query_router.h"
+
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/rt/rt_timetable.h"
+
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/endpoints/gtfsrt.h"
+#include "motis/import.h"
+#include "motis/tag_lookup.h"
+
+#include "../util.h"
+
+namespace http = boost::beast::http;
+namespace n = nigiri;
+using namespace std::string_view_literals;
+using namespace motis;
+using namespace date;
+using namespace test;
+
+namespace {
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+DA,DA Hbf,49.87260,8.63085
+FFM,FFM Hbf,50.10701,8.66341
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+RE,DB,RE,,2
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+RE,S1,A,FFM,
+RE,S1,B,FFM,
+RE,S1,C,FFM,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+A,10:00:00,10:00:00,DA,1
+A,10:20:00,10:20:00,FFM,2
+B,11:00:00,11:00:00,DA,1
+B,11:20:00,11:20:00,FFM,2
+C,12:00:00,12:00:00,DA,1
+C,12:20:00,12:20:00,FFM,2
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+trip_update delayed(std::string const& trip_id, std::int32_t const delay) {
+  return trip_update{.trip_ = {.trip_id_ = trip_id, .date_ = {"20190501"}},
+                     .stop_updates_ = {{.stop_id_ = "DA",
+                                        .seq_ = std::optional{1U},
+                                        .ev_type_ = n::event_type::kDep,
+                                        .delay_minutes_ = delay}}};
+}
+
+void publish(data& d, std::vector<feed_entity> const& updates) {
+  auto rtt = std::make_unique<n::rt_timetable>(
+      n::rt::create_rt_timetable(*d.tt_, sys_days{2019_y / May / 1}));
+  n::rt::gtfsrt_update_msg(*d.tt_, *rtt, n::source_idx_t{0}, "test",
+                           to_feed_msg(updates, sys_days{2019_y / May / 1}));
+  std::atomic_store(&d.rt_, std::make_shared<rt>(std::move(rtt), nullptr,
+                                                 nullptr, nullptr));
+}
+
+std::string entity_id(transit_realtime::TripDescriptor const& td) {
+  return fmt::format("{}/{}/{}", td.trip_id(), td.start_date(),
+                     td.start_time());
+}
+
+}  // namespace
+
+TEST(motis, gtfsrt_etag_since) {
+  auto const c = config{
+      .timetable_ =
+          config::timetable{
+              .first_day_ = "2019-05-01",
+              .num_days_ = 2,
+              .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}},
+      .street_routing_ = false};
+  import(c, "test/data_gtfsrt");
+  auto d = data{"test/data_gtfsrt", c};
+
+  auto const gtfsrt_ep = ep::gtfsrt{c, d.tt_.get(), d.tags_.get(), d.rt_,
+                                    ep::gtfsrt::make_cache()};
+  auto const get = [&](std::string target, std::string_view if_none_match) {
+    auto req = net::web_server::http_req_t{http::verb::get, target, 11};
+    if (!if_none_match.empty()) {
+      req.set(http::field::if_none_match, if_none_match);
+    }
+    auto const reply = gtfsrt_ep(net::route_request{std::move(req)}, false);
+    auto const* res = std::get_if<net::web_server::string_res_t>(&reply);
+    EXPECT_NE(nullptr, res);
+    return *res;
+  };
+  auto const parse = [](net::web_server::string_res_t const& res) {
+    auto msg = transit_realtime::FeedMessage{};
+    EXPECT_TRUE(msg.ParseFromString(res.body()));
+    return msg;
+  };
+
+  publish(d, {delayed("A", 5), delayed("B", 5), delayed("C", 5)});
+
+  auto const full = get("/gtfsrt", "");
+  ASSERT_EQ(http::status::ok, full.result());
+  auto const etag = std::string{full.base()[http::field::etag]};
+  ASSERT_FALSE(etag.empty());
+  auto const full_msg = parse(full);
+  ASSERT_EQ(3, full_msg.entity_size());
+
+  // Same snapshot: same version, not modified for the client.
+  EXPECT_EQ(etag, std::string{get("/gtfsrt", "").base()[http::field::etag]});
+  EXPECT_EQ(http::status::not_modified, get("/gtfsrt", etag).result());
+
+  // A changed, B unchanged, C removed.
+  publish(d, {delayed("A", 10), delayed("B", 5)});
+  auto const update = get("/gtfsrt", etag);
+  EXPECT_EQ(http::status::ok, update.result());
+  auto const update_etag = std::string{update.base()[http::field::etag]};
+  EXPECT_NE(etag, update_etag);
+
+  auto const version = etag.substr(1U, etag.size() - 2U);
+  auto const diff = get(fmt::format("/gtfsrt?since={}", version), "");
+  ASSERT_EQ(http::status::ok, diff.result());
+  auto const diff_msg = parse(diff);
+  EXPECT_EQ(transit_realtime::FeedHeader_Incrementality_DIFFERENTIAL,
+            diff_msg.header().incrementality());
+  ASSERT_EQ(2, diff_msg.entity_size());
+
+  auto const& changed = diff_msg.entity(0);
+  EXPECT_FALSE(changed.is_deleted());
+  EXPECT_EQ("A", changed.trip_update().trip().trip_id());
+
+  auto const& deleted = diff_msg.entity(1);
+  auto const c_trip = std::ranges::find_if(full_msg.entity(), [](auto&& e) {
+    return e.trip_update().trip().trip_id() == "C";
+  });
+  ASSERT_NE(full_msg.entity().end(), c_trip);
+  EXPECT_TRUE(deleted.is_deleted());
+  EXPECT_EQ(entity_id(c_trip->trip_update().trip()), deleted.id());
+  EXPECT_EQ("C", deleted.trip_update().trip().trip_id());
+  EXPECT_EQ(c_trip->trip_update().trip().start_date(),
+            deleted.trip_update().trip().start_date());
+
+  // Nothing changed since the current version.
+  auto const current = update_etag.substr(1U, update_etag.size() - 2U);
+  auto const none = get(fmt::format("/gtfsrt?since={}", current), "");
+  EXPECT_EQ(0, parse(none).entity_size());
+}
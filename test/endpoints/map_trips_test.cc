@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+
+#include "fmt/format.h"
+
+#include "prometheus/counter.h"
+
+#include "utl/init_from.h"
+
+#include "motis-api/motis-api.h"
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/endpoints/map/trips.h"
+#include "motis/import.h"
+#include "motis/metrics_registry.h"
+
+using namespace std::string_view_literals;
+using namespace motis;
+
+namespace {
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+Test,Test,https://example.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+DA_Bus_1,DA Hbf,49.8724891,8.6281994
+DA_Bus_2,DA Hbf,49.8750407,8.6312172
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+B1,Test,B1,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+B1,S1,B1,Bus 1,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+B1,01:00:00,01:00:00,DA_Bus_1,1
+B1,01:10:00,01:10:00,DA_Bus_2,2
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+}  // namespace
+
+TEST(motis, map_trips_cache) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_map_trips", ec);
+
+  auto const c = config{
+      .osm_ = {"test/resources/test_case.osm.pbf"},
+      .timetable_ =
+          config::timetable{
+              .first_day_ = "2019-05-01",
+              .num_days_ = 2,
+              .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}},
+      .street_routing_ = true};
+  import(c, "test/data_map_trips");
+  auto d = data{"test/data_map_trips", c};
+
+  auto const map_trips = utl::init_from<ep::trips>(d).value();
+  auto const& hits = d.metrics_->cache_requests_.Add(
+      {{"cache", "railviz_trips"}, {"result", "hit"}});
+
+  // Full HD viewport at zoom level 14, panned a bit between requests.
+  for (auto const& [min, max] :
+       {std::pair{"49.845%2C8.55", "49.905%2C8.715"},
+        std::pair{"49.85%2C8.56", "49.91%2C8.725"}}) {
+    auto const res = map_trips(
+        fmt::format("/api/v6/map/trips"
+                    "?min={}&max={}&zoom=14"
+                    "&startTime=2019-04-30T23:02:00Z"
+                    "&endTime=2019-04-30T23:03:00Z",
+                    min, max));
+    ASSERT_EQ(1U, res.size());
+    EXPECT_EQ(api::ModeEnum::BUS, res.front().mode_);
+  }
+  EXPECT_GT(hits.Value(), 0.0);
+}
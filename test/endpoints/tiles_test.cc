@@ -0,0 +1,149 @@
+#include "gtest/gtest.h"
+
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "boost/asio/io_context.hpp"
+#include "boost/beast/http.hpp"
+
+#include "prometheus/counter.h"
+
+#include "net/web_server/query_router.h"
+
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/endpoints/tiles.h"
+#include "motis/import.h"
+#include "motis/metrics_registry.h"
+#include "motis/tiles_data.h"
+
+namespace http = boost::beast::http;
+using namespace std::string_view_literals;
+using namespace motis;
+
+namespace {
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+DA,DA Hbf,49.87260,8.63085
+DA_10,DA Hbf,49.87336,8.62926
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+RE,DB,RE,,2
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+RE,S1,A,DA,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+A,10:00:00,10:00:00,DA,1
+A,10:05:00,10:05:00,DA_10,2
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+}  // namespace
+
+TEST(motis, tiles_cache_etag) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_tiles", ec);
+
+  auto const c = config{
+      .osm_ = {"test/resources/test_case.osm.pbf"},
+      .tiles_ = {{.profile_ = "deps/tiles/profile/full.lua",
+                  .db_size_ = 1024U * 1024U * 25U}},
+      .timetable_ =
+          config::timetable{
+              .first_day_ = "2019-05-01",
+              .num_days_ = 2,
+              .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}},
+      .street_routing_ = true};
+  import(c, "test/data_tiles");
+  auto d = data{"test/data_tiles", c};
+  ASSERT_NE(nullptr, d.tiles_);
+
+  auto const tiles_ep = ep::tiles{*d.tiles_};
+  auto const get = [&](std::string target, std::string_view if_none_match) {
+    auto req = net::web_server::http_req_t{http::verb::get, target, 11};
+    if (!if_none_match.empty()) {
+      req.set(http::field::if_none_match, if_none_match);
+    }
+    return tiles_ep(net::route_request{std::move(req)}, false);
+  };
+  auto const hits = [&](std::string const& cache) {
+    return d.metrics_->cache_requests_
+        .Add({{"cache", cache}, {"result", "hit"}})
+        .Value();
+  };
+
+  // Darmstadt Hbf.
+  auto const area = tiles_prewarm_area(d);
+  EXPECT_TRUE(area.contains(geo::latlng{49.87260, 8.63085}));
+  EXPECT_LT(area.max_.lat_ - area.min_.lat_, 10.0);
+
+  // Prewarming fills the low zoom cache with the non-empty tiles: the first
+  // request is a hit.
+  auto ioc = boost::asio::io_context{};
+  d.tiles_->prewarm(ioc, area, 10U);
+  ioc.run();
+  auto const low = get("/tiles/10/536/347.mvt", "");
+  EXPECT_EQ(
+      std::get<net::web_server::string_res_t>(low).body().empty() ? 0.0 : 1.0,
+      hits("tiles_low_zoom"));
+
+  // High zoom tiles are rendered once, then served from the cache.
+  auto const first = get("/tiles/14/8584/5565.mvt", "");
+  auto const* tile = std::get_if<net::web_server::string_res_t>(&first);
+  ASSERT_NE(nullptr, tile);
+  ASSERT_EQ(http::status::ok, tile->result());
+  EXPECT_FALSE(tile->body().empty());
+  EXPECT_EQ(0.0, hits("tiles"));
+
+  auto const etag = std::string{tile->base()[http::field::etag]};
+  ASSERT_FALSE(etag.empty());
+  auto const second = get("/tiles/14/8584/5565.mvt", "");
+  auto const* cached = std::get_if<net::web_server::string_res_t>(&second);
+  ASSERT_NE(nullptr, cached);
+  EXPECT_EQ(tile->body(), cached->body());
+  EXPECT_EQ(etag, std::string{cached->base()[http::field::etag]});
+  EXPECT_EQ(1.0, hits("tiles"));
+
+  auto const not_modified = get("/tiles/14/8584/5565.mvt", etag);
+  auto const* empty = std::get_if<net::web_server::empty_res_t>(&not_modified);
+  ASSERT_NE(nullptr, empty);
+  EXPECT_EQ(http::status::not_modified, empty->result());
+  EXPECT_EQ(etag, std::string{empty->base()[http::field::etag]});
+  EXPECT_EQ(2.0, hits("tiles"));
+
+  // Glyphs: stable ETag per resource, 304 on revalidation.
+  constexpr auto const kGlyphs =
+      "/tiles/glyphs/Noto%20Sans%20Regular/0-255.pbf";
+  auto const glyphs = get(kGlyphs, "");
+  auto const* glyphs_res = std::get_if<net::web_server::string_res_t>(&glyphs);
+  ASSERT_NE(nullptr, glyphs_res);
+  ASSERT_EQ(http::status::ok, glyphs_res->result());
+  EXPECT_FALSE(glyphs_res->body().empty());
+  auto const glyphs_etag = std::string{glyphs_res->base()[http::field::etag]};
+  ASSERT_FALSE(glyphs_etag.empty());
+  EXPECT_NE(etag, glyphs_etag);
+
+  auto const glyphs_again = get(kGlyphs, "");
+  EXPECT_EQ(glyphs_etag,
+            std::string{std::get<net::web_server::string_res_t>(glyphs_again)
+                            .base()[http::field::etag]});
+  auto const glyphs_304 = get(kGlyphs, glyphs_etag);
+  auto const* glyphs_empty =
+      std::get_if<net::web_server::empty_res_t>(&glyphs_304);
+  ASSERT_NE(nullptr, glyphs_empty);
+  EXPECT_EQ(http::status::not_modified, glyphs_empty->result());
+}
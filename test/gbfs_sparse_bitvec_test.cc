@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "osr/types.h"
+
+#include "motis/gbfs/sparse_bitvec.h"
+
+using namespace motis::gbfs;
+
+namespace {
+
+using run_t = sparse_bitvec::run_t;
+
+void expect_equal(osr::bitvec<osr::node_idx_t> const& bv,
+                  sparse_bitvec const& sparse) {
+  // Start from garbage: to_bitvec has to overwrite every block.
+  auto out = osr::bitvec<osr::node_idx_t>{};
+  out.resize(bv.size() + 100U);
+  out.one_out();
+  sparse.to_bitvec(out);
+
+  ASSERT_EQ(bv.size(), out.size());
+  for (auto i = 0U; i != bv.size(); ++i) {
+    auto const n = osr::node_idx_t{i};
+    ASSERT_EQ(bv.test(n), out.test(n)) << i;
+    ASSERT_EQ(bv.test(n), sparse.test(i)) << i;
+  }
+}
+
+}  // namespace
+
+TEST(motis, gbfs_sparse_bitvec_runs) {
+  // Allowed by default, forbidden zones at and across block boundaries.
+  constexpr auto const kNodes = 1'000U;
+  auto const zones = std::vector<run_t>{
+      {0U, 1U}, {63U, 65U}, {128U, 192U}, {200U, 400U}, {999U, 1000U}};
+  auto bv = osr::bitvec<osr::node_idx_t>{};
+  bv.resize(kNodes);
+  bv.one_out();
+  for (auto const [from, to] : zones) {
+    for (auto n = from; n != to; ++n) {
+      bv.set(osr::node_idx_t{n}, false);
+    }
+  }
+
+  auto const sparse = sparse_bitvec::from(bv);
+  EXPECT_TRUE(sparse.default_);
+  EXPECT_EQ(zones, sparse.runs_);
+  expect_equal(bv, sparse);
+
+  // Mostly forbidden: the default flips, the runs are the allowed nodes.
+  bv.zero_out();
+  bv.set(osr::node_idx_t{64U}, true);
+  bv.set(osr::node_idx_t{65U}, true);
+  auto const inverted = sparse_bitvec::from(bv);
+  EXPECT_FALSE(inverted.default_);
+  EXPECT_EQ((std::vector<run_t>{{64U, 66U}}), inverted.runs_);
+  expect_equal(bv, inverted);
+}
+
+TEST(motis, gbfs_sparse_bitvec_random) {
+  constexpr auto const kNodes = 5'000U;  // last block is partially used
+  auto rng = std::mt19937{42U};
+  auto node = std::uniform_int_distribution<std::uint32_t>{0U, kNodes - 1U};
+  auto zone_size = std::uniform_int_distribution<std::uint32_t>{1U, 300U};
+
+  auto bv = osr::bitvec<osr::node_idx_t>{};
+  bv.resize(kNodes);
+  bv.one_out();
+  for (auto i = 0U; i != 10U; ++i) {
+    auto const from = node(rng);
+    auto const to = std::min(kNodes, from + zone_size(rng));
+    for (auto n = from; n != to; ++n) {
+      bv.set(osr::node_idx_t{n}, false);
+    }
+  }
+  for (auto i = 0U; i != 100U; ++i) {
+    bv.set(osr::node_idx_t{node(rng)}, (i % 2U) == 0U);
+  }
+
+  auto const sparse = sparse_bitvec::from(bv);
+  EXPECT_TRUE(sparse.default_);
+  expect_equal(bv, sparse);
+}
+
+TEST(motis, gbfs_sparse_bitvec_empty) {
+  auto bv = osr::bitvec<osr::node_idx_t>{};
+  bv.resize(100U);
+  auto const sparse = sparse_bitvec::from(bv);
+  EXPECT_FALSE(sparse.default_);
+  EXPECT_TRUE(sparse.runs_.empty());
+  expect_equal(bv, sparse);
+}
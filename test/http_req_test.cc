@@ -0,0 +1,151 @@
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+#include "boost/asio/co_spawn.hpp"
+#include "boost/asio/detached.hpp"
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/ip/tcp.hpp"
+#include "boost/asio/use_awaitable.hpp"
+#include "boost/beast/core.hpp"
+#include "boost/beast/http.hpp"
+
+#include "motis/http_req.h"
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using namespace motis;
+
+namespace {
+
+constexpr auto const kETag = R"("v1")";
+constexpr auto const kBody = "feed content";
+
+struct counts {
+  unsigned connections_{0U};
+  unsigned requests_{0U};
+  unsigned not_modified_{0U};
+};
+
+asio::awaitable<void> serve(asio::ip::tcp::socket socket, counts& c) {
+  auto stream = beast::tcp_stream{std::move(socket)};
+  auto buffer = beast::flat_buffer{};
+  try {
+    while (true) {
+      auto req = http::request<http::string_body>{};
+      co_await http::async_read(stream, buffer, req, asio::use_awaitable);
+      ++c.requests_;
+      if (req.method() == http::verb::post) {
+        co_return;  // closes the connection without response
+      }
+
+      auto res = http::response<http::string_body>{http::status::ok, 11};
+      res.set(http::field::etag, kETag);
+      if (req[http::field::if_none_match] == kETag) {
+        ++c.not_modified_;
+        res.result(http::status::not_modified);
+      } else {
+        res.body() = kBody;
+      }
+      res.keep_alive(req.keep_alive());
+      res.prepare_payload();
+      co_await http::async_write(stream, res, asio::use_awaitable);
+    }
+  } catch (std::exception const&) {
+    // client closed the connection
+  }
+}
+
+asio::awaitable<void> listen(asio::ip::tcp::acceptor& acceptor, counts& c) {
+  while (true) {
+    auto socket = co_await acceptor.async_accept(asio::use_awaitable);
+    ++c.connections_;
+    asio::co_spawn(acceptor.get_executor(), serve(std::move(socket), c),
+                   asio::detached);
+  }
+}
+
+}  // namespace
+
+TEST(motis, http_req_keep_alive_conditional_get) {
+  auto ioc = asio::io_context{};
+  auto acceptor = asio::ip::tcp::acceptor{
+      ioc, {asio::ip::make_address("127.0.0.1"), 0U}};
+  auto const url = boost::urls::url{
+      "http://127.0.0.1:" + std::to_string(acceptor.local_endpoint().port()) +
+      "/feed"};
+
+  auto c = counts{};
+  auto bodies = std::vector<std::string>{};
+  asio::co_spawn(ioc, listen(acceptor, c), asio::detached);
+  asio::co_spawn(
+      ioc,
+      [&]() -> asio::awaitable<void> {
+        for (auto i = 0U; i != 3U; ++i) {
+          auto const res =
+              co_await http_GET(url, {}, std::chrono::seconds{10});
+          EXPECT_EQ(http::status::ok, res.result());
+          bodies.emplace_back(get_http_body(res));
+        }
+      },
+      [&](std::exception_ptr const& e) {
+        ioc.stop();  // the pooled connection keeps the server busy
+        if (e) {
+          std::rethrow_exception(e);
+        }
+      });
+  ioc.run_for(std::chrono::seconds{30});
+
+  ASSERT_EQ(3U, bodies.size());
+  for (auto const& b : bodies) {
+    EXPECT_EQ(kBody, b);
+  }
+  EXPECT_EQ(1U, c.connections_);
+  EXPECT_EQ(3U, c.requests_);
+  EXPECT_EQ(2U, c.not_modified_);
+}
+
+TEST(motis, http_req_if_modified_no_post_retry) {
+  auto ioc = asio::io_context{};
+  auto acceptor = asio::ip::tcp::acceptor{
+      ioc, {asio::ip::make_address("127.0.0.1"), 0U}};
+  auto const url = boost::urls::url{
+      "http://127.0.0.1:" + std::to_string(acceptor.local_endpoint().port()) +
+      "/feed"};
+
+  auto c = counts{};
+  auto modified = std::vector<bool>{};
+  auto post_failed = false;
+  asio::co_spawn(ioc, listen(acceptor, c), asio::detached);
+  asio::co_spawn(
+      ioc,
+      [&]() -> asio::awaitable<void> {
+        for (auto i = 0U; i != 2U; ++i) {
+          auto const res =
+              co_await http_GET_if_modified(url, {}, std::chrono::seconds{10});
+          modified.push_back(res.has_value());
+        }
+
+        // The POST is sent on the pooled connection, which is closed without
+        // response: it must not be sent again.
+        try {
+          co_await http_POST(url, {}, "x", std::chrono::seconds{10});
+        } catch (std::exception const&) {
+          post_failed = true;
+        }
+      },
+      [&](std::exception_ptr const& e) {
+        ioc.stop();
+        if (e) {
+          std::rethrow_exception(e);
+        }
+      });
+  ioc.run_for(std::chrono::seconds{30});
+
+  EXPECT_EQ((std::vector<bool>{true, false}), modified);
+  EXPECT_TRUE(post_failed);
+  EXPECT_EQ(1U, c.connections_);
+  EXPECT_EQ(3U, c.requests_);
+}
@@ -0,0 +1,122 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "boost/asio/co_spawn.hpp"
+#include "boost/asio/detached.hpp"
+#include "boost/asio/io_context.hpp"
+#include "boost/asio/ip/tcp.hpp"
+#include "boost/asio/use_awaitable.hpp"
+#include "boost/beast/core.hpp"
+#include "boost/beast/http.hpp"
+
+#include "boost/url/url.hpp"
+
+#include "ctx/scheduler.h"
+
+#include "motis/ctx_data.h"
+#include "motis/odm/prima.h"
+
+namespace asio = boost::asio;
+namespace beast = boost::beast;
+namespace http = beast::http;
+using namespace motis;
+using namespace motis::odm;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Echoes the request body, closes the connection without response for
+// "/close".
+asio::awaitable<void> serve(asio::ip::tcp::socket socket) {
+  auto stream = beast::tcp_stream{std::move(socket)};
+  auto buffer = beast::flat_buffer{};
+  try {
+    while (true) {
+      auto req = http::request<http::string_body>{};
+      co_await http::async_read(stream, buffer, req, asio::use_awaitable);
+      if (req.target() == "/close") {
+        co_return;
+      }
+      auto res = http::response<http::string_body>{http::status::ok, 11};
+      res.body() = "echo " + req.body();
+      res.keep_alive(req.keep_alive());
+      res.prepare_payload();
+      co_await http::async_write(stream, res, asio::use_awaitable);
+    }
+  } catch (std::exception const&) {
+    // client closed the connection
+  }
+}
+
+asio::awaitable<void> listen(asio::ip::tcp::acceptor& acceptor) {
+  while (true) {
+    auto socket = co_await acceptor.async_accept(asio::use_awaitable);
+    asio::co_spawn(acceptor.get_executor(), serve(std::move(socket)),
+                   asio::detached);
+  }
+}
+
+struct echo_server {
+  echo_server()
+      : acceptor_{ioc_, {asio::ip::make_address("127.0.0.1"), 0U}},
+        base_url_{"http://127.0.0.1:" +
+                  std::to_string(acceptor_.local_endpoint().port())} {
+    asio::co_spawn(ioc_, listen(acceptor_), asio::detached);
+    thread_ = std::thread{[&]() { ioc_.run(); }};
+  }
+
+  ~echo_server() {
+    ioc_.stop();
+    thread_.join();
+  }
+
+  boost::urls::url url(std::string const& path) const {
+    return boost::urls::url{base_url_ + path};
+  }
+
+  asio::io_context ioc_;
+  asio::ip::tcp::acceptor acceptor_;
+  std::string base_url_;
+  std::thread thread_;
+};
+
+}  // namespace
+
+TEST(motis, prima_post_without_ctx) {
+  auto const server = echo_server{};
+
+  auto const ok = prima_post(server.url("/api"), "x", 10s, "test");
+  EXPECT_EQ(std::optional<std::string>{"echo x"}, ok());
+
+  auto const failed = prima_post(server.url("/close"), "x", 10s, "test");
+  EXPECT_EQ(std::nullopt, failed());
+}
+
+TEST(motis, prima_post_ctx) {
+  auto const server = echo_server{};
+  auto sched = ctx::scheduler<ctx_data>{};
+
+  // A single worker: waiting has to suspend the operation, otherwise the
+  // request, which is sent on the scheduler's I/O context, never completes.
+  auto ok = prima_response_t{};
+  auto failed = prima_response_t{"not set"};
+  sched.post_void_io(
+      ctx_data{},
+      [&]() {
+        auto const ok_wait = prima_post(server.url("/api"), "y", 10s, "test");
+        auto const failed_wait =
+            prima_post(server.url("/close"), "y", 10s, "test");
+        ok = ok_wait();
+        failed = failed_wait();
+        sched.runner_.stop();
+      },
+      CTX_LOCATION);
+  sched.runner_.run(1U);
+
+  EXPECT_EQ(std::optional<std::string>{"echo y"}, ok);
+  EXPECT_EQ(std::nullopt, failed);
+}
@@ -0,0 +1,162 @@
+#include "gtest/gtest.h"
+
+#include <string>
+
+#include "prometheus/counter.h"
+
+#include "nigiri/rt/create_rt_timetable.h"
+#include "nigiri/rt/gtfsrt_update.h"
+#include "nigiri/rt/rt_timetable.h"
+#include "nigiri/timetable.h"
+
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/import.h"
+#include "motis/metrics_registry.h"
+#include "motis/offsets_cache.h"
+
+#include "./util.h"
+
+namespace n = nigiri;
+using namespace std::string_view_literals;
+using namespace motis;
+using namespace date;
+using namespace test;
+
+namespace {
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon
+DA_1,DA Hbf,49.87260,8.63085
+DA_2,DA Hbf,49.87336,8.62926
+FFM,FFM Hbf,50.10701,8.66341
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_type
+RE,DB,RE,,2
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign
+RE,S1,A,FFM,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence
+A,10:00:00,10:00:00,DA_1,1
+A,10:20:00,10:20:00,FFM,2
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+offsets_cache_key get_key(double const lat, std::chrono::seconds const max) {
+  return make_offsets_cache_key(
+      osr::location{geo::latlng{lat, 8.6}, osr::level_t{}},
+      osr::search_profile::kFoot, osr::direction::kForward, osr_parameters{},
+      max, 25.0, true);
+}
+
+}  // namespace
+
+TEST(motis, offsets_cache) {
+  auto metrics = metrics_registry{};
+  auto cache = offsets_cache{64U, &metrics};
+
+  auto const a = get_key(50.1, std::chrono::seconds{900});
+  auto const b = get_key(50.1, std::chrono::seconds{600});
+  EXPECT_EQ(a, get_key(50.1, std::chrono::seconds{900}));
+  EXPECT_NE(a, b);
+
+  EXPECT_EQ(nullptr, cache.get(a));
+
+  auto const offsets = std::vector<n::routing::offset>{
+      {n::location_idx_t{1U}, n::duration_t{3}, 0U}};
+
+  // Outdated computations are not stored.
+  cache.put(a, {50.1, 8.6}, 1000.0, offsets, []() { return false; });
+  EXPECT_EQ(nullptr, cache.get(a));
+
+  cache.put(a, {50.1, 8.6}, 1000.0, offsets, []() { return true; });
+  auto const cached = cache.get(a);
+  ASSERT_NE(nullptr, cached);
+  ASSERT_EQ(1U, cached->size());
+  EXPECT_EQ(n::location_idx_t{1U}, cached->front().target());
+  EXPECT_EQ(n::duration_t{3}, cached->front().duration());
+  EXPECT_EQ(nullptr, cache.get(b));
+  EXPECT_EQ(1U, cache.size());
+
+  auto const requests = [&](std::string const& result) {
+    return metrics.cache_requests_
+        .Add({{"cache", "offsets"}, {"result", result}})
+        .Value();
+  };
+  EXPECT_EQ(1.0, requests("hit"));
+  EXPECT_EQ(3.0, requests("miss"));
+}
+
+TEST(motis, offsets_cache_invalidate) {
+  auto const c = config{
+      .timetable_ =
+          config::timetable{
+              .first_day_ = "2019-05-01",
+              .num_days_ = 2,
+              .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}},
+      .street_routing_ = false};
+  import(c, "test/data_offsets_cache");
+  auto d = data{"test/data_offsets_cache", c};
+
+  auto const make_rtt = [&]() {
+    return n::rt::create_rt_timetable(*d.tt_, sys_days{2019_y / May / 1});
+  };
+  auto const prev = make_rtt();
+  auto next = make_rtt();
+
+  // DA_2 has no static routes: RT traffic there changes the stops reachable
+  // by RT street searches nearby.
+  auto const reassigned = trip_update{
+      .trip_ = {.trip_id_ = "A", .date_ = {"20190501"}},
+      .stop_updates_ = {{.stop_id_ = "DA_1",
+                         .seq_ = std::optional{1U},
+                         .stop_assignment_ = "DA_2"}}};
+  n::rt::gtfsrt_update_msg(
+      *d.tt_, next, n::source_idx_t{0}, "test",
+      to_feed_msg({reassigned}, sys_days{2019_y / May / 1}));
+  auto const da_2 = d.tags_->get_location(*d.tt_, "test_DA_2");
+  ASSERT_TRUE(prev.location_rt_transports_[da_2].empty());
+  ASSERT_FALSE(next.location_rt_transports_[da_2].empty());
+
+  auto metrics = metrics_registry{};
+  auto cache = offsets_cache{64U, &metrics};
+  auto const offsets = std::vector<n::routing::offset>{
+      {n::location_idx_t{1U}, n::duration_t{3}, 0U}};
+  auto const add = [&](geo::latlng const& pos, bool const with_rt) {
+    auto const key = make_offsets_cache_key(
+        osr::location{pos, osr::level_t{}}, osr::search_profile::kFoot,
+        osr::direction::kForward, osr_parameters{}, std::chrono::seconds{900},
+        25.0, with_rt);
+    cache.put(key, pos, 1000.0, offsets, []() { return true; });
+    return key;
+  };
+
+  auto const da = geo::latlng{49.87260, 8.63085};
+  auto const near_rt = add(da, true);
+  auto const near_static = add(da, false);
+  auto const far_rt = add({50.10701, 8.66341}, true);
+  ASSERT_EQ(3U, cache.size());
+
+  cache.invalidate(*d.tt_, &prev, &next);
+  EXPECT_EQ(nullptr, cache.get(near_rt));
+  EXPECT_NE(nullptr, cache.get(near_static));
+  EXPECT_NE(nullptr, cache.get(far_rt));
+  EXPECT_EQ(2U, cache.size());
+  EXPECT_EQ(1.0, metrics.offsets_cache_invalidations_.Value());
+
+  // No change in RT traffic at stops without static routes: nothing dropped.
+  cache.invalidate(*d.tt_, &next, &next);
+  EXPECT_EQ(2U, cache.size());
+}
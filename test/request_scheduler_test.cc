@@ -0,0 +1,65 @@
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include "motis/config.h"
+#include "motis/metrics_registry.h"
+#include "motis/request_scheduler.h"
+
+using namespace motis;
+
+TEST(motis, request_scheduler_classify) {
+  EXPECT_EQ(request_class::kRouting, classify_request("/api/v5/plan?x=1"));
+  EXPECT_EQ(request_class::kRouting,
+            classify_request("/api/v6/refresh-itinerary"));
+  EXPECT_EQ(request_class::kRouting, classify_request("/ojp20"));
+  EXPECT_EQ(request_class::kBatch, classify_request("/api/v1/one-to-many"));
+  EXPECT_EQ(request_class::kBatch,
+            classify_request("/api/experimental/one-to-all?one=a"));
+  EXPECT_EQ(request_class::kBatch, classify_request("/api/debug/transfers"));
+  EXPECT_EQ(request_class::kInteractive,
+            classify_request("/api/v1/geocode?text=plan"));
+  EXPECT_EQ(request_class::kInteractive, classify_request("/tiles/1/2/3.mvt"));
+}
+
+TEST(motis, request_scheduler_limits) {
+  auto c = config{};
+  c.server_ = config::server{};
+  c.server_->n_threads_ = 2U;
+  c.server_->routing_requests_ =
+      config::server::request_limit{.max_running_ = 1U, .max_queued_ = 1U};
+  c.server_->batch_requests_ = config::server::request_limit{};
+  ASSERT_TRUE(request_scheduler::is_enabled(c));
+
+  auto metrics = metrics_registry{};
+  auto s = request_scheduler{c, metrics};
+
+  auto started = std::vector<int>{};
+  auto const task = [&](int const id) {
+    return [&started, id]() { started.push_back(id); };
+  };
+
+  EXPECT_TRUE(s.submit(request_class::kRouting, task(0)));
+  EXPECT_TRUE(s.submit(request_class::kRouting, task(1)));  // queued: limit
+  EXPECT_FALSE(s.submit(request_class::kRouting, task(2)));  // queue full
+  EXPECT_TRUE(s.submit(request_class::kBatch, task(3)));
+  EXPECT_TRUE(s.submit(request_class::kBatch, task(4)));  // queued: n_threads
+  EXPECT_TRUE(s.submit(request_class::kInteractive, task(5)));
+  EXPECT_EQ((std::vector<int>{0, 3}), started);
+
+  // Freed batch slot goes to the waiting interactive request first.
+  s.finish(request_class::kBatch);
+  EXPECT_EQ((std::vector<int>{0, 3, 5}), started);
+
+  // Routing is still at its limit, so the freed slot is taken by batch.
+  s.finish(request_class::kInteractive);
+  EXPECT_EQ((std::vector<int>{0, 3, 5, 4}), started);
+
+  s.finish(request_class::kRouting);
+  EXPECT_EQ((std::vector<int>{0, 3, 5, 4, 1}), started);
+  EXPECT_TRUE(s.submit(request_class::kRouting, task(6)));
+  s.finish(request_class::kBatch);
+  EXPECT_EQ((std::vector<int>{0, 3, 5, 4, 1}), started);
+  s.finish(request_class::kRouting);
+  EXPECT_EQ((std::vector<int>{0, 3, 5, 4, 1, 6}), started);
+}
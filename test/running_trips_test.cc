@@ -0,0 +1,121 @@
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+#include "date/date.h"
+
+#include "nigiri/timetable.h"
+
+#include "motis/config.h"
+#include "motis/data.h"
+#include "motis/import.h"
+#include "motis/running_trips.h"
+
+using namespace std::string_view_literals;
+using namespace motis;
+using namespace date;
+namespace n = nigiri;
+
+namespace {
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon,location_type,parent_station,platform_code
+A,A,49.87260,8.63085,0,,
+B,B,49.87355,8.63003,0,,
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+R,DB,R,,,3
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id
+R,S1,T1,,
+R,S1,T2,,
+R,S2,T3,,
+R,S1,T4,,
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+T1,10:00:00,10:00:00,A,0,0,0
+T1,10:30:00,10:30:00,B,1,0,0
+T2,23:30:00,23:30:00,A,0,0,0
+T2,25:10:00,25:10:00,B,1,0,0
+T3,00:05:00,00:05:00,A,0,0,0
+T3,01:00:00,01:00:00,B,1,0,0
+T4,08:00:00,08:00:00,A,0,0,0
+T4,13:59:00,13:59:00,B,1,0,0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+S1,20190502,1
+S2,20190502,1
+)"sv;
+
+}  // namespace
+
+TEST(motis, running_trips_static_index) {
+  auto const path = std::filesystem::path{"test/data_running_trips"};
+  auto ec = std::error_code{};
+  std::filesystem::remove_all(path, ec);
+
+  auto const c = config{.timetable_ = config::timetable{
+                            .first_day_ = "2019-05-01",
+                            .num_days_ = 2,
+                            .datasets_ = {
+                                {"test", {.path_ = std::string{kGTFS}}}}}};
+  import(c, path);
+  auto const d = data{path, c};
+  auto const& tt = *d.tt_;
+  ASSERT_NE(nullptr, d.running_trips_);
+
+  auto const n_days = static_cast<std::uint16_t>(
+      (tt.internal_interval_days().to_ - tt.internal_interval_days().from_)
+          .count());
+  auto const count_all = [&](n::interval<n::unixtime_t> const interval) {
+    auto count = 0U;
+    for (auto r = n::route_idx_t{0U}; r != tt.n_routes(); ++r) {
+      auto const last =
+          static_cast<n::stop_idx_t>(tt.route_location_seq_[r].size() - 1U);
+      for (auto const t_idx : tt.route_transport_ranges_[r]) {
+        for (auto day = n::day_idx_t{0U}; day != n::day_idx_t{n_days}; ++day) {
+          auto const t = n::transport{t_idx, day};
+          if (tt.bitfields_[tt.transport_traffic_days_[t_idx]].test(
+                  to_idx(day)) &&
+              interval.overlaps(
+                  {tt.event_time(t, 0U, n::event_type::kDep),
+                   tt.event_time(t, last, n::event_type::kArr) +
+                       n::unixtime_t::duration{1}})) {
+            ++count;
+          }
+        }
+      }
+    }
+    return count;
+  };
+
+  auto n_running = 0U;
+  auto const start = n::unixtime_t{sys_days{2019_y / April / 30}};
+  for (auto t = start; t < start + std::chrono::days{4};
+       t += std::chrono::minutes{7}) {
+    for (auto const duration :
+         {std::chrono::minutes{3}, std::chrono::minutes{300}}) {
+      auto const interval = n::interval{t, t + duration};
+      auto count = 0U;
+      d.running_trips_->for_each_running(
+          tt, nullptr, interval, [&](n::provider_idx_t) { ++count; });
+      EXPECT_EQ(count_all(interval), count) << t << " +" << duration;
+      n_running += count;
+    }
+  }
+  EXPECT_NE(0U, n_running);
+}
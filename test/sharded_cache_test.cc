@@ -0,0 +1,91 @@
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "motis/sharded_cache.h"
+
+using namespace motis;
+
+TEST(motis, sharded_cache_single_flight) {
+  auto cache = sharded_cache<int, int>{1024U};
+  auto n_computed = std::atomic_int{0};
+
+  auto threads = std::vector<std::thread>{};
+  for (auto i = 0; i != 8; ++i) {
+    threads.emplace_back([&]() {
+      for (auto key = 0; key != 32; ++key) {
+        auto const value = cache.get_or_compute(key, [&]() {
+          ++n_computed;
+          std::this_thread::yield();
+          return std::make_shared<int>(key * 2);
+        });
+        EXPECT_EQ(key * 2, *value);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  EXPECT_EQ(32, n_computed);
+  EXPECT_EQ(32U, cache.size());
+}
+
+TEST(motis, sharded_cache_eviction) {
+  auto cache = sharded_cache<int, int>{4U};
+  auto const compute = [](int const key) {
+    return [key]() { return std::make_shared<int>(key); };
+  };
+
+  for (auto key = 0; key != 4; ++key) {
+    cache.get_or_compute(key, compute(key));
+  }
+  EXPECT_EQ(4U, cache.size());
+  EXPECT_FALSE(cache.try_add_or_update(4, compute(4)));
+
+  // Recently used entries get a second chance.
+  EXPECT_NE(nullptr, cache.get(0));
+  cache.get_or_compute(4, compute(4));
+  EXPECT_EQ(4U, cache.size());
+  EXPECT_TRUE(cache.contains(4));
+  EXPECT_TRUE(cache.contains(0));
+
+  cache.remove(4);
+  EXPECT_FALSE(cache.contains(4));
+  EXPECT_EQ(3U, cache.size());
+
+  auto copy = cache;
+  EXPECT_EQ(3U, copy.size());
+  EXPECT_EQ(0, *copy.get(0));
+}
+
+TEST(motis, sharded_cache_weight) {
+  struct string_size {
+    std::size_t operator()(std::string const& s) const { return s.size(); }
+  };
+  auto cache = sharded_cache<int, std::string, string_size>{8U};
+  auto const compute = [](std::size_t const size) {
+    return [size]() { return std::make_shared<std::string>(size, 'x'); };
+  };
+
+  cache.get_or_compute(0, compute(3U));
+  cache.get_or_compute(1, compute(3U));
+  EXPECT_EQ(6U, cache.weight());
+  EXPECT_FALSE(cache.try_add_or_update(2, compute(3U)));
+  EXPECT_TRUE(cache.try_add_or_update(2, compute(2U)));
+  EXPECT_TRUE(cache.full());
+
+  // Inserting a large value evicts as many entries as needed.
+  cache.get_or_compute(3, compute(6U));
+  EXPECT_EQ(1U, cache.size());
+  EXPECT_EQ(6U, cache.weight());
+  EXPECT_TRUE(cache.contains(3));
+
+  cache.update_if_exists(3, [](auto const&) {
+    return std::make_shared<std::string>(1U, 'x');
+  });
+  EXPECT_EQ(1U, cache.weight());
+}
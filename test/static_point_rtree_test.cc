@@ -0,0 +1,60 @@
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include "utl/helpers/algorithm.h"
+
+#include "geo/latlng.h"
+
+#include "motis/point_rtree.h"
+#include "motis/static_point_rtree.h"
+
+using namespace motis;
+
+namespace {
+
+using idx_t = cista::strong<std::uint32_t, struct test_idx_>;
+
+}  // namespace
+
+TEST(motis, static_point_rtree) {
+  constexpr auto const kPoints = 2'000U;
+  constexpr auto const kQueries = 200U;
+
+  auto rng = std::mt19937{42U};
+  auto lat = std::uniform_real_distribution<double>{49.0, 50.0};
+  auto lng = std::uniform_real_distribution<double>{8.0, 9.0};
+  auto radius = std::uniform_real_distribution<double>{100.0, 10'000.0};
+
+  auto entries = std::vector<std::pair<geo::latlng, idx_t>>{};
+  auto dynamic = point_rtree<idx_t>{};
+  for (auto i = 0U; i != kPoints; ++i) {
+    auto const pos = geo::latlng{lat(rng), lng(rng)};
+    entries.emplace_back(pos, idx_t{i});
+    dynamic.add(pos, idx_t{i});
+  }
+  auto const packed = static_point_rtree<idx_t>::build(entries);
+  EXPECT_EQ(kPoints, packed.size());
+
+  for (auto i = 0U; i != kQueries; ++i) {
+    auto const pos = geo::latlng{lat(rng), lng(rng)};
+    auto const r = radius(rng);
+
+    auto expected = std::vector<idx_t>{};
+    for (auto const& [p, idx] : entries) {
+      if (geo::distance(pos, p) < r) {
+        expected.emplace_back(idx);
+      }
+    }
+    auto actual = packed.in_radius(pos, r);
+    auto actual_dynamic = dynamic.in_radius(pos, r);
+    utl::sort(actual);
+    utl::sort(actual_dynamic);
+    ASSERT_EQ(expected, actual) << i;
+    ASSERT_EQ(expected, actual_dynamic) << i;
+  }
+
+  auto const empty = static_point_rtree<idx_t>::build({});
+  EXPECT_TRUE(empty.in_radius(geo::latlng{50.0, 8.0}, 1000.0).empty());
+}
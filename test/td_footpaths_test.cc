@@ -0,0 +1,335 @@
+#include "gtest/gtest.h"
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <tuple>
+
+#include "date/date.h"
+#include "fmt/format.h"
+
+#include "utl/enumerate.h"
+#include "utl/equal_ranges_linear.h"
+#include "utl/helpers/algorithm.h"
+#include "utl/to_vec.h"
+#include "utl/zip.h"
+
+#include "osr/routing/parameters.h"
+#include "osr/routing/route.h"
+
+#include "motis/config.h"
+#include "motis/constants.h"
+#include "motis/data.h"
+#include "motis/elevators/elevator_footpath_index.h"
+#include "motis/elevators/elevators.h"
+#include "motis/elevators/get_state_changes.h"
+#include "motis/elevators/parse_fasta.h"
+#include "motis/get_loc.h"
+#include "motis/get_stops_with_traffic.h"
+#include "motis/import.h"
+#include "motis/osr/max_distance.h"
+#include "motis/update_rtt_td_footpaths.h"
+
+using namespace std::string_view_literals;
+using namespace motis;
+using namespace date;
+namespace n = nigiri;
+
+namespace {
+
+constexpr auto const kGTFS = R"(
+# agency.txt
+agency_id,agency_name,agency_url,agency_timezone
+DB,Deutsche Bahn,https://deutschebahn.com,Europe/Berlin
+
+# stops.txt
+stop_id,stop_name,stop_lat,stop_lon,location_type,parent_station,platform_code,wheelchair_boarding
+DA,DA Hbf,49.87260,8.63085,1,,,1
+DA_3,DA Hbf,49.87355,8.63003,0,DA,3,1
+DA_10,DA Hbf,49.87336,8.62926,0,DA,10,1
+DA_12,DA Hbf,49.87330,8.62880,0,DA,12,1
+FFM,FFM Hbf,50.10701,8.66341,1,,,1
+FFM_10,FFM Hbf,50.10593,8.66118,0,FFM,10,1
+
+# routes.txt
+route_id,agency_id,route_short_name,route_long_name,route_desc,route_type
+RE,DB,RE,,,106
+
+# trips.txt
+route_id,service_id,trip_id,trip_headsign,block_id,wheelchair_accessible
+RE,S1,RE_1,,,1
+RE,S1,RE_2,,,1
+
+# stop_times.txt
+trip_id,arrival_time,departure_time,stop_id,stop_sequence,pickup_type,drop_off_type
+RE_1,01:00:00,01:00:00,DA_3,0,0,0
+RE_1,01:10:00,01:10:00,DA_10,1,0,0
+RE_2,02:00:00,02:00:00,DA_12,0,0,0
+RE_2,02:10:00,02:10:00,DA,1,0,0
+
+# calendar_dates.txt
+service_id,date,exception_type
+S1,20190501,1
+)"sv;
+
+// Elevators of DA Hbf. Every elevator has recurring maintenance windows with
+// a different period, so the same state vectors occur many times.
+// `first_in_service`: the first elevator has no maintenance windows.
+std::string elevators_json(bool const first_in_service = false) {
+  struct fasta_elevator {
+    std::uint64_t id_;
+    double lng_, lat_;
+  };
+  constexpr auto const kElevators = std::array{
+      fasta_elevator{10543458U, 8.6303864, 49.8725612},
+      fasta_elevator{10543453U, 8.6300911, 49.8725678},
+      fasta_elevator{10543454U, 8.6298163, 49.8725555},
+      fasta_elevator{10543455U, 8.6295535, 49.87254},
+      fasta_elevator{10543456U, 8.6293117, 49.8725263},
+      fasta_elevator{10543457U, 8.6290451, 49.8725147}};
+
+  auto json = std::string{"["};
+  for (auto const [i, e] : utl::enumerate(kElevators)) {
+    auto out_of_service = std::string{};
+    auto const period = static_cast<int>(i) + 2;
+    for (auto h = static_cast<int>(i);
+         h + 1 < 48 && !(i == 0U && first_in_service); h += period) {
+      auto const from =
+          date::sys_days{2019_y / May / 1} + std::chrono::hours{h};
+      out_of_service += fmt::format(
+          R"({}["{}", "{}"])", out_of_service.empty() ? "" : ",",
+          date::format("%FT%TZ", from),
+          date::format("%FT%TZ", from + std::chrono::hours{1}));
+    }
+    json += fmt::format(
+        R"({}{{"equipmentnumber": {}, "geocoordX": {}, "geocoordY": {},
+             "state": "ACTIVE", "type": "ELEVATOR",
+             "outOfService": [{}]}})",
+        i == 0U ? "" : ",", e.id_, e.lng_, e.lat_, out_of_service);
+  }
+  json += "]";
+  return json;
+}
+
+// One full street search per elevator state interval.
+std::vector<n::td_footpath> get_td_footpaths_per_interval(
+    data const& d,
+    elevators const& e,
+    n::location_idx_t const start_l,
+    osr::location const start,
+    osr::direction const dir,
+    std::chrono::seconds const max,
+    osr::bitvec<osr::node_idx_t>& blocked_mem) {
+  auto const& w = *d.w_;
+  auto const& l = *d.l_;
+  auto const& tt = *d.tt_;
+  auto const profile = osr::search_profile::kWheelchair;
+  blocked_mem.resize(w.n_nodes());
+
+  auto const e_nodes = utl::to_vec(
+      l.find_elevators(geo::box{start.pos_, kElevatorUpdateRadius}));
+  auto const e_state_changes =
+      get_state_changes(
+          utl::to_vec(e_nodes,
+                      [&](osr::node_idx_t const x)
+                          -> std::vector<state_change<n::unixtime_t>> {
+                        auto const ne = match_elevator(e.elevators_rtree_,
+                                                       e.elevators_, w, x);
+                        if (ne == elevator_idx_t::invalid()) {
+                          return {{.valid_from_ = n::unixtime_t{},
+                                   .state_ = true}};
+                        }
+                        return e.elevators_[ne].get_state_changes();
+                      }))
+          .to_vec();
+
+  auto fps = std::vector<n::td_footpath>{};
+  for (auto const& [t, states] : e_state_changes) {
+    set_blocked(e_nodes, states, blocked_mem);
+    auto const neighbors = get_stops_with_traffic(
+        tt, d.rt_->rtt_.get(), *d.location_rtree_, start,
+        get_max_distance(profile, osr_parameters{}, max), start_l);
+    auto const results = osr::route(
+        to_profile_parameters(profile, osr_parameters{}), w, l, profile, start,
+        utl::to_vec(neighbors,
+                    [&](auto&& x) {
+                      return get_loc(tt, w, *d.pl_, *d.matches_, x);
+                    }),
+        static_cast<osr::cost_t>(max.count()), dir,
+        kMaxWheelchairMatchingDistance, &blocked_mem);
+    for (auto const [to, p] : utl::zip(neighbors, results)) {
+      auto const duration = p.has_value() && (n::duration_t{p->cost_ / 60U} <
+                                              n::footpath::kMaxDuration)
+                                ? n::duration_t{p->cost_ / 60U}
+                                : n::footpath::kMaxDuration;
+      fps.push_back(n::td_footpath{
+          to, t,
+          n::duration_t{std::max(n::duration_t::rep{1}, duration.count())}});
+    }
+  }
+
+  utl::sort(fps);
+  utl::equal_ranges_linear(
+      fps, [](auto const& a, auto const& b) { return a.target_ == b.target_; },
+      [&](auto& lb, auto& ub) {
+        for (auto it = lb; it != ub; ++it) {
+          if (it->duration_ == n::footpath::kMaxDuration && it != lb &&
+              (it - 1)->duration_ != n::footpath::kMaxDuration) {
+            it->valid_from_ -= (it - 1)->duration_ - n::duration_t{1U};
+          }
+        }
+      });
+  return fps;
+}
+
+using tasks_t = hash_set<std::pair<n::location_idx_t, osr::direction>>;
+
+// Wheelchair td footpaths of `tasks` locations, patched into `rtt`.
+void update(data const& d,
+            elevators const& e,
+            tasks_t const& tasks,
+            n::rt_timetable const* old_rtt,
+            bool const rtt_is_copy,
+            n::rt_timetable& rtt) {
+  update_rtt_td_footpaths(
+      *d.w_, *d.l_, *d.pl_, *d.tt_, *d.location_rtree_, e, *d.matches_, tasks,
+      old_rtt, rtt_is_copy, rtt,
+      std::chrono::seconds{d.config_.timetable_->max_footpath_length_ * 60});
+}
+
+void expect_equal_td_footpaths(data const& d,
+                               n::rt_timetable const& expected,
+                               n::rt_timetable const& actual) {
+  for (auto l = n::location_idx_t{0U}; l != d.tt_->n_locations(); ++l) {
+    for (auto const [exp_has, act_has, exp_fps, act_fps] :
+         {std::tuple{&expected.has_td_footpaths_out_[2],
+                     &actual.has_td_footpaths_out_[2],
+                     &expected.td_footpaths_out_[2],
+                     &actual.td_footpaths_out_[2]},
+          std::tuple{&expected.has_td_footpaths_in_[2],
+                     &actual.has_td_footpaths_in_[2],
+                     &expected.td_footpaths_in_[2],
+                     &actual.td_footpaths_in_[2]}}) {
+      EXPECT_EQ(exp_has->test(l), act_has->test(l)) << l;
+      ASSERT_EQ((*exp_fps)[l].size(), (*act_fps)[l].size()) << l;
+      for (auto const [a, b] : utl::zip((*exp_fps)[l], (*act_fps)[l])) {
+        EXPECT_EQ(a.target_, b.target_);
+        EXPECT_EQ(a.valid_from_, b.valid_from_);
+        EXPECT_EQ(a.duration_, b.duration_);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(motis, td_footpaths_elevator_intervals) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_td_footpaths", ec);
+
+  auto const c = config{
+      .osm_ = {"test/resources/test_case.osm.pbf"},
+      .timetable_ =
+          config::timetable{
+              .first_day_ = "2019-05-01",
+              .num_days_ = 2,
+              .use_osm_stop_coordinates_ = true,
+              .extend_missing_footpaths_ = false,
+              .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}},
+      .street_routing_ = true,
+      .osr_footpath_ = true};
+  import(c, "test/data_td_footpaths");
+  auto d = data{"test/data_td_footpaths", c};
+  d.init_rtt(date::sys_days{2019_y / May / 1});
+
+  auto const e = elevators{*d.w_, nullptr, *d.elevator_nodes_,
+                           parse_fasta(elevators_json())};
+  auto const max =
+      std::chrono::seconds{c.timetable_.value().max_footpath_length_ * 60};
+  auto blocked = osr::bitvec<osr::node_idx_t>{};
+
+  auto n_footpaths = std::size_t{0U};
+  for (auto l = n::location_idx_t{0U}; l != d.tt_->n_locations(); ++l) {
+    auto const start = get_loc(*d.tt_, *d.w_, *d.pl_, *d.matches_, l);
+    for (auto const dir :
+         {osr::direction::kForward, osr::direction::kBackward}) {
+      auto const expected =
+          get_td_footpaths_per_interval(d, e, l, start, dir, max, blocked);
+      auto const actual = get_td_footpaths(
+          *d.w_, *d.l_, *d.pl_, *d.tt_, d.rt_->rtt_.get(), *d.location_rtree_,
+          e, *d.matches_, l, start, dir, osr::search_profile::kWheelchair, max,
+          kMaxWheelchairMatchingDistance, osr_parameters{}, blocked);
+
+      ASSERT_EQ(expected.size(), actual.size());
+      for (auto const [a, b] : utl::zip(expected, actual)) {
+        EXPECT_EQ(a.target_, b.target_);
+        EXPECT_EQ(a.valid_from_, b.valid_from_);
+        EXPECT_EQ(a.duration_, b.duration_);
+      }
+      n_footpaths += actual.size();
+    }
+  }
+
+  EXPECT_NE(0U, n_footpaths);
+}
+
+TEST(motis, td_footpaths_patch_elevator_update) {
+  auto ec = std::error_code{};
+  std::filesystem::remove_all("test/data_td_footpaths_patch", ec);
+
+  auto const c = config{
+      .osm_ = {"test/resources/test_case.osm.pbf"},
+      .timetable_ =
+          config::timetable{
+              .first_day_ = "2019-05-01",
+              .num_days_ = 2,
+              .use_osm_stop_coordinates_ = true,
+              .extend_missing_footpaths_ = false,
+              .datasets_ = {{"test", {.path_ = std::string{kGTFS}}}}},
+      .street_routing_ = true,
+      .osr_footpath_ = true};
+  import(c, "test/data_td_footpaths_patch");
+  auto d = data{"test/data_td_footpaths_patch", c};
+  d.init_rtt(date::sys_days{2019_y / May / 1});
+
+  auto const old_e = elevators{*d.w_, nullptr, *d.elevator_nodes_,
+                               parse_fasta(elevators_json())};
+  auto const new_e = elevators{*d.w_, nullptr, *d.elevator_nodes_,
+                               parse_fasta(elevators_json(true))};
+
+  auto all = tasks_t{};
+  for (auto l = n::location_idx_t{0U}; l != d.tt_->n_locations(); ++l) {
+    all.emplace(l, osr::direction::kForward);
+    all.emplace(l, osr::direction::kBackward);
+  }
+  auto const empty_rtt = *d.rt_->rtt_;
+  auto old_rtt = empty_rtt;
+  update(d, old_e, all, nullptr, false, old_rtt);
+  auto full_rtt = empty_rtt;
+  update(d, new_e, all, nullptr, false, full_rtt);
+
+  // Only DA Hbf locations are close to the first elevator.
+  auto const index =
+      elevator_footpath_index{*d.w_, *d.l_, *d.pl_, *d.tt_, *d.matches_};
+  auto const tasks = index.get_tasks(*d.w_, old_e, new_e);
+  EXPECT_FALSE(tasks.empty());
+  EXPECT_LT(tasks.size(), all.size());
+  for (auto const& [l, dir] : tasks) {
+    EXPECT_TRUE(d.tt_->locations_.ids_[l].view().starts_with("DA")) << l;
+  }
+
+  // RT timetable copied from the previous one.
+  auto copied_rtt = old_rtt;
+  update(d, new_e, tasks, &old_rtt, true, copied_rtt);
+  expect_equal_td_footpaths(d, full_rtt, copied_rtt);
+
+  // Previous RT timetable patched in place.
+  auto in_place_rtt = old_rtt;
+  update(d, new_e, tasks, &in_place_rtt, false, in_place_rtt);
+  expect_equal_td_footpaths(d, full_rtt, in_place_rtt);
+
+  // New RT timetable without td footpaths.
+  auto fresh_rtt = empty_rtt;
+  update(d, new_e, tasks, &old_rtt, false, fresh_rtt);
+  expect_equal_td_footpaths(d, full_rtt, fresh_rtt);
+}